@@ -22,9 +22,21 @@ namespace C {
     constexpr char RTSP_HANDLER[] = "RtspHandler";
     constexpr char STREAM_HANDLER[] = "StreamHandler";
     constexpr char RTP_HANDLER[] = "RtpHandler";
+    constexpr char BLOCK_CACHE[] = "BlockCache";
+    constexpr char TIERED_CONTENT_CACHE[] = "TieredContentCache";
+    constexpr char PINNED_CONTENT[] = "PinnedContent";
+    constexpr char CONTENT_INDEX_SIDECAR[] = "ContentIndexSidecar";
+    constexpr char CONTENT_ROOT_WATCHER[] = "ContentRootWatcher";
+    constexpr char SERVER_SHARD[] = "ServerShard";
+    constexpr char TIMER_WHEEL[] = "TimerWheel";
+    constexpr char MEDIA_CLOCK[] = "MediaClock";
+    constexpr char METRICS_HTTP_SERVER[] = "MetricsHttpServer";
 
     // boost::asio::io_context thread pool
     constexpr int THREAD_CNT_PER_WORKER_IO_CONTEXT = 3;
+    // shared nothing mode. one SO_REUSEPORT acceptor, one io_context thread pinned to a core, and one session table
+    // per shard. the kernel spreads new connections over the shards. linux and macOS only.
+    constexpr bool USE_REUSEPORT_SHARDS = false;
 
     // General constants
     constexpr char MY_NAME[] = "RtspServerInCpp/1.1.1";
@@ -35,6 +47,14 @@ namespace C {
     constexpr int SESSION_CLOSE_TIMEOUT_MS = 10*1000;
     constexpr int DELAY_BEFORE_RTP_START = 500;
     constexpr int DELAY_BEFORE_RTP_START_ON_SEEK = 100;
+    // fast start. sample reading starts as soon as the PLAY response is written,
+    // with a burst of the first gop. the delays above are used only if it is off.
+    constexpr bool USE_FAST_START = true;
+    constexpr int64_t FAST_START_BUFFER_TARGET_MS = 1000; // media duration sent ahead of the real time
+    // parking. a session which is not playing, or was paused longer than the delay, releases its files,
+    // queued samples, and timers. it keeps only the read position, and reopens everything on PLAY.
+    constexpr bool USE_SESSION_PARKING = true;
+    constexpr int64_t SESSION_PARK_DELAY_MS = 10*1000;
     constexpr int SOCKET_TIMEOUT_MS = 10*1000;
     constexpr char EMPTY_STRING[] = "";
     constexpr int ZERO = 0;
@@ -42,9 +62,15 @@ namespace C {
     constexpr int WRONG_SESSION_ID_TOLERANCE_CNT = 5;
     constexpr int URL_SPLIT_BY_SEMI_COLON_LENGTH = 3;
     constexpr int SHUTDOWN_SESSION_CLEAR_TASK_INTERVAL_MS = 30000;
+    constexpr size_t SESSION_REGISTRY_BUCKET_CNT = 16; // each bucket has its own lock.
     constexpr int SESSION_OBJECT_DELETE_INTERVAL_SEC = 20;
     constexpr int STOPPED_TASK_DELETE_DELAY_MS = 3000;
     constexpr int TEARDOWN_DELAY_MS = 5000;
+    constexpr int64_t PERIODIC_TASK_MAX_BURST_CNT = 5; // missed ticks beyond this are skipped even in the burst mode.
+    constexpr int64_t TIMER_WHEEL_TICK_MS = 10;
+    constexpr size_t TIMER_WHEEL_SLOT_CNT = 1024; // one round is about 10 sec. longer delays wait for later rounds.
+    constexpr int64_t MEDIA_CLOCK_COALESCE_US = 1000; // tracks due within this run in the same wake up.
+    constexpr size_t LATENCY_HISTOGRAM_SHARD_CNT = 16; // threads share the shards round robin. merged on read.
 
     constexpr int TCP_RTP_HEAD_LEN = 4; // $+(ch 1) + (len 2)
     constexpr int RTP_HEADER_LEN = 12; // Refer to https://datatracker.ietf.org/doc/html/rfc7798
@@ -82,6 +108,41 @@ namespace C {
     constexpr char ASV[] = "asv";
     constexpr char RTSP_MSG_DELIMITER[] = "###\r\n";
     constexpr int META_LEN_BYTES = 4;
+    constexpr int CONTENT_LOADING_MAX_THREAD_CNT = 16; // index loading is I/O bound on network file system.
+    constexpr bool LAZY_CONTENT_LOADING = true; // false : every content is loaded before the server starts.
+    constexpr int64_t COLD_CONTENT_EVICTION_TIMEOUT_MS = 10 * 60 * 1000; // 10 min without any request or session
+
+    // Hot reload. added, replaced and removed contents are applied without restart. linux only.
+    constexpr bool USE_CONTENT_HOT_RELOAD = false;
+    constexpr int64_t CONTENT_RELOAD_DEBOUNCE_MS = 3000; // reload after the content directory is quiet for this long
+    constexpr int CONTENT_WATCH_POLL_INTERVAL_MS = 500;
+    constexpr char CONTENT_INDEX_SIDECAR_FILE_NAME[] = ".index";
+    constexpr uint32_t CONTENT_INDEX_SIDECAR_VERSION = 2; // bump when the layout or the stored fields change
+
+    // Direct I/O block cache. opt-in. reads bypass the kernel page cache when enabled.
+    constexpr bool USE_DIRECT_IO_BLOCK_CACHE = false;
+    constexpr int DIRECT_IO_ALIGNMENT = 4096;
+    constexpr int64_t DIRECT_IO_BLOCK_SIZE = 1024 * 1024; // 1MB, must be a multiple of DIRECT_IO_ALIGNMENT
+    constexpr int64_t DIRECT_IO_BLOCK_CACHE_CAPACITY = 2LL * 1024 * 1024 * 1024; // 2GB
+    constexpr int DIRECT_IO_READ_AHEAD_GOP_CNT = 2;
+    constexpr int DIRECT_IO_AUDIO_READ_AHEAD_SAMPLE_CNT = 200;
+
+    // Local SSD tier in front of the network file system. opt-in.
+    constexpr bool USE_LOCAL_TIER_CACHE = false;
+    constexpr int64_t LOCAL_TIER_CACHE_QUOTA_BYTES = 200LL * 1024 * 1024 * 1024; // 200GB
+    constexpr int LOCAL_TIER_PROMOTION_ACCESS_CNT = 1; // copy on first access
+    constexpr int LOCAL_TIER_COPY_CHUNK_SIZE = 4 * 1024 * 1024; // 4MB
+    // a failed copy is retried after this, doubled on every failure up to the max.
+    constexpr int64_t LOCAL_TIER_COPY_RETRY_BASE_MS = 60 * 1000; // 1 min
+    constexpr int64_t LOCAL_TIER_COPY_RETRY_MAX_MS = 60 * 60 * 1000; // 1 hour
+
+    // Preload. all .asv/.asa bytes of these contents are pinned in RAM on start up.
+    // can also be changed at runtime with 'pin <title>' and 'unpin <title>' console commands.
+    const std::vector<std::string> PRELOAD_CONTENT_LIST = {};
+    constexpr char PIN_COMMAND[] = "pin";
+    constexpr char UNPIN_COMMAND[] = "unpin";
+    constexpr char PINNED_LIST_COMMAND[] = "pinned";
+    constexpr int CONSOLE_INPUT_POLL_INTERVAL_MS = 200; // the console thread checks its stop flag this often.
 
     // Keys
     constexpr char SSRC_KEY[] = "ssrc=";
@@ -94,11 +155,17 @@ namespace C {
 
     // RTSP
     constexpr int RTSP_MSG_BUFFER_SIZE = 10*1024; // 10 KB
+    constexpr size_t RTSP_RESPONSE_RESERVE_SIZE = 1024; // grows for a long SDP and keeps the capacity.
+    constexpr size_t RTSP_TX_FREE_BUF_CNT = 4; // sent response buffers kept for reuse per session.
+    constexpr int RTSP_MAX_HEADER_CNT = 32;
+    constexpr size_t RTSP_MAX_HEADER_BLOCK_SIZE = 16*1024; // 16 KB. longer request without CRLF2 is rejected.
+    constexpr size_t RTSP_MAX_BODY_SIZE = 64*1024; // 64 KB
     const std::vector<std::string> RTSP_METHOD_VECTOR = {
         "DESCRIBE","SETUP","PLAY","PAUSE","TEARDOWN","SET_PARAMETER","OPTIONS" // !! "OPTIONS" must be the last.
     };
     constexpr int OK = 200;
     constexpr int BAD_REQUEST = 400;
+    constexpr int NOT_FOUND = 404;
     constexpr int METHOD_NOT_ALLOWED = 405;
     constexpr int SESSION_NOT_FOUND = 454;
     constexpr int NOT_IMPLEMENTED = 501;
@@ -106,6 +173,7 @@ namespace C {
     const std::unordered_map<int, std::string> RTSP_STATUS_CODES_MAP = {
         {200, "OK"},
         {400, "Bad Request"},
+        {404, "Not Found"},
         {405, "Method Not Allowed"},
         {454, "Session Not Found"},
         {501, "Not Implemented"},
@@ -120,6 +188,9 @@ namespace C {
     constexpr char P_FRAME_KEY[] = "PFrameInfo";
     constexpr char REF_CAM[] = "cam0";
     const std::vector<std::string> ADAPTIVE_BITRATE_REF_CAM_LIST = {"cam0-10m"};
+    // bitrate variant cam directory. e.g. cam1-5m is cam1 at 5 mbps.
+    constexpr char ADAPTIVE_BITRATE_DIR_DELIMITER = '-';
+    constexpr char ADAPTIVE_BITRATE_MBPS_SUFFIX = 'm';
 
     // Stream ID
     constexpr int VIDEO_ID = 0;
@@ -147,7 +218,21 @@ namespace C {
     constexpr int64_t OFFSET_1900_TO_1970 = 2208988800L;//((365L * 70L) + 17L) * 24L * 60L * 60L;
 
     // Monitoring HTTP Server
-    constexpr int MONITORING_HTTP_SERVER_PORT = 80;
+    // prometheus text format on GET /metrics, served by its own thread. a failed bind never stops the rtsp server.
+    // opt in. bound to the loopback by default, so that a scraper on the same host or a tunnel is needed.
+    constexpr bool USE_MONITORING_HTTP_SERVER = false;
+    constexpr char MONITORING_HTTP_SERVER_ADDRESS[] = "127.0.0.1";
+    constexpr int MONITORING_HTTP_SERVER_PORT = 9554;
+    constexpr char MONITORING_METRICS_PATH[] = "/metrics";
+    constexpr size_t MONITORING_HTTP_MAX_REQUEST_SIZE = 8*1024;
+    // a connection not answered within this is closed. e.g. a client which never ends its request head.
+    constexpr int MONITORING_HTTP_TIMEOUT_MS = 3000;
+    // a series per session id for every session metric. off, since it grows with the session cnt.
+    // the sums over the live sessions are written either way.
+    constexpr bool USE_MONITORING_PER_SESSION_METRICS = false;
+    // a video frame is on time if its last packet is written within this after its deadline.
+    // the same bound as 'Over 33 ms Cnt' of the client side test results.
+    constexpr int64_t FRAME_ON_TIME_THRESHOLD_US = 33 * 1000;
     constexpr char QUOTATION_MARK = '"';
     const std::set<std::string> VIDEO_ID_SET = {
         "10", "11", "12", "13", "20", "21", "22", "23", "30", "31", "32", "33"
@@ -168,6 +253,11 @@ namespace C {
     constexpr char STOP_P_FRAMES[] = "stop-p";
     constexpr int P_FRAME_GOP_CONTROL_FACTOR_FOR_SEEK = 2;
     constexpr int FAST_TX_FACTOR_FOR_CAM_SWITCHING = 25;
+    // head of the current gop of every other cam is kept in memory, so that cam switching starts without disk reads.
+    constexpr bool USE_CAM_SWITCH_PREWARM = false;
+    constexpr int CAM_SWITCH_PREWARM_THREAD_CNT = 4; // prewarm reads block on the disk. never on the io threads.
+    constexpr int CAM_SWITCH_PREWARM_SAMPLE_CNT = 5; // key frame and the first P frames
+    constexpr int CAM_SWITCH_PREWARM_GOP_CNT = 2; // current and next gop. clients usually switch on the next key frame.
     constexpr int UPDATE_CAM_SWITCHING_STATUS_DELAY_MILLIS = 2000;
 
     // Hybrid
@@ -211,6 +301,16 @@ namespace C {
 
     // Bitrate monitoring
     constexpr int TX_BITRATE_SAMPLING_PERIOD_MS = 1000;
+
+    // Server side adaptive bitrate. decided every TX_BITRATE_SAMPLING_PERIOD_MS, applied on the next key frame.
+    constexpr bool USE_SERVER_SIDE_ABR = false;
+    constexpr double ABR_DOWN_SWITCH_RX_RATIO = 0.8; // client receives less than 80% of what was sent
+    constexpr double ABR_UP_SWITCH_RX_RATIO = 0.95;
+    constexpr int64_t ABR_DOWN_SWITCH_BACKLOG_BYTES = MAX_CLIENT_BUFFER_SIZE / 2; // samples not written to the socket yet
+    constexpr int64_t ABR_UP_SWITCH_BACKLOG_BYTES = MAX_CLIENT_BUFFER_SIZE / 16;
+    constexpr int64_t ABR_RX_BITRATE_STALE_MS = 5000;
+    constexpr int64_t ABR_DOWN_SWITCH_HOLD_MS = 3000; // queued samples of the previous variant drain first
+    constexpr int64_t ABR_UP_SWITCH_HOLD_MS = 10000; // healthy this long before going up
 }
 
 #endif // C_H
\ No newline at end of file
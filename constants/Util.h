@@ -16,6 +16,10 @@
 #include <future>
 #include <thread>
 #include <optional>
+#include <string_view>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
 #include <boost/asio.hpp>
 
 #include "../constants/C.h"
@@ -50,6 +54,18 @@ namespace Util {
 #endif
 	}
 
+	// pins the calling thread to one core. linux only. no-op on other platforms.
+	inline void set_thread_affinity(int coreIdx) {
+#ifdef __linux__
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		CPU_SET(coreIdx % static_cast<int>(std::thread::hardware_concurrency()), &cpuSet);
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) != 0) {
+			std::cerr << "Failed to set thread affinity\n";
+		}
+#endif
+	}
+
 	inline std::string getRandomKey(int bitLength) {
 		const std::vector<int> allowedBits = {32, 64, 128, 192, 256};
 		if (std::find(allowedBits.begin(), allowedBits.end(), bitLength) == allowedBits.end()) {
@@ -166,6 +182,60 @@ namespace Util {
 		return str.substr(start, end - start + 1);
 	}
 
+	// no allocation. view of the same chars.
+	inline std::string_view trimView(std::string_view str) {
+		const size_t start = str.find_first_not_of(" \t\r\n");
+		if (start == std::string_view::npos) return {};
+		const size_t end = str.find_last_not_of(" \t\r\n");
+		return str.substr(start, end - start + 1);
+	}
+
+	inline bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+		if (lhs.size() != rhs.size()) return false;
+		for (size_t i = 0; i < lhs.size(); ++i) {
+			if (std::tolower(static_cast<unsigned char>(lhs[i])) != std::tolower(static_cast<unsigned char>(rhs[i]))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// integer types only. false if the whole trimmed string is not a number.
+	template <typename T>
+	inline bool parseNumber(std::string_view str, T& outValue) {
+		str = trimView(str);
+		if (str.empty()) return false;
+		const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), outValue);
+		return ec == std::errc() && ptr == str.data() + str.size();
+	}
+
+	// floating point std::from_chars is not available on every supported toolchain. parse from a stack copy.
+	inline bool parseFloat(std::string_view str, float& outValue) {
+		str = trimView(str);
+		char buf[32];
+		if (str.empty() || str.size() >= sizeof(buf)) return false;
+		std::memcpy(buf, str.data(), str.size());
+		buf[str.size()] = '\0';
+		char* end = nullptr;
+		outValue = std::strtof(buf, &end);
+		return end == buf + str.size();
+	}
+
+	// value of the key in "k1=v1;k2=v2" style string. empty if not found.
+	inline std::string_view findParamValue(std::string_view params, std::string_view key, char delimiter = ';') {
+		while (!params.empty()) {
+			const size_t end = params.find(delimiter);
+			const std::string_view token = trimView(params.substr(0, end));
+			const size_t eq = token.find('=');
+			if (eq != std::string_view::npos && trimView(token.substr(0, eq)) == key) {
+				return trimView(token.substr(eq + 1));
+			}
+			if (end == std::string_view::npos) break;
+			params.remove_prefix(end + 1);
+		}
+		return {};
+	}
+
 	inline std::string getNameOnly(const std::string& fileName) {
 		// find the last occurrence of the dot
 		size_t pos = fileName.find_last_of('.');
@@ -279,15 +349,6 @@ namespace Util {
 			   (static_cast<int32_t>(metaLenBuf[3]));
 	}
 
-	inline void delayedExecutorAsyncByThread(
-		int delayInMillis, const std::function<void()>& task
-	) {
-		std::thread([delayInMillis, task]() {
-			std::this_thread::sleep_for(std::chrono::milliseconds(delayInMillis));
-			task();
-		}).detach();
-	}
-
 	inline void delayedExecutorAsyncByIoContext(
 		boost::asio::io_context& io_context, int delayInMillis, std::function<void()> task
 	) {
@@ -0,0 +1,29 @@
+#ifndef ABRCONTROLLER_H
+#define ABRCONTROLLER_H
+
+#include <cstdint> // for int64_t
+
+// Picks the bitrate variant of a session. variant 0 is the highest bitrate.
+// Goes one step down as soon as the client falls behind,
+// and one step up only after the stream stayed healthy for C::ABR_UP_SWITCH_HOLD_MS.
+// Steps from the variant the stream actually plays, so that a switch which was not applied is asked again.
+class AbrController {
+public:
+    explicit AbrController() = default;
+
+    void reset(int inputVariantCnt);
+
+    // curVariantIdx : the variant being sent now. a requested one which is not applied yet does not count.
+    // txBps : sent by the server in the last sampling period.
+    // rxBps : latest bitrate reported by the client. C::INVALID if there is no recent report.
+    // backlogBytes : bytes of the samples which are read but not written to the socket yet.
+    // returns the variant to switch to. curVariantIdx if nothing has to change.
+    int decide(int curVariantIdx, int64_t txBps, int64_t rxBps, int64_t backlogBytes, int64_t nowMillis);
+
+private:
+    int variantCnt = 0;
+    int64_t lastSwitchTimeMillis = 0;
+    int64_t healthySinceMillis = -1;
+};
+
+#endif // ABRCONTROLLER_H
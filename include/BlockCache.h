@@ -0,0 +1,102 @@
+#ifndef BLOCKCACHE_H
+#define BLOCKCACHE_H
+
+#include <atomic>
+#include <cstdint> // For int64_t
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/Logger.h"
+
+// Application managed block cache for the opt-in O_DIRECT read path.
+// Blocks are read with aligned buffers, bypassing the kernel page cache, and are
+// kept or evicted according to the playback windows reported by active sessions.
+// Blocks that no session will need soon are evicted first, which an LRU page cache cannot know.
+class BlockCache {
+public:
+  explicit BlockCache(int64_t inputCapacityBytes, int64_t inputBlockSize);
+  ~BlockCache();
+
+  // rule of five. BlockCache is not allowed to copy or move.
+  BlockCache(const BlockCache&) = delete;
+  BlockCache& operator=(const BlockCache&) = delete;
+  BlockCache(BlockCache&&) noexcept = delete;
+  BlockCache& operator=(BlockCache&&) noexcept = delete;
+
+  // copies [offset, offset + len) of the file into dst. returns false if direct I/O is not available.
+  [[nodiscard]] bool read(const std::string& filePath, int64_t offset, int64_t len, unsigned char* dst) noexcept;
+
+  // byte range of the file which the session is going to read soon.
+  void updatePlaybackWindow(
+    const std::string& sessionId, const std::string& filePath, int64_t beginOffset, int64_t endOffset
+  );
+  void removeSession(const std::string& sessionId);
+  // drops every cached block of the files under the directory. used when the content is replaced.
+  void invalidate(const std::string& dirPath);
+
+  std::string getStats();
+  void shutdown();
+
+private:
+  struct AlignedDeleter {
+    void operator()(unsigned char* ptr) const noexcept;
+  };
+
+  struct Block {
+    std::unique_ptr<unsigned char, AlignedDeleter> data;
+    int64_t validLen = 0;
+    uint64_t lastAccessTick = 0;
+  };
+
+  // closes the fd when the last reader releases it. invalidate() never closes an fd under a running read.
+  struct FileHandle {
+    int fd = -1;
+
+    explicit FileHandle(int inputFd) : fd(inputFd) {}
+    ~FileHandle();
+
+    // rule of five. FileHandle is not allowed to copy or move.
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+    FileHandle(FileHandle&&) noexcept = delete;
+    FileHandle& operator=(FileHandle&&) noexcept = delete;
+  };
+
+  struct FileEntry {
+    std::shared_ptr<FileHandle> fileHandlePtr = nullptr;
+    uint64_t generation = 0; // a block loaded under an older generation is not cached.
+    std::unordered_map<int64_t, std::shared_ptr<Block>> blocks; // block index, block
+  };
+
+  struct PlaybackWindow {
+    std::string filePath;
+    int64_t beginBlockIdx;
+    int64_t endBlockIdx;
+  };
+
+  std::shared_ptr<Block> getBlock(const std::string& filePath, int64_t blockIdx);
+  std::shared_ptr<Block> loadBlock(int fd, int64_t blockIdx);
+  // nullptr if the file can not be opened.
+  FileEntry* getFileEntry(const std::string& filePath);
+  void evictIfNeeded();
+
+  std::shared_ptr<Logger> logger;
+  const int64_t capacityBytes;
+  const int64_t blockSize;
+
+  std::mutex lock;
+  std::unordered_map<std::string, FileEntry> files;
+  std::unordered_map<std::string, std::vector<PlaybackWindow>> sessionWindows;
+  int64_t cachedBytes = 0;
+  uint64_t accessTick = 0;
+  uint64_t lastGeneration = 0;
+
+  std::atomic<int64_t> hitCnt = 0;
+  std::atomic<int64_t> missCnt = 0;
+  std::atomic<int64_t> evictedCnt = 0;
+};
+
+#endif //BLOCKCACHE_H
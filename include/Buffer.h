@@ -1,6 +1,7 @@
 #ifndef BUFFER_H
 #define BUFFER_H
 
+#include <cstdint> // For uint8_t
 #include <vector>
 #include <string>
 #include <functional> // For std::function
@@ -17,7 +18,8 @@ public:
     int bodyLen = C::UNSET; // len == rtsp message + bodylen. only if bodd message exists.
     int sampleNo = C::UNSET;
     int mediaType = C::UNSET;
-    std::function<void()> afterTx;
+    uint8_t rtspResponseFlags = 0; // bits of RtspResponseFlag. only for rtsp responses.
+    std::function<void()> afterTx; // only for rtsp responses. run by the tx thread after the response was written.
 
     explicit Buffer();
 
@@ -25,7 +27,7 @@ public:
 
     explicit Buffer(const std::vector<unsigned char>& buf, const int offset, const int len);
 
-    void updateBuf(const std::vector<unsigned char>& inputBuf);
+    void updateBuf(std::vector<unsigned char> inputBuf);
 
     static Buffer kill();
 
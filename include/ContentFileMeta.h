@@ -10,6 +10,15 @@
 #include "../include/Logger.h"
 #include "../include/VideoAccess.h"
 #include "../include/AudioAccess.h"
+#include "../include/ContentIndexSidecar.h"
+
+// DESCRIBE body of the content. rendered once on load since it depends only on the content.
+struct PreRenderedSdp {
+    std::string sdp;
+    // track id, url suffix. ex) 0, "/trackID=0". only the tracks this server streams.
+    std::vector<std::pair<int, std::string>> trackUrlSuffixes;
+    int kbpsBitrate = 0; // sum of b=AS values. bitrate of the first play.
+};
 
 using HybridMetaMapType
     = std::unordered_map<int, std::unordered_map<std::string, std::unordered_map<int, HybridSampleMeta>>>;
@@ -33,16 +42,34 @@ public:
     void shutdown();
     RtpInfo getRtpInfoCopy();
     std::string getMediaInfoCopy();
-    std::vector<unsigned char> getAccDataCopy();
-    std::vector<std::vector<unsigned char>> getAllV0ImagesCopy();
+    std::shared_ptr<const PreRenderedSdp> getPreRenderedSdp() const;
+    // loaded once in init(). immutable and shared by every session of the content.
+    std::shared_ptr<const std::vector<unsigned char>> getAccData() const;
+    std::shared_ptr<const std::vector<std::vector<unsigned char>>> getAllV0Images() const;
     int getAudioSampleSize() const;
     int getVideoSampleSize() const;
     const AudioAccess& getConstAudioMeta() const;
     const std::unordered_map<std::string, VideoAccess>& getConstVideoMeta() const;
+    // bitrate variants in mbps, the highest first. empty if the content has no bitrate variant cam directory.
+    const std::vector<int>& getMbpsTypeList() const;
+    // the cam directory which has the config and the audio. cam0, or cam0 of the highest bitrate.
+    const std::string& getRefCamDirName() const;
+    // nullptr if there is no such cam directory. mbps is C::INVALID for the content without bitrate variants.
+    const VideoAccess* findVideoAccess(int camId, int mbps) const;
+    // e.g. cam1 for (1, C::INVALID), cam1-5m for (1, 5)
+    static std::string getCamDirName(int camId, int mbps);
+    // first rtp header of a sample of the ref cam's front video or the audio. no disk access.
+    // false if the sample has no rtp packet or its header could not be read on load.
+    bool getFirstRtpHead(int streamId, int sampleNo, SampleRtpHead& outRtpHead) const;
 
 private:
     bool handleCamDirectories(const std::filesystem::path& inputCidDirectory);
+    static bool isRefCamDirectory(const std::string& camDirectoryName);
+    // C::INVALID if the cam directory is not a bitrate variant.
+    static int parseMbps(const std::string& camDirectoryName);
+    bool initMbpsTypeList();
     bool handleConfigFile(const std::filesystem::path& inputCidDirectory);
+    bool renderDescribeSdp();
     bool handleV0Images(const std::filesystem::path& inputCidDirectory);
     bool loadStreamFilesInCamDirectories(const std::filesystem::path& inputCidDirectory);
     void loadRtspRtpConfig(const std::filesystem::path& rtspConfig);
@@ -56,17 +83,26 @@ private:
         const std::filesystem::path& inputCamDir, std::vector<std::filesystem::path>& videos
     );
     void loadRtpMemberVideoMetaData(
-        int64_t videoFileSize,
-        std::ifstream &inputIfstream,
+        const SampleSizesView& sizes,
         std::vector<std::vector<VideoSampleInfo>>& input2dMetaList,
         int memberId
     );
     void showVideoMinMaxSize(const std::vector<VideoSampleInfo>& videoMetaData, int memberId);
 
     std::vector<std::vector<VideoSampleInfo>> getVideoMetaInternal(std::string camId);
+    SampleSizesView loadSampleSizes(const std::filesystem::path& filePath, std::vector<int16_t>& ownedSizes);
     std::vector<unsigned char> readMetaData(int64_t fileSize, std::ifstream& inputFileStream);
     // to mimic java's short type in multiplatform.
     std::vector<int16_t> getSizes(std::vector<unsigned char>& metaData);
+    // sampleRanges : offset and length of every sample in the file.
+    void loadSampleRtpHeads(
+        const std::filesystem::path& filePath,
+        const std::vector<std::pair<int64_t, int64_t>>& sampleRanges,
+        std::vector<SampleRtpHead>& outRtpHeads
+    );
+    std::vector<SampleRtpHead> readSampleRtpHeads(
+        const std::filesystem::path& filePath, const std::vector<std::pair<int64_t, int64_t>>& sampleRanges
+    );
 
     // members
     std::shared_ptr<Logger> logger;
@@ -77,10 +113,19 @@ private:
 
     AudioAccess audioFile;
     std::unordered_map<std::string, VideoAccess> videoFiles;
+    std::string refCamDirName = C::REF_CAM;
+    std::vector<int> mbpsTypeList;
+    // same index as the sample infos. written by the ref cam loading only.
+    std::vector<SampleRtpHead> refVideoRtpHeads;
+    std::vector<SampleRtpHead> audioRtpHeads;
+    std::unique_ptr<ContentIndexSidecar> indexSidecarPtr = nullptr; // alive only while init()
 
     std::string rtspSdpMessage;
     RtpInfo rtpInfo;
     std::vector<std::filesystem::path> v0Images;
+    std::shared_ptr<const PreRenderedSdp> preRenderedSdp;
+    std::shared_ptr<const std::vector<unsigned char>> accData;
+    std::shared_ptr<const std::vector<std::vector<unsigned char>>> v0ImageData;
 };
 
 #endif //FILEREADER_H
@@ -0,0 +1,98 @@
+#ifndef CONTENTINDEXSIDECAR_H
+#define CONTENTINDEXSIDECAR_H
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdint> // For int64_t
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/Logger.h"
+
+// read only view of the sample size array. points into the mapped sidecar or into an owned vector.
+struct SampleSizesView {
+  const int16_t* data = nullptr;
+  size_t cnt = 0;
+};
+
+// first rtp header fields of one sample. lets seek and cam switching skip reading the sample.
+struct SampleRtpHead {
+  uint32_t timestamp = 0;
+  uint16_t seq = 0;
+  uint16_t isValid = 0; // 0 if the sample has no rtp packet, e.g. a dummy sample
+};
+static_assert(sizeof(SampleRtpHead) == 8, "SampleRtpHead is stored in the sidecar as is.");
+
+struct SampleRtpHeadsView {
+  const SampleRtpHead* data = nullptr;
+  size_t cnt = 0;
+};
+
+// Persistent binary index of one content, stored as <content>/.index
+// Holds parsed sample size trailers of every .asv/.asa file, so that restart does not need to
+// seek and read the trailer of each file. Mapped into memory and read in place.
+// The reference streams also keep the first rtp header of each sample.
+// Each entry is valid only when the size and mtime of its file are unchanged.
+//
+// layout (native byte order, every section is 8 bytes aligned)
+//  header : magic[4] | version u32 | byte order mark u32 | entry cnt u32
+//  entry  : path len u32 | sample cnt u32 | file size i64 | mtime i64 | rtp head cnt u32 | pad u32
+//           | path | pad | int16 sizes[cnt] | pad | SampleRtpHead rtpHeads[rtp head cnt]
+class ContentIndexSidecar {
+public:
+  explicit ContentIndexSidecar(const std::filesystem::path& inputContentPath);
+  ~ContentIndexSidecar();
+
+  // rule of five. ContentIndexSidecar is not allowed to copy or move.
+  ContentIndexSidecar(const ContentIndexSidecar&) = delete;
+  ContentIndexSidecar& operator=(const ContentIndexSidecar&) = delete;
+  ContentIndexSidecar(ContentIndexSidecar&&) noexcept = delete;
+  ContentIndexSidecar& operator=(ContentIndexSidecar&&) noexcept = delete;
+
+  // returns false if there is no valid sidecar. not an error.
+  bool load();
+  bool save();
+
+  // thread safe. member cam directories are loaded concurrently.
+  bool find(const std::filesystem::path& filePath, SampleSizesView& outSizes);
+  void add(const std::filesystem::path& filePath, const std::vector<int16_t>& sizes);
+  // false if the entry has no rtp heads yet. addRtpHeads() needs the entry of find() or add().
+  bool findRtpHeads(const std::filesystem::path& filePath, SampleRtpHeadsView& outRtpHeads);
+  void addRtpHeads(const std::filesystem::path& filePath, const std::vector<SampleRtpHead>& rtpHeads);
+  bool needSave() const;
+
+  static int64_t getMtime(const std::filesystem::path& filePath);
+
+private:
+  struct Entry {
+    int64_t fileSize = 0;
+    int64_t mtime = 0;
+    SampleSizesView sizes;
+    std::vector<int16_t> ownedSizes; // empty if sizes points into the mapped region
+    SampleRtpHeadsView rtpHeads;
+    std::vector<SampleRtpHead> ownedRtpHeads;
+  };
+
+  // size and mtime of the file. false if it is gone.
+  static bool getFileStamp(const std::filesystem::path& filePath, int64_t& outFileSize, int64_t& outMtime);
+  // nullptr if there is no entry of the same file. lock must be held.
+  Entry* findValidEntry(const std::filesystem::path& filePath, int64_t fileSize, int64_t mtime);
+  std::string getRelativePath(const std::filesystem::path& filePath) const;
+
+  std::shared_ptr<Logger> logger;
+  std::filesystem::path contentPath;
+  std::filesystem::path sidecarPath;
+
+  std::unique_ptr<boost::interprocess::file_mapping> fileMappingPtr = nullptr;
+  std::unique_ptr<boost::interprocess::mapped_region> mappedRegionPtr = nullptr;
+
+  mutable std::mutex lock;
+  std::unordered_map<std::string, Entry> entries; // relative path, entry
+  bool isDirty = false;
+};
+
+#endif //CONTENTINDEXSIDECAR_H
@@ -0,0 +1,55 @@
+#ifndef CONTENTROOTWATCHER_H
+#define CONTENTROOTWATCHER_H
+
+#include <atomic>
+#include <cstdint> // For int64_t
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "../include/Logger.h"
+
+// Watches the content root and every directory below it with inotify.
+// Reports a content title once its directory got no more events for a while,
+// so that a title being copied is reloaded once, after the copy is done.
+// Hidden files such as the .index sidecar are ignored. linux only.
+class ContentRootWatcher {
+public:
+  explicit ContentRootWatcher(
+    std::filesystem::path inputRootPath,
+    std::function<void(const std::string&)> inputOnContentChanged
+  );
+  ~ContentRootWatcher();
+
+  // rule of five. ContentRootWatcher is not allowed to copy or move.
+  ContentRootWatcher(const ContentRootWatcher&) = delete;
+  ContentRootWatcher& operator=(const ContentRootWatcher&) = delete;
+  ContentRootWatcher(ContentRootWatcher&&) noexcept = delete;
+  ContentRootWatcher& operator=(ContentRootWatcher&&) noexcept = delete;
+
+  bool start();
+  void stop();
+
+private:
+  void run();
+  void handleEvents(int64_t now);
+  void addWatchRecursively(const std::filesystem::path& dir);
+  void markAllContentsChanged(int64_t now);
+  std::string getContentTitle(const std::filesystem::path& path) const;
+  static bool isIgnored(const std::string& fileName);
+
+  std::shared_ptr<Logger> logger;
+  const std::filesystem::path rootPath;
+  const std::function<void(const std::string&)> onContentChanged;
+
+  int inotifyFd = -1;
+  std::unordered_map<int, std::filesystem::path> watchDirs; // watch descriptor, directory
+  std::unordered_map<std::string, int64_t> pendingTitles; // content title, last event time ms
+
+  std::atomic<bool> isStopped = false;
+  std::thread watcherThread;
+};
+
+#endif //CONTENTROOTWATCHER_H
@@ -1,8 +1,17 @@
 #ifndef CONTENTSSTORAGE_H
 #define CONTENTSSTORAGE_H
 #include <unordered_map>
+#include <mutex>
+#include <future>
+#include <atomic>
+#include <functional>
+#include <boost/asio/thread_pool.hpp>
 
 #include "../include/ContentFileMeta.h"
+#include "../include/BlockCache.h"
+#include "../include/TieredContentCache.h"
+#include "../include/PinnedContent.h"
+#include "../include/ContentRootWatcher.h"
 
 class ContentsStorage {
 public:
@@ -17,16 +26,78 @@ public:
 
   void init();
 
-  ContentFileMeta& getCid(std::string cid);
-  const std::unordered_map<std::string, ContentFileMeta>& getContentFileMetaMap() const;
+  // loads the meta of the content on the first request when lazy loading is on.
+  // concurrent requests for the same content wait for one loading. nullptr for unknown or broken contents.
+  // lock free if the meta is already loaded.
+  std::shared_ptr<ContentFileMeta> getCid(const std::string& cid);
+  // true if the content exists but its meta is not loaded yet. false after a failed loading.
+  bool needsLoading(const std::string& cid) const;
+  // loads the meta on the loader pool, not on the caller's thread. onLoaded is called on a loader thread,
+  // even if loading failed. getCid() returns the meta without blocking after that.
+  void loadContentAsync(const std::string& cid, std::function<void()> onLoaded);
+  bool hasContent(const std::string& cid) const;
+  // changes when the content directory is reloaded. 0 if the content does not exist.
+  uint64_t getContentRevision(const std::string& cid) const;
+  // drops metas which no session holds and nobody requested for a while.
+  void evictColdContents();
+  // hot reload. sessions keep the meta they got until they end.
+  void startWatchingContentRoot();
   void shutdown();
   std::string getContentRootPath();
 
+  // nullptr if direct I/O block cache is not in use.
+  BlockCache* getBlockCache() const;
+
+  // blocking sample reads for cam switch prewarm. nullptr if prewarm is not in use.
+  boost::asio::thread_pool* getPrewarmThreadPool() const;
+
+  // local SSD tier. nullptr if not in use.
+  void initTierCache(const std::string& fastRootPath);
+  TieredContentCache* getTierCache() const;
+
+  // preload. sessions which already hold the pinned content keep it until they end.
+  bool pinContent(const std::string& contentTitle);
+  bool unpinContent(const std::string& contentTitle);
+  std::shared_ptr<const PinnedContent> getPinnedContent(const std::string& contentTitle) const;
+  std::vector<std::string> getPinnedContentTitles() const;
+
 private:
+  // immutable once published. every change publishes a new catalog and readers never lock.
+  struct ContentCatalog {
+    struct Entry {
+      std::shared_ptr<ContentFileMeta> metaPtr = nullptr; // nullptr until the first request
+      std::shared_ptr<std::atomic<int64_t>> lastAccessTimeMillisPtr; // shared by every catalog version
+      uint64_t revision = 0; // changes when the content directory is reloaded
+      bool isLoadFailed = false; // not loaded again until the content directory is reloaded
+    };
+    std::unordered_map<std::string, Entry> entries; // every content directory in the root
+  };
+
+  std::shared_ptr<const ContentCatalog> getCatalog() const;
+  void publishCatalog(std::shared_ptr<const ContentCatalog> newCatalogPtr);
+  ContentCatalog::Entry makeCatalogEntry(std::shared_ptr<ContentFileMeta> metaPtr);
+  std::shared_ptr<ContentFileMeta> loadContent(const std::string& contentTitle);
+  void reloadContent(const std::string& contentTitle);
+
   std::shared_ptr<Logger> logger;
   std::filesystem::path parent;
-  std::unordered_map<std::string, ContentFileMeta> readers;
+
+  // accessed only with std::atomic_load and std::atomic_store.
+  std::shared_ptr<const ContentCatalog> catalogPtr = std::make_shared<const ContentCatalog>();
+  // serializes writers. guards loadingContents and catalogRevision.
+  std::mutex catalogWriteLock;
+  std::unordered_map<std::string, std::shared_future<std::shared_ptr<ContentFileMeta>>> loadingContents;
+  uint64_t catalogRevision = 0;
+  // lazy loading runs here, so that a slow network file system never stalls an io thread.
+  std::unique_ptr<boost::asio::thread_pool> loaderThreadPoolPtr = nullptr;
+  std::unique_ptr<boost::asio::thread_pool> prewarmThreadPoolPtr = nullptr;
+  std::unique_ptr<ContentRootWatcher> rootWatcherPtr = nullptr;
   std::string contentRootPath;
+  std::unique_ptr<BlockCache> blockCachePtr = nullptr;
+  std::unique_ptr<TieredContentCache> tierCachePtr = nullptr;
+
+  mutable std::mutex pinnedContentsLock;
+  std::unordered_map<std::string, std::shared_ptr<const PinnedContent>> pinnedContents;
 };
 
 #endif //CONTENTSSTORAGE_H
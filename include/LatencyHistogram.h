@@ -0,0 +1,79 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstdint> // For int64_t
+#include <string>
+#include <vector>
+
+#include "../constants/C.h"
+
+// HDR style log linear histogram of values in us, for the hot paths.
+// Each power of two range is split into SUB_BUCKET_CNT buckets, so the relative error is about 3%.
+// A thread writes to its own shard with relaxed adds only. the shards are merged on read.
+// A histogram of a single writer thread needs one shard only, e.g. of a session's tx thread.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr int64_t SUB_BUCKET_CNT = int64_t{1} << SUB_BUCKET_BITS;
+    static constexpr int MAX_MSB = 26; // about 134 sec. larger values go to the last bucket.
+    static constexpr int64_t MAX_VALUE_US = (int64_t{1} << (MAX_MSB + 1)) - 1;
+    static constexpr size_t BUCKET_CNT = (MAX_MSB - SUB_BUCKET_BITS + 2) * SUB_BUCKET_CNT;
+
+    // merged view of every shard. not a consistent cut, which is fine for monitoring.
+    struct Snapshot {
+        std::array<uint64_t, BUCKET_CNT> counts{};
+        uint64_t totalCnt = 0;
+        int64_t sumUs = 0;
+        int64_t maxUs = 0;
+
+        // the highest value of the bucket holding the quantile. e.g. 0.99 for p99.
+        int64_t getValueAtQuantile(double quantile) const;
+        // values in the same bucket as valueUs are counted too. off by one bucket width at most.
+        uint64_t getCountAtOrBelow(int64_t valueUs) const;
+    };
+
+    explicit LatencyHistogram(size_t inputShardCnt = C::LATENCY_HISTOGRAM_SHARD_CNT);
+
+    // rule of five. LatencyHistogram is not allowed to copy or move.
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+    LatencyHistogram(LatencyHistogram&&) noexcept = delete;
+    LatencyHistogram& operator=(LatencyHistogram&&) noexcept = delete;
+
+    // may be called from any thread. negative values are counted as 0.
+    void record(int64_t valueUs);
+    Snapshot getSnapshot() const;
+    // e.g. cnt:1200, p50:85us, p99:410us, p999:1023us, max:2871us
+    std::string toString() const;
+
+    static size_t getBucketIdx(int64_t valueUs);
+    static int64_t getBucketUpperBoundUs(size_t bucketIdx);
+
+private:
+    // one cache line apart, so that threads on different shards never share a line.
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, BUCKET_CNT> buckets{};
+        std::atomic<int64_t> sumUs = 0;
+        std::atomic<int64_t> maxUs = 0;
+    };
+
+    // assigned round robin on the first record of a thread.
+    static size_t getThreadShardIdx();
+
+    std::vector<Shard> shards;
+};
+
+// process wide histograms of the hot paths.
+struct HotPathMetrics {
+    LatencyHistogram sampleReadUs;         // one sample from the cache or the file, in RtpHandler.
+    LatencyHistogram rtpQueueDwellUs;      // from enqueueRtpInfo() to the end of the socket write.
+    LatencyHistogram socketWriteUs;        // one blocking write of an rtp packet or an rtsp response.
+    LatencyHistogram periodicTaskLatenessUs; // wake up lateness of every PeriodicTask.
+    LatencyHistogram frameLatenessUs;      // last packet of a video frame written, after its deadline. early is 0.
+
+    static HotPathMetrics& getShared();
+};
+
+#endif // LATENCYHISTOGRAM_H
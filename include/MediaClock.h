@@ -0,0 +1,92 @@
+#ifndef MEDIACLOCK_H
+#define MEDIACLOCK_H
+
+#include <boost/asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint> // For int64_t
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../include/Logger.h"
+#include "../include/PeriodicTask.h"
+
+// One media tick timer for every session of a worker io_context.
+// A track is a sample producer of a session, e.g. video or audio, run on absolute deadlines.
+// Each wake up scans the compact track array once and runs every track which is due,
+// on the strand of its session. Missed ticks are run back to back, like CatchUpPolicy::BURST.
+class MediaClock {
+public:
+    using TrackId = uint64_t;
+    static constexpr TrackId INVALID_TRACK_ID = 0;
+
+    explicit MediaClock(boost::asio::io_context& inputIoContext);
+    ~MediaClock();
+
+    // rule of five. MediaClock is not allowed to copy or move.
+    MediaClock(const MediaClock&) = delete;
+    MediaClock& operator=(const MediaClock&) = delete;
+    MediaClock(MediaClock&&) noexcept = delete;
+    MediaClock& operator=(MediaClock&&) noexcept = delete;
+
+    // may be called from any thread. the first run is one interval later.
+    // the track is dropped once the owner expires.
+    TrackId addTrack(
+        boost::asio::strand<boost::asio::io_context::executor_type> trackStrand,
+        std::chrono::microseconds interval,
+        std::weak_ptr<void> owner,
+        std::function<void()> task
+    );
+    // may be called from any thread. a run already posted to the strand is dropped too.
+    void removeTrack(TrackId trackId);
+    void stop();
+
+    size_t getTrackCnt() const;
+    const LatenessHistogram& getLatenessHistogram() const;
+
+private:
+    struct Track {
+        Track(
+            boost::asio::strand<boost::asio::io_context::executor_type> inputStrand,
+            std::weak_ptr<void> inputOwner,
+            std::function<void()> inputTask
+        ) : strand(std::move(inputStrand)), owner(std::move(inputOwner)), task(std::move(inputTask)) {}
+
+        boost::asio::strand<boost::asio::io_context::executor_type> strand;
+        std::weak_ptr<void> owner;
+        std::function<void()> task;
+        std::atomic<bool> isActive = true;
+    };
+
+    // hot part of a track. scanned on every wake up.
+    struct TrackSlot {
+        TrackId trackId;
+        std::chrono::steady_clock::time_point nextDeadline;
+        std::chrono::microseconds interval;
+        std::shared_ptr<Track> trackPtr;
+    };
+
+    struct DueTrack {
+        std::shared_ptr<Track> trackPtr;
+        int64_t runCnt;
+    };
+
+    void arm();
+    void onTick();
+
+    std::shared_ptr<Logger> logger;
+    boost::asio::strand<boost::asio::io_context::executor_type> clockStrand;
+    boost::asio::steady_timer timer;
+    LatenessHistogram latenessHistogram;
+
+    mutable std::mutex lock;
+    std::vector<TrackSlot> trackSlots;
+    std::vector<DueTrack> dueTracks; // reused on every tick. used on clockStrand only.
+    TrackId lastTrackId = INVALID_TRACK_ID;
+    std::chrono::steady_clock::time_point armedDeadline = std::chrono::steady_clock::time_point::max();
+    bool isStopped = false;
+};
+
+#endif //MEDIACLOCK_H
@@ -0,0 +1,68 @@
+#ifndef METRICSHTTPSERVER_H
+#define METRICSHTTPSERVER_H
+
+#include <boost/asio.hpp>
+#include <cstdint> // For int64_t
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/LatencyHistogram.h"
+#include "../include/Logger.h"
+#include "../include/PeriodicTask.h"
+
+class Server;
+
+// Prometheus text format metrics on plain HTTP, with its own io_context and thread.
+// A scrape reads only the lock free counters of sessions, so it never waits for a session's strand.
+class MetricsHttpServer {
+public:
+  explicit MetricsHttpServer(Server& inputServer, std::string inputAddress, int inputPort);
+  ~MetricsHttpServer();
+
+  // rule of five. MetricsHttpServer is not allowed to copy or move.
+  MetricsHttpServer(const MetricsHttpServer&) = delete;
+  MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+  MetricsHttpServer(MetricsHttpServer&&) noexcept = delete;
+  MetricsHttpServer& operator=(MetricsHttpServer&&) noexcept = delete;
+
+  // false if the address is not valid or the port can not be bound.
+  bool start();
+  void stop();
+
+private:
+  struct HttpConnection;
+
+  void asyncAccept();
+  // closes the connection if it is not answered within C::MONITORING_HTTP_TIMEOUT_MS.
+  static void closeOnTimeout(const std::shared_ptr<HttpConnection>& connectionPtr);
+  void onRequest(const std::shared_ptr<HttpConnection>& connectionPtr);
+  void renderMetrics(std::string& out);
+  static void appendHistogram(
+    std::string& out,
+    const char* name,
+    const char* help,
+    const std::vector<const LatenessHistogram*>& histograms
+  );
+  // p50, p90, p99, p999 and max, as a summary. labels may be empty.
+  static void appendSummary(
+    std::string& out,
+    const char* name,
+    const std::string& labels,
+    const LatencyHistogram::Snapshot& snapshot
+  );
+  // -1 if the platform is not supported.
+  static int64_t getResidentMemoryBytes();
+
+  std::shared_ptr<Logger> logger;
+  Server& server;
+  const std::string address;
+  const int port;
+  boost::asio::io_context io_context;
+  boost::asio::ip::tcp::acceptor acceptor;
+  std::thread thread;
+  size_t lastResponseSize = 0; // to reserve the next one at once. used by the metrics thread only.
+};
+
+#endif //METRICSHTTPSERVER_H
@@ -2,10 +2,48 @@
 #define PERIODICTASK_H
 
 #include <boost/asio.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint> // For int64_t
 #include <functional>
+#include <string>
 
 #include "../include/Logger.h"
 
+// what to do when the task falls behind its deadlines.
+enum class CatchUpPolicy {
+    BURST, // runs the missed ticks back to back. keeps the number of runs. e.g. media sample reading.
+    SKIP   // drops the missed ticks and waits for the next deadline.
+};
+
+// latency in us, e.g. wake up lateness of a task against its absolute deadline, or file read time.
+// lock free. written and read from any thread.
+class LatenessHistogram {
+public:
+    // upper bounds of the buckets in us. the last bucket has no bound.
+    static constexpr std::array<int64_t, 10> BUCKET_BOUNDS_US = {
+        50, 100, 250, 500, 1000, 2000, 5000, 10000, 20000, 50000
+    };
+    static constexpr size_t BUCKET_CNT = BUCKET_BOUNDS_US.size() + 1;
+
+    void record(int64_t latenessUs);
+    void recordSkip(int64_t skippedCnt);
+
+    uint64_t getCount(size_t bucketIdx) const;
+    int64_t getMaxLatenessUs() const;
+    int64_t getSumUs() const;
+    int64_t getSkippedCnt() const;
+    std::string toString() const;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_CNT> buckets{};
+    std::atomic<int64_t> maxLatenessUs = 0;
+    std::atomic<int64_t> sumUs = 0;
+    std::atomic<int64_t> skippedCnt = 0;
+};
+
+// Runs the task on absolute deadlines. start + n * interval in us.
+// The task's own run time does not shift the later deadlines.
 class PeriodicTask {
 public:
     using TaskCallback = std::function<void()>;
@@ -14,34 +52,43 @@ public:
     explicit PeriodicTask(
         boost::asio::io_context& io_context,
         boost::asio::strand<boost::asio::io_context::executor_type> inputStrand,
-        std::chrono::milliseconds inputInterval
+        std::chrono::microseconds inputInterval
     );
 
     // constructor with task and interval
     explicit PeriodicTask(
         boost::asio::io_context& io_context,
         boost::asio::strand<boost::asio::io_context::executor_type> inputStrand,
-        std::chrono::milliseconds inputInterval,
+        std::chrono::microseconds inputInterval,
         TaskCallback inputTask
     );
 
     ~PeriodicTask();
 
     void setTask(TaskCallback inputTask);
-    void setInterval(std::chrono::milliseconds inputInterval);
+    // milliseconds convert to microseconds implicitly.
+    void setInterval(std::chrono::microseconds inputInterval);
+    void setCatchUpPolicy(CatchUpPolicy inputCatchUpPolicy);
     void start();
     void stop();
 
+    const LatenessHistogram& getLatenessHistogram() const;
+
 private:
     void scheduleTask();
+    void advanceDeadline(std::chrono::steady_clock::time_point now);
 
     std::shared_ptr<Logger> logger;
     boost::asio::strand<boost::asio::io_context::executor_type> strand;
     boost::asio::steady_timer timer;
-    std::chrono::milliseconds interval;
+    std::chrono::microseconds interval;
+    std::chrono::steady_clock::time_point nextDeadline;
+    CatchUpPolicy catchUpPolicy = CatchUpPolicy::SKIP;
+    LatenessHistogram latenessHistogram;
     TaskCallback task;
     bool running;
     bool isTaskSet;
+    uint64_t runId = 0; // a wait of the previous run is dropped after stop() and start().
 };
 
-#endif // PERIODICTASK_H
\ No newline at end of file
+#endif // PERIODICTASK_H
@@ -0,0 +1,42 @@
+#ifndef PINNEDCONTENT_H
+#define PINNEDCONTENT_H
+
+#include <cstdint> // For int64_t
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/Logger.h"
+
+// All .asv/.asa bytes of one content, loaded into locked memory.
+// Sessions of a pinned content serve samples without any disk I/O.
+// Immutable after load. shared by sessions through std::shared_ptr<const PinnedContent>.
+class PinnedContent {
+public:
+  explicit PinnedContent(const std::filesystem::path& inputContentPath);
+  ~PinnedContent();
+
+  // rule of five. PinnedContent is not allowed to copy or move.
+  PinnedContent(const PinnedContent&) = delete;
+  PinnedContent& operator=(const PinnedContent&) = delete;
+  PinnedContent(PinnedContent&&) noexcept = delete;
+  PinnedContent& operator=(PinnedContent&&) noexcept = delete;
+
+  [[nodiscard]] bool load();
+
+  // relativePath : path from the content directory. ex) cam0/V1H.asv
+  [[nodiscard]] bool read(const std::string& relativePath, int64_t offset, int64_t len, unsigned char* dst) const noexcept;
+
+  int64_t getByteSize() const;
+  bool isLocked() const;
+
+private:
+  std::shared_ptr<Logger> logger;
+  std::filesystem::path contentPath;
+  std::unordered_map<std::string, std::vector<unsigned char>> files;
+  int64_t byteSize = 0;
+  bool locked = false;
+};
+
+#endif //PINNEDCONTENT_H
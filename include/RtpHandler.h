@@ -2,6 +2,7 @@
 #define RTPHANDLER_H
 
 #include <filesystem>
+#include <mutex>
 
 #include "../constants/Util.h"
 #include "../include/Session.h"
@@ -15,7 +16,18 @@ struct Sample;
 using HybridMetaMapType
     = std::unordered_map<int, std::unordered_map<std::string, std::unordered_map<int, HybridSampleMeta>>>;
 
-class RtpHandler {
+// file ranges of one video sample of a sibling cam to keep in memory.
+struct PrewarmSampleRange {
+  int camId;
+  int variantIdx; // bitrate variant of the offsets
+  int sampleNo;
+  int64_t frontOffset;
+  int64_t frontLen;
+  int64_t rearOffset;
+  int64_t rearLen;
+};
+
+class RtpHandler : public std::enable_shared_from_this<RtpHandler> {
 public:
   explicit RtpHandler(
     std::string inputSessionId,
@@ -25,6 +37,10 @@ public:
   ~RtpHandler();
 
   [[nodiscard]] bool openAllFileStreamsForVideoAndAudio();
+  // for parking. false if nothing was open.
+  bool closeAllFileStreams();
+  // resolves the file paths again, so that a resumed session reads the current tier.
+  [[nodiscard]] bool reopenAllFileStreams();
 
   std::unique_ptr<Buffer> readFirstRtpOfCurVideoSample(int sampleNo, int64_t offset, int64_t len) noexcept;
 
@@ -43,16 +59,92 @@ public:
     int sampleNo, int64_t offset, int len, HybridMetaMapType &hybridMetaMap
   ) noexcept;
 
+  // report byte ranges that will be read soon to the block cache. no-op if the block cache is not in use.
+  void updateVideoPlaybackWindow(
+    int camId, int64_t frontBeginOffset, int64_t frontEndOffset, int64_t rearBeginOffset, int64_t rearEndOffset
+  );
+  void updateAudioPlaybackWindow(int64_t beginOffset, int64_t endOffset);
+
+  // replaces the prewarmed samples with these ones. read on the prewarm thread pool, not on the io threads.
+  void prewarmSamples(std::vector<PrewarmSampleRange> ranges);
+
+  // video samples are read from the files of this bitrate variant from now on. called on the strand.
+  // opens the files of the variant on its first switch. false if they can not be opened.
+  [[nodiscard]] bool setBitrateVariant(int variantIdx);
+
 private:
+  // where a read is served from before the file itself. replaced as a whole on every open,
+  // so that a prewarm job keeps reading from the one it took even if the strand reopens meanwhile.
+  struct ReadSource {
+    BlockCache* blockCachePtr = nullptr;
+    // not null if the content was pinned in RAM when the session opened it.
+    std::shared_ptr<const PinnedContent> pinnedContentPtr = nullptr;
+    std::unordered_map<std::string, std::string> pinnedKeyMap; // file path, relative path in content
+  };
+
+  struct PrewarmedSample {
+    int videoFileKey;
+    int sampleNo;
+    std::vector<unsigned char> frontBuf;
+    std::vector<unsigned char> rearBuf;
+  };
+
+  // every cam of the variant. files which are already open are kept.
+  bool openVideoFileStreamsOfVariant(int variantIdx);
+  void runPrewarm();
+  // copy of the prewarmed sample. nullptr if it is not in memory.
+  std::shared_ptr<Sample> findPrewarmedSample(int videoFileKey, int sampleNo, int vid);
+  void releaseTierContentPath();
+  // key of the video file maps. every cam of every bitrate variant has its own files.
+  static int toVideoFileKey(int variantIdx, int camId);
+
+  // from the read source of the strand. called on the strand only.
+  bool readBytes(
+    std::ifstream& fileStream, const std::string& filePath, int64_t offset, int64_t len, unsigned char* dst
+  ) noexcept;
+  static bool readBytes(
+    const ReadSource& readSource,
+    std::ifstream& fileStream,
+    const std::string& filePath,
+    int64_t offset,
+    int64_t len,
+    unsigned char* dst
+  ) noexcept;
+  std::shared_ptr<Sample> readSample(
+    std::ifstream& fileStream, const std::string& filePath, int64_t offset, int64_t len
+  ) noexcept;
+
   std::shared_ptr<Logger> logger;
   std::string sessionId;
   std::weak_ptr<Session> parentSessionPtr;
   std::weak_ptr<StreamHandler> streamHandlerPtr;
 
   // usage example
-  // std::ifstream& cam0FrontVFileStream = map.at(0).at(0);
+  // std::ifstream& cam0FrontVFileStream = map.at(toVideoFileKey(bitrateVariantIdx, 0)).at(0);
   std::unordered_map<int, std::vector<std::ifstream>> camIdVideoFileStreamMap;
   std::ifstream audioFileStream;
+
+  // file paths are used as keys of the block cache
+  std::unordered_map<int, std::vector<std::string>> camIdVideoFilePathMap;
+  int bitrateVariantIdx = C::ZERO; // 0 is the highest bitrate, or the content has no bitrate variant.
+  std::string audioFilePath = C::EMPTY_STRING;
+  BlockCache* blockCachePtr = nullptr;
+  TieredContentCache* tierCachePtr = nullptr;
+  std::string contentTitle = C::EMPTY_STRING;
+  std::string acquiredTierContentTitle = C::EMPTY_STRING; // released on close, since a reopen acquires again
+
+  // replaced on the strand under prewarmLock. the strand reads it without the lock.
+  std::shared_ptr<const ReadSource> readSourcePtr = std::make_shared<const ReadSource>();
+
+  // cam switching prewarm. the job has its own file streams, so it never shares one with the strand.
+  std::mutex prewarmLock;
+  std::vector<PrewarmSampleRange> pendingPrewarmRanges;
+  std::vector<PrewarmedSample> prewarmedSamples;
+  int64_t prewarmedByteSize = 0; // counted in the session's prewarmed bytes
+  bool isPrewarmRunning = false;
+  bool isFileStreamClosed = false; // by parking. a running prewarm job drops its result and files.
+  bool isPrewarmFilePathChanged = false; // by reopening. the prewarm job opens its files again.
+  std::unordered_map<int, std::vector<std::ifstream>> prewarmVideoFileStreamMap; // used by the prewarm job only
 };
 
 #endif //RTPHANDLER_H
@@ -4,6 +4,7 @@
 #include "../include/Logger.h"
 #include "../constants/C.h"
 #include "../include/Buffer.h"
+#include "../include/RtspRequestParser.h"
 
 class Session;
 class StreamHandler;
@@ -17,13 +18,47 @@ public:
   );
   ~RtspHandler();
 
-  void run(Buffer& inputBuffer);
-  void handleRtspRequest(
-    std::string reqStr, Buffer& inputBuffer
-  );
+  void run(const RtspRequest& request, Buffer& outputBuffer);
+  void handleRtspRequest(const RtspRequest& request, Buffer& outputBuffer);
+  // the content an OPTIONS request asks for. empty for other methods.
+  std::string findRequestedContent(const RtspRequest& request);
 
 private:
-  bool hasSessionId(const std::vector<std::string>& strings);
+  using MethodHandler = void (RtspHandler::*)(
+    const RtspRequest&, Buffer&, const std::shared_ptr<Session>&, const std::shared_ptr<StreamHandler>&
+  );
+  static MethodHandler findMethodHandler(std::string_view method);
+
+  void handleOptions(
+    const RtspRequest& request, Buffer& buffer,
+    const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& ptrForStreamHandler
+  );
+  void handleDescribe(
+    const RtspRequest& request, Buffer& buffer,
+    const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& ptrForStreamHandler
+  );
+  void handleSetup(
+    const RtspRequest& request, Buffer& buffer,
+    const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& ptrForStreamHandler
+  );
+  void handlePlay(
+    const RtspRequest& request, Buffer& buffer,
+    const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& ptrForStreamHandler
+  );
+  void handlePause(
+    const RtspRequest& request, Buffer& buffer,
+    const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& ptrForStreamHandler
+  );
+  void handleTeardown(
+    const RtspRequest& request, Buffer& buffer,
+    const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& ptrForStreamHandler
+  );
+  void handleSetParameter(
+    const RtspRequest& request, Buffer& buffer,
+    const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& ptrForStreamHandler
+  );
+
+  bool hasSessionId(const RtspRequest& request);
   void respondOptions(Buffer& buffer);
   void respondDescribe(Buffer& buffer, const std::string& mediaInfo);
   void respondSetup(
@@ -42,27 +77,28 @@ private:
   void respondError(Buffer& buffer, int error, const std::string& rtspMethod);
   void respondPause(Buffer& buffer);
 
-  std::string findUserName(const std::vector<std::string>& strings);
-  int findCSeq(const std::vector<std::string>& strings);
-  std::string findContents(const std::string& line0);
+  std::string findUserName(const RtspRequest& request);
+  int findCSeq(const RtspRequest& request);
+  std::string findContents(std::string_view url);
   std::string getMediaInfo(const std::string& fullCid);
-  int findTrackId(const std::string& line0);
-  std::string findTransport(const std::vector<std::string>& strings);
-  std::string findHybridMode(const std::vector<std::string>& strings);
-  std::string findNotTx(const std::vector<std::string>& strings);
-  std::vector<int> findChannels(const std::string& transport);
-  std::string findSessionId(const std::vector<std::string>& strings);
-  std::vector<float> findNormalPlayTime(const std::vector<std::string>& strings);
-  std::string findDeviceModelName(const std::vector<std::string>& strings);
-  std::string findManufacturer(const std::vector<std::string>& strings);
-  bool isLookingSampleControInUse(const std::vector<std::string>& strings);
-  int findLatestReceivedSampleIdx(const std::vector<std::string>& strings, const std::string& filter);
-  bool isSeekRequest(const std::vector<std::string>& strings);
+  int findTrackId(std::string_view url);
+  std::string_view findTransport(const RtspRequest& request);
+  std::string_view findHybridMode(const RtspRequest& request);
+  std::string_view findNotTx(const RtspRequest& request);
+  std::vector<int> findChannels(std::string_view transport);
+  std::string_view findSessionId(const RtspRequest& request);
+  std::vector<float> findNormalPlayTime(const RtspRequest& request);
+  std::string_view findDeviceModelName(const RtspRequest& request);
+  std::string_view findManufacturer(const RtspRequest& request);
+  bool isLookingSampleControInUse(const RtspRequest& request);
+  int findLatestReceivedSampleIdx(const RtspRequest& request, std::string_view filter);
+  bool isSeekRequest(const RtspRequest& request);
   bool isValidPlayTime(const std::vector<float>& ntpSec);
   std::string getContentsTitle(const std::vector<std::string>& urls);
   std::string getSupportingBitrateTypes(std::vector<int> bitrateTypes);
-  bool isContainingPlayInfoHeader(const std::vector<std::string>& strings);
-  bool isThereMonitoringInfoHeader(const std::vector<std::string>& strings);
+  bool isContainingPlayInfoHeader(const RtspRequest& request);
+  bool isThereMonitoringInfoHeader(const RtspRequest& request);
+  std::pair<std::string_view, std::string_view> findSetParameterInfo(const RtspRequest& request);
   void parseHybridVideoSampleMetaDataForDandS(const std::string& notTxIdListStr);
 
   std::shared_ptr<Logger> logger;
@@ -0,0 +1,39 @@
+#ifndef RTSPREQUESTPARSER_H
+#define RTSPREQUESTPARSER_H
+
+#include <array>
+#include <string_view>
+#include <utility>
+
+#include "../constants/C.h"
+
+enum class RtspParseResult { COMPLETE, INCOMPLETE, BAD_REQUEST };
+
+// One RTSP request. every field is a view into the receive buffer,
+// so it is valid only until the buffer is consumed.
+struct RtspRequest {
+    std::string_view method;
+    std::string_view url;
+    std::string_view version;
+    std::string_view body;
+    std::string_view raw; // request line, headers, and body
+    std::array<std::pair<std::string_view, std::string_view>, C::RTSP_MAX_HEADER_CNT> headers{};
+    size_t headerCnt = 0;
+    bool isValid = false;
+
+    // header names are case insensitive. empty if absent.
+    std::string_view getHeader(std::string_view name) const;
+    bool hasHeader(std::string_view name) const;
+};
+
+// Single pass, non allocating parser. Handles Content-Length bodies,
+// and pipelined requests by returning the length of the parsed one.
+class RtspRequestParser {
+public:
+    // parses one request at the front of the input.
+    // consumedLen : length to drop from the input. zero if INCOMPLETE.
+    // on BAD_REQUEST, consumedLen skips the broken request so that the next one can still be parsed.
+    static RtspParseResult parse(std::string_view input, RtspRequest& outRequest, size_t& consumedLen);
+};
+
+#endif //RTSPREQUESTPARSER_H
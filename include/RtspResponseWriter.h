@@ -0,0 +1,49 @@
+#ifndef RTSPRESPONSEWRITER_H
+#define RTSPRESPONSEWRITER_H
+
+#include <cstdint> // For int64_t
+#include <string_view>
+
+#include "../include/Buffer.h"
+
+// kept in Buffer::rtspResponseFlags, so the session does not scan the response text.
+enum class RtspResponseFlag : uint8_t {
+    TEARDOWN = 1 << 0,
+    ERROR = 1 << 1
+};
+
+// Writes an RTSP response in place into the buffer.
+// The buffer keeps its capacity between responses, so a session reuses one allocation for all of them.
+// e.g. RtspResponseWriter(buffer, C::OK, cSeq).header("Session", sessionId).header("Server", C::MY_NAME).finish();
+class RtspResponseWriter {
+public:
+    explicit RtspResponseWriter(Buffer& inputBuffer, int statusCode, int cSeq);
+    ~RtspResponseWriter() = default;
+
+    // rule of five. RtspResponseWriter is a short-lived view of one buffer.
+    RtspResponseWriter(const RtspResponseWriter&) = delete;
+    RtspResponseWriter& operator=(const RtspResponseWriter&) = delete;
+    RtspResponseWriter(RtspResponseWriter&&) noexcept = delete;
+    RtspResponseWriter& operator=(RtspResponseWriter&&) noexcept = delete;
+
+    RtspResponseWriter& header(std::string_view name, std::string_view value);
+    RtspResponseWriter& header(std::string_view name, int64_t value);
+
+    // for values made of several parts. beginHeader(), append()..., endHeader().
+    RtspResponseWriter& beginHeader(std::string_view name);
+    RtspResponseWriter& append(std::string_view str);
+    RtspResponseWriter& append(int64_t value);
+    RtspResponseWriter& endHeader();
+
+    RtspResponseWriter& setFlag(RtspResponseFlag flag);
+
+    // ends the header block. Content-Length of the body must be written as a header beforehand.
+    void finish(std::string_view body = {});
+
+    static bool hasFlag(const Buffer& buffer, RtspResponseFlag flag);
+
+private:
+    Buffer& buffer;
+};
+
+#endif //RTSPRESPONSEWRITER_H
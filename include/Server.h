@@ -5,12 +5,17 @@
 #include <boost/asio.hpp>
 #include <cstdint>
 #include <thread>
+#include <atomic>
+#include <vector>
 
+#include "../include/MediaClock.h"
 #include "../include/PeriodicTask.h"
 #include "../include/SntpRefTimeProvider.h"
 #include "../include/ContentsStorage.h"
 #include "../include/Session.h"
 #include "../include/Logger.h"
+#include "../include/ServerShard.h"
+#include "../include/SessionRegistry.h"
 
 // forward declaration of Session
 class Session;
@@ -30,9 +35,22 @@ public:
   );
   ~Server();
 
+  // blocking. returns right away in the shard mode, since the shards accept on their own io_contexts.
   void start();
 
-  std::unordered_map<std::string, std::shared_ptr<Session>>& getSessions();
+  // makes a session with all of its handlers and starts it.
+  std::shared_ptr<Session> createSession(
+    boost::asio::io_context& sessionIoContext,
+    std::shared_ptr<boost::asio::io_context> workerIoContextPtr,
+    std::shared_ptr<boost::asio::ip::tcp::socket> socketPtr
+  );
+
+  SessionRegistry& getSessionRegistry();
+  // live sessions of every shard too.
+  std::vector<std::shared_ptr<Session>> getSessionsSnapshot() const;
+  // summed over every shard too.
+  SessionRegistryStats getSessionRegistryStats() const;
+  const std::vector<std::unique_ptr<MediaClock>>& getMediaClocks() const;
   ContentsStorage& getContentsStorage();
   std::string getProjectRootPath();
 
@@ -41,22 +59,30 @@ public:
 
 private:
   std::string getSessionId();
+  bool startShards();
+  void runAcceptLoop();
   std::shared_ptr<boost::asio::io_context> getNextWorkerIoContextPtr();
+  MediaClock& getMediaClock(const std::shared_ptr<boost::asio::io_context>& workerIoContextPtr);
   long ioContextIdx{C::INVALID};
 
   std::shared_ptr<Logger> logger;
   boost::asio::io_context& io_context;
   std::vector<std::shared_ptr<boost::asio::io_context>>& ioContextPool;
+  // one media tick timer per worker io_context. same index as ioContextPool.
+  std::vector<std::unique_ptr<MediaClock>> mediaClocks;
   std::string projectRootPath;
   // used shared_ptr for better ownership management
-  std::unordered_map<std::string, std::shared_ptr<Session>> sessions;
+  SessionRegistry sessionRegistry;
   ContentsStorage& contentsStorage;
   std::string storage;
   SntpRefTimeProvider& sntpTimeProvider;
-  int connectionCnt;
+  std::atomic<int> connectionCnt;
 
-  std::unordered_map<std::string, std::shared_ptr<Session>> shutdownSessions;
   PeriodicTask removeClosedSessionTask;
+
+  // only in the shard mode. sessionRegistry above stays empty then.
+  std::vector<std::shared_ptr<ServerShard>> shards;
+  std::chrono::milliseconds removeClosedSessionIntervalMs;
 };
 
 #endif // SERVER_H
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef SERVERSHARD_H
+#define SERVERSHARD_H
+
+#include <boost/asio.hpp>
+#include <cstdint> // For int64_t
+#include <memory>
+#include <string>
+
+#include "../include/Logger.h"
+#include "../include/PeriodicTask.h"
+#include "../include/SessionRegistry.h"
+
+class Server;
+class Session;
+
+// One core of the server in the shared nothing mode.
+// Has its own SO_REUSEPORT acceptor, io_context, session table and timers.
+// A session accepted by a shard lives on that shard's io_context only.
+// Owned by shared_ptr. queued accept work holds the shard, so dropping it never leaves a dangling handler.
+class ServerShard : public std::enable_shared_from_this<ServerShard> {
+public:
+  explicit ServerShard(
+    int inputShardIdx,
+    Server& inputServer,
+    std::shared_ptr<boost::asio::io_context> inputIoContextPtr,
+    std::chrono::milliseconds inputIntervalMs
+  );
+  ~ServerShard();
+
+  // rule of five. ServerShard is not allowed to copy or move.
+  ServerShard(const ServerShard&) = delete;
+  ServerShard& operator=(const ServerShard&) = delete;
+  ServerShard(ServerShard&&) noexcept = delete;
+  ServerShard& operator=(ServerShard&&) noexcept = delete;
+
+  bool start();
+  void stop();
+
+  // may be called from any thread. false if the session is not in this shard.
+  bool retireSession(const std::string& sessionId);
+
+  const SessionRegistry& getSessionRegistry() const;
+
+private:
+  void asyncAccept();
+
+  std::shared_ptr<Logger> logger;
+  const int shardIdx;
+  Server& server;
+  std::shared_ptr<boost::asio::io_context> ioContextPtr;
+  boost::asio::ip::tcp::acceptor acceptor;
+
+  SessionRegistry sessionRegistry;
+  PeriodicTask removeClosedSessionTask;
+};
+
+#endif //SERVERSHARD_H
@@ -2,10 +2,13 @@
 #define SESSION_H
 #include <boost/asio.hpp>
 #include <boost/lockfree/queue.hpp>
+#include <array>
 #include <atomic>
+#include <condition_variable>
 #include <cstdint> // For int64_t
 #include <unordered_map>
 #include <queue>
+#include <deque>
 #include <mutex>
 
 #include "../include/Logger.h"
@@ -18,7 +21,10 @@
 #include "../include/RtspHandler.h"
 #include "../include/RtpHandler.h"
 #include "../include/RxBitrate.h"
+#include "../include/AbrController.h"
 #include "../include/PeriodicTask.h"
+#include "../include/MediaClock.h"
+#include "../include/LatencyHistogram.h"
 
 // forward declaration of Server, ContentsStorage, and SntpRefTimeProvider
 // to prevent circular referencing
@@ -56,6 +62,29 @@ struct RtpPacketInfo {
   size_t offset;
   size_t length;
   bool isHybridMeta;
+  int sampleNo; // read again on resume if the session is parked before this packet was sent
+  int64_t enqueueTimeNs; // set by enqueueRtpInfo(). for the queue dwell time.
+  int64_t deadlineNs; // intended send time of the video frame. set by enqueueRtpInfo().
+  uint32_t deadlineEpoch; // frames of an older epoch, e.g. queued before a pause, are not timed.
+};
+
+// counters of one session for monitoring. read from any thread, without the strand.
+struct SessionMetrics {
+  int64_t txBitrateBps = 0; // of the last sampling period
+  int64_t queuedRtpCnt = 0;
+  int64_t allocatedBytesForSample = 0;
+  int64_t prewarmedBytes = 0; // sibling cam samples kept for cam switching. not in allocatedBytesForSample.
+  uint64_t sentRtpCnt = 0;
+  uint64_t readVideoSampleCnt = 0;
+  uint64_t readAudioSampleCnt = 0;
+  uint64_t lateSampleCnt = 0; // reading ticks put off, since the client buffer was full
+  uint64_t droppedRtpCnt = 0; // discarded from the tx queue without being sent
+  uint64_t deliveredFrameCnt = 0; // video frames whose last packet was written, against a deadline
+  uint64_t onTimeFrameCnt = 0; // within C::FRAME_ON_TIME_THRESHOLD_US after the deadline
+  int64_t frameLatenessP99Us = 0;
+  int64_t frameLatenessMaxUs = 0;
+  bool isPaused = false;
+  bool isParked = false;
 };
 
 // dongvin : for hybrid streaming
@@ -75,6 +104,7 @@ class Session : public std::enable_shared_from_this<Session> {
   explicit Session(
     boost::asio::io_context& inputIoContext,
     std::shared_ptr<boost::asio::io_context> inputWorkerIoContextPtr,
+    MediaClock& inputMediaClock,
     std::shared_ptr<boost::asio::ip::tcp::socket> inputSocketPtr,
     std::string inputSessionId,
     Server& inputServer,
@@ -111,6 +141,14 @@ class Session : public std::enable_shared_from_this<Session> {
   bool getPauseStatus();
   void updatePauseStatus(bool inputPausedStatus);
 
+  // parking. called on the strand.
+  bool getParkStatus();
+  // true if the reading tracks were released by parking, and the next PLAY must start them again.
+  bool getPlayRestartStatus();
+  // reopens the files and restarts the timers of a parked session. no-op if it is not parked.
+  // C::OK, or the rtsp status to respond with. C::NOT_FOUND if the content was replaced or removed while parked.
+  [[nodiscard]] int unpark();
+
   std::string getContentTitle();
   void updateContentTitleOfCurSession(std::string inputContentTitle);
 
@@ -140,7 +178,7 @@ class Session : public std::enable_shared_from_this<Session> {
   void shutdownSession();
 
   // for rtsp messages
-  void handleRtspRequest(Buffer& buf);
+  void handleRtspRequest(const RtspRequest& request, Buffer& buf);
   bool onCid(std::string inputCid);
   void onChannel(int trackId, std::vector<int> channels);
   void onUserRequestingPlayTime(std::vector<float> playTimeSec);
@@ -148,8 +186,12 @@ class Session : public std::enable_shared_from_this<Session> {
   void onCameraChange(int nextCam, int nextId, std::vector<int64_t> switchingTimeInfo);
 
   // play and teardown
+  // sample reading starts right after the PLAY response in the buffer was written.
+  // delayMs is used only if fast start is off.
+  void schedulePlayStart(Buffer& playResponseBuffer, int delayMs);
   void onPlayStart();
   void startPlayForCamSwitching();
+  void scheduleTeardown();
   void onTeardown();
   void recordBitrateTestResult();
 
@@ -166,23 +208,57 @@ class Session : public std::enable_shared_from_this<Session> {
   void updateReadLastVideoSample();
   void updateReadLastAudioSample();
   bool isNewSampleAllocatable();
+  // prewarmed samples of the sibling cams. negative to release. monitoring only, since they are not
+  // part of the playing stream. counted in allocated bytes, they would throttle the reading and fool ABR.
+  void addPrewarmedBytes(int64_t byteDelta);
 
   // client aliveness check
   void updateOptionsReqTimeMillis(int64_t inputOptionsReqTimeMillis);
 
+  // monitoring
+  SessionMetrics getMetrics() const;
+  void countReadSample(int mediaType);
+
   private:
   void deleteDanglingRtps();
+  // reads samples of up to C::FAST_START_BUFFER_TARGET_MS ahead of the real time. called on the strand.
+  void readFastStartBurst(int64_t videoIntervalUs, int64_t audioIntervalUs);
+  void recordTimeToFirstFrame();
+  // frame n is due at the anchor + (n - anchor sample + 1) * unit time, like the reading ticks. called on the strand.
+  void anchorFrameDeadlines(int64_t videoIntervalUs);
+  // a tick with no sample read, since the client buffer was full. the later frames are due one tick later.
+  void slipFrameDeadlines();
+  // called by the tx thread only. a frame is done once a packet of another frame is written.
+  void trackFrameDelivery(const RtpPacketInfo& rtpPacketInfo, int64_t writeEndTimeNs);
+  void finishFrameDelivery();
+  // picks the bitrate variant from the congestion of the last sampling period. called on the strand.
+  void adaptBitrate(int64_t sentBitsInPeriod);
   void stopAllPeriodicTasks();
   void closeSocket();
 
-  void transmitRtspRes(std::unique_ptr<Buffer> bufPtr);
+  void schedulePark();
+  // asks the tx thread to let go of the rtp queue. finishPark() runs on the strand once it holds no packet.
+  void park();
+  void finishPark(uint64_t requestId);
+  // a parked session has no bitrate task. the client connection is checked by the timer wheel instead.
+  void scheduleParkedLivenessCheck();
+  void checkParkedLiveness();
+
+  void enqueueRtspRes(Buffer& buf);
+  void transmitRtspRes();
   void transmitRtp();
+  // the tx thread sleeps while there is nothing to send. producers wake it up.
+  void waitForTxWork();
+  void wakeTxThread();
 
   void asyncReceive();
+  // handles every complete request in rtspBuffer, then receives again.
+  void processRtspBuffer();
 
   std::shared_ptr<Logger> logger;
   boost::asio::io_context& io_context;
   std::shared_ptr<boost::asio::io_context> workerIoContextPtr;
+  MediaClock& mediaClock;
   std::shared_ptr<boost::asio::ip::tcp::socket> socketPtr;
   std::string sessionId;
   Server& parentServer;
@@ -206,6 +282,23 @@ class Session : public std::enable_shared_from_this<Session> {
 
   // for rtsp msg rx/tx
   std::string rtspBuffer;
+  // reused for every response.
+  Buffer rtspResponseBuffer{std::vector<unsigned char>{}, 0, 0};
+
+  // priority lane of the rtp tx thread, which is the only writer of the socket.
+  // responses are written between two rtp packets, so they never interleave and never wait behind queued rtp.
+  std::mutex rtspTxLock;
+  struct RtspTxItem {
+    std::vector<unsigned char> response;
+    std::function<void()> afterTx;
+  };
+  std::deque<RtspTxItem> rtspTxLane;
+  std::vector<std::vector<unsigned char>> rtspTxFreeBufs; // sent responses. reused to keep the capacity.
+  std::atomic<int> pendingRtspResCnt = C::ZERO;
+
+  std::mutex txWakeLock;
+  std::condition_variable txWakeCv;
+  std::atomic<bool> isTxThreadWaiting = false;
 
   // tx queue for rtp.
   std::unique_ptr<boost::lockfree::queue<RtpPacketInfo*>> rtpQueuePtr;
@@ -223,24 +316,70 @@ class Session : public std::enable_shared_from_this<Session> {
   std::string manufacturer = C::EMPTY_STRING;
 
   std::atomic<bool> isPaused = false;
+  // parked : no file, queued sample, or periodic task. the read position in StreamHandler is the resume record.
+  std::atomic<bool> isParked = false;
+  bool needPlayRestart = false;
+  bool needReopenFileStreams = false;
+  uint64_t parkedContentRevision = 0;
+  // a pause or a resume makes a new id. the tx thread acknowledges the latest one between two packets.
+  std::atomic<uint64_t> parkRequestId = 0;
+  uint64_t txAckedParkRequestId = 0; // used by the tx thread only.
+  std::atomic<uint64_t> parkTimerId = 0; // TimerWheel::INVALID_TIMER_ID
+  std::atomic<uint64_t> parkedLivenessTimerId = 0;
   std::string contentTitle = C::EMPTY_STRING;
   int64_t playTimeMillis = C::INVALID_OFFSET;
 
   int kbpsCurrentBitrate = C::ZERO;
   std::unordered_map<int64_t, int32_t> utcTimeSecBitSizeMap;
-  std::atomic<int> sentBitsSize = C::ZERO;
+  // written by the tx thread only, with no read-modify-write. the bitrate task takes the delta.
+  std::atomic<uint64_t> sentBitsTotal = 0;
+  uint64_t lastSentBitsTotal = 0; // used on the strand only.
 
   std::vector<RxBitrate> rxBitrateRecord{};
   std::vector<int> mbpsPossibleTypeList{};
+  AbrController abrController;
+  // last video sample of the fast start burst until the tx thread writes it. the burst backlog is not congestion.
+  std::atomic<int> fastStartBurstEndSampleNo = C::INVALID;
   HybridMetaMapType hybridMeta;
 
   PeriodicTask bitrateRecodeTask;
-  std::vector<std::shared_ptr<PeriodicTask>> videoReadingTaskVec;
-  std::vector<std::shared_ptr<PeriodicTask>> audioReadingTaskVec;
+  // sample reading tracks on the media clock of the worker.
+  std::atomic<MediaClock::TrackId> videoReadingTrackId = MediaClock::INVALID_TRACK_ID;
+  std::atomic<MediaClock::TrackId> audioReadingTrackId = MediaClock::INVALID_TRACK_ID;
 
   bool isToreDown = false;
+  std::atomic<bool> isTeardownScheduled = false;
+  std::atomic<uint64_t> teardownTimerId = 0; // TimerWheel::INVALID_TIMER_ID
   bool isRecordSaved = false;
   std::atomic<int64_t> allocatedBytesForSample = 0;
+  std::atomic<int64_t> prewarmedBytes = 0;
+
+  // monitoring. relaxed, since each one is read on its own.
+  std::atomic<int64_t> txBitrateBps = 0;
+  std::atomic<int64_t> queuedRtpCnt = 0;
+  std::atomic<uint64_t> sentRtpCnt = 0; // written by the tx thread only.
+  std::array<std::atomic<uint64_t>, 2> readSampleCnts{}; // video, audio
+  std::atomic<uint64_t> lateSampleCnt = 0;
+  std::atomic<uint64_t> droppedRtpCnt = 0;
+
+  // time to first frame. from the PLAY request to the first video rtp written to the socket.
+  std::atomic<int64_t> playRequestTimeNs = C::INVALID_OFFSET;
+  std::atomic<int64_t> initialTimeToFirstFrameUs = C::INVALID_OFFSET;
+
+  // frame delivery deadlines. the anchor is used on the strand only.
+  int64_t frameDeadlineAnchorNs = C::INVALID_OFFSET;
+  int frameDeadlineAnchorSampleNo = C::INVALID;
+  int64_t videoFrameIntervalUs = C::INVALID_OFFSET;
+  std::atomic<uint32_t> frameDeadlineEpoch = 0;
+  // the frame being written. used by the tx thread only.
+  int txFrameSampleNo = C::INVALID;
+  int64_t txFrameDeadlineNs = C::INVALID_OFFSET;
+  uint32_t txFrameDeadlineEpoch = 0;
+  int64_t txFrameWriteEndTimeNs = C::INVALID_OFFSET;
+  // written by the tx thread only, so one shard is enough.
+  LatencyHistogram frameLatenessHistogram{1};
+  std::atomic<uint64_t> deliveredFrameCnt = 0;
+  std::atomic<uint64_t> onTimeFrameCnt = 0;
 };
 
 #endif //SESSION_H
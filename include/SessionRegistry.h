@@ -0,0 +1,73 @@
+#ifndef SESSIONREGISTRY_H
+#define SESSIONREGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint> // For int64_t
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../constants/C.h"
+
+class Session;
+
+// counters only. read without any lock.
+struct SessionRegistryStats {
+  int64_t liveSessionCnt = 0;
+  int64_t retiredSessionCnt = 0; // shut down, waiting for the removal task.
+  int64_t totalAddedCnt = 0;
+  int64_t totalRetiredCnt = 0;
+};
+
+// Live and retired sessions, split into buckets by session id.
+// Each bucket has its own lock, so the accept loop, teardown threads
+// and the removal task rarely wait for each other.
+class SessionRegistry {
+public:
+  explicit SessionRegistry() = default;
+  ~SessionRegistry() = default;
+
+  // rule of five. SessionRegistry is not allowed to copy or move.
+  SessionRegistry(const SessionRegistry&) = delete;
+  SessionRegistry& operator=(const SessionRegistry&) = delete;
+  SessionRegistry(SessionRegistry&&) noexcept = delete;
+  SessionRegistry& operator=(SessionRegistry&&) noexcept = delete;
+
+  void add(const std::string& sessionId, std::shared_ptr<Session> sessionPtr);
+  std::shared_ptr<Session> find(const std::string& sessionId) const;
+
+  // moves a live session to the retired ones. false if not found.
+  // retired sessions are kept alive until clearRetired(), since a teardown runs on the session's own threads.
+  bool retire(const std::string& sessionId);
+  size_t clearRetired();
+
+  // live sessions at one point in time. every bucket is locked in the same order while copying.
+  std::vector<std::shared_ptr<Session>> snapshot() const;
+  SessionRegistryStats getStats() const;
+  int64_t getLiveSessionCnt() const;
+
+  // live and retired.
+  void clear();
+
+private:
+  struct Bucket {
+    mutable std::mutex lock;
+    std::unordered_map<std::string, std::shared_ptr<Session>> liveSessions;
+    std::unordered_map<std::string, std::shared_ptr<Session>> retiredSessions;
+  };
+
+  Bucket& getBucket(const std::string& sessionId);
+  const Bucket& getBucket(const std::string& sessionId) const;
+
+  std::array<Bucket, C::SESSION_REGISTRY_BUCKET_CNT> buckets;
+
+  std::atomic<int64_t> liveSessionCnt = 0;
+  std::atomic<int64_t> retiredSessionCnt = 0;
+  std::atomic<int64_t> totalAddedCnt = 0;
+  std::atomic<int64_t> totalRetiredCnt = 0;
+};
+
+#endif //SESSIONREGISTRY_H
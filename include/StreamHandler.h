@@ -26,23 +26,26 @@ public:
 
   void updateRtpRemoteCnt(int cnt);
   void updateCurSampleNo(int mediaType, int idx);
+  // the next sample to read. C::INVALID if the stream is not set up.
+  int getCurSampleNo(int mediaType);
   int getCamId();
   void shutdown();
 
   void setChannel(int streamId, std::vector<int> ch);
   void initUserRequestingPlaytime(std::vector<float> timeS);
   [[nodiscard]] bool setRtpInfo(RtpInfo inputRtpInfo);
-  bool setReaderAndContentTitle(ContentFileMeta& inputReader, std::string contentTitle);
+  bool setReaderAndContentTitle(std::shared_ptr<ContentFileMeta> inputReaderPtr, std::string contentTitle);
+  std::shared_ptr<ContentFileMeta> getContentFileMetaPtr() const;
   int getLastVideoSampleNumber();
   int getLastAudioSampleNumber();
-  std::vector<unsigned char> getAccData();
-  std::vector<std::vector<unsigned char>> getAllV0Images();
+  std::shared_ptr<const std::vector<unsigned char>> getAccData();
+  std::shared_ptr<const std::vector<std::vector<unsigned char>>> getAllV0Images();
   bool setVideoAudioSampleMetaDataCache(const std::string& contentTitle);
   void getNextVideoSample();
   void getNextAudioSample();
   bool isDone(int streamId);
   int64_t getUnitFrameTimeUs(int streamId);
-  std::string getMediaInfo();
+  std::shared_ptr<const PreRenderedSdp> getPreRenderedSdp();
   std::vector<int64_t> getSsrc();
   int getMainVideoNumber();
   int getMaxCamNumber();
@@ -58,6 +61,13 @@ public:
   std::vector<int64_t> getGop();
   void setCamId(int camId);
   void findNextSampleForSwitching(int vid, std::vector<int64_t> timeInfo);
+  // index of the content's mbps type list. applied on the next key frame, so that the client can decode it.
+  void requestBitrateVariant(int variantIdx);
+  int getBitrateVariantIdx() const;
+  // the one waiting for a key frame. same as getBitrateVariantIdx() if no switch is pending.
+  int getPendingBitrateVariantIdx() const;
+  // the block cache window and prewarmed samples were dropped by parking. reported again on the next read.
+  void resetReadAheadWindows();
 
 private:
   std::unique_ptr<Buffer> get1stRtpOfRefSample(int streamId, int sampleNo);
@@ -72,12 +82,22 @@ private:
   int64_t getSamplePresentationTimeUs(int streamId, int sampleTimeIndex);
   int getSampleTimeIndex(int streamId, int64_t timestamp);
   int64_t getTimestamp(int sampleNo);
+  const std::vector<VideoSampleInfo>* getFrontVSampleMetaListPtr(int inputCamId) const;
+  const std::vector<VideoSampleInfo>* getRearVSampleMetaListPtr(int inputCamId) const;
+  void cacheVideoSampleMetaLists(int variantIdx);
+  int getVariantMbps(int variantIdx) const;
+  void switchBitrateVariantOnKeyFrame(RtpHandler& rtpHandler, int sampleNo);
+  void updateVideoPlaybackWindow(RtpHandler& rtpHandler, int sampleNo);
+  void updateAudioPlaybackWindow(RtpHandler& rtpHandler, int sampleNo);
+  void requestCamSwitchPrewarm(RtpHandler& rtpHandler, int sampleNo);
 
   std::shared_ptr<Logger> logger;
   std::string sessionId;
   std::weak_ptr<Session> parentSessionPtr;
   ContentsStorage& contentsStorage;
   std::string contentTitle = C::EMPTY_STRING;
+  // held until the session ends. cold content eviction never drops the meta in use.
+  std::shared_ptr<ContentFileMeta> contentFileMetaPtr = nullptr;
 
   // cam 0 meta cache
   const std::vector<VideoSampleInfo>* cachedCam0frontVSampleMetaListPtr = nullptr;
@@ -97,8 +117,21 @@ private:
   std::unordered_map<int, ReadInfo> sInfo{};
   RtpInfo rtpInfo;
   int camId = C::ZERO;
+  // bitrate variant of the cached video meta. 0 is the highest bitrate.
+  int bitrateVariantIdx = C::ZERO;
+  int pendingBitrateVariantIdx = C::ZERO;
 
   int videoRtpRemoveCnt = C::ZERO;
+
+  // sample ranges reported to the block cache
+  int videoWindowCamId = C::INVALID;
+  int videoWindowBeginSampleNo = C::INVALID;
+  int videoWindowEndSampleNo = C::INVALID;
+  int audioWindowBeginSampleNo = C::INVALID;
+
+  // gop of sibling cams which was last requested to prewarm
+  int prewarmCamId = C::INVALID;
+  int prewarmGopStartSampleNo = C::INVALID;
 };
 
 #endif //STREAMHANDLER_H
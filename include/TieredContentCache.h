@@ -0,0 +1,97 @@
+#ifndef TIEREDCONTENTCACHE_H
+#define TIEREDCONTENTCACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint> // For int64_t
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "../include/Logger.h"
+
+// Local SSD tier in front of the slow(network file system) content root.
+// Content directories are copied to the fast root in background on first access or on promotion,
+// and sessions opened after the copy is done read from the fast copy.
+// Copies are evicted by disk quota. less popular and not in use contents go first.
+class TieredContentCache {
+public:
+  explicit TieredContentCache(
+    std::string inputSlowRootPath,
+    std::string inputFastRootPath,
+    int64_t inputQuotaBytes
+  );
+  ~TieredContentCache();
+
+  // rule of five. TieredContentCache is not allowed to copy or move.
+  TieredContentCache(const TieredContentCache&) = delete;
+  TieredContentCache& operator=(const TieredContentCache&) = delete;
+  TieredContentCache(TieredContentCache&&) noexcept = delete;
+  TieredContentCache& operator=(TieredContentCache&&) noexcept = delete;
+
+  void init();
+  void shutdown();
+
+  // returns the content directory path to read from. must be paired with releaseContentPath().
+  std::string acquireContentPath(const std::string& contentTitle);
+  void releaseContentPath(const std::string& contentTitle);
+
+  // schedules background copy to the fast tier without waiting for the access.
+  void promote(const std::string& contentTitle);
+
+  // drops the local copy of the changed content. sessions opened on the old copy keep reading it,
+  // so the copy is removed when the last session releases the content.
+  void invalidate(const std::string& contentTitle);
+  std::string getFastContentPath(const std::string& contentTitle) const;
+
+  std::string getStats();
+
+private:
+  enum class TierState { SLOW_ONLY, COPYING, FAST };
+
+  struct TierEntry {
+    TierState state = TierState::SLOW_ONLY;
+    int64_t byteSize = 0;
+    int64_t accessCnt = 0;
+    int64_t lastAccessTimeMillis = 0;
+    int inUseCnt = 0;
+    bool isStale = false; // changed while copying
+    bool isRemovalPending = false; // stale copy still in use. not copied again until it is removed.
+    int failedCopyCnt = 0; // in a row. reset by a copy or a change of the content.
+    int64_t nextCopyTimeMillis = 0; // not copied again before this after a failure.
+  };
+
+  // slow only, not being removed and not backing off after a failed copy.
+  static bool isCopyable(const TierEntry& entry);
+
+  void runCopyWorker();
+  bool copyContent(const std::string& contentTitle);
+  bool makeRoomFor(const std::string& contentTitle, int64_t requiredBytes);
+  int64_t getDirectoryByteSize(const std::filesystem::path& dir) const;
+  void enqueueCopy(const std::string& contentTitle);
+  void removeStaleCopy(const std::string& contentTitle);
+
+  std::shared_ptr<Logger> logger;
+  const std::filesystem::path slowRootPath;
+  const std::filesystem::path fastRootPath;
+  const int64_t quotaBytes;
+
+  std::mutex lock;
+  std::condition_variable copyCondition;
+  std::unordered_map<std::string, TierEntry> entries;
+  std::deque<std::string> copyQueue;
+  int64_t usedBytes = 0;
+
+  std::atomic<bool> isStopped = false;
+  std::thread copyWorker;
+
+  std::atomic<int64_t> fastReadCnt = 0;
+  std::atomic<int64_t> slowReadCnt = 0;
+  std::atomic<int64_t> evictedCnt = 0;
+};
+
+#endif //TIEREDCONTENTCACHE_H
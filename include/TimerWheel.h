@@ -0,0 +1,64 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <condition_variable>
+#include <cstdint> // For int64_t
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/Logger.h"
+
+// Hashed timer wheel for delayed one-shot tasks, shared by the whole process.
+// Scheduling and cancelling are O(1) and never create a thread.
+// Every task runs on the single wheel thread, so a task must not block for long.
+class TimerWheel {
+public:
+    using TimerId = uint64_t;
+    static constexpr TimerId INVALID_TIMER_ID = 0;
+
+    static TimerWheel& getShared();
+
+    explicit TimerWheel(int64_t inputTickMs, size_t inputSlotCnt);
+    ~TimerWheel();
+
+    // rule of five. TimerWheel is not allowed to copy or move.
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    TimerWheel(TimerWheel&&) noexcept = delete;
+    TimerWheel& operator=(TimerWheel&&) noexcept = delete;
+
+    TimerId schedule(int64_t delayMs, std::function<void()> task);
+    // false if the task already ran, is running, or was cancelled.
+    bool cancel(TimerId timerId);
+    void stop();
+
+private:
+    struct Entry {
+        TimerId timerId;
+        int64_t deadlineMs;
+        std::function<void()> task;
+    };
+
+    void run();
+    static int64_t getSteadyTimeMillis();
+
+    std::shared_ptr<Logger> logger;
+    const int64_t tickMs;
+    std::vector<std::list<Entry>> slots;
+    // for O(1) cancel.
+    std::unordered_map<TimerId, std::pair<size_t, std::list<Entry>::iterator>> entryIndex;
+
+    std::mutex lock;
+    std::condition_variable wakeUp;
+    TimerId lastTimerId = INVALID_TIMER_ID;
+    int64_t startTimeMs;
+    int64_t processedTick = 0;
+    bool isStopped = false;
+    std::thread wheelThread;
+};
+
+#endif //TIMERWHEEL_H
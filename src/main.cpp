@@ -5,16 +5,21 @@
 #include <vector>
 #include <thread>
 #include <future> // for std::promise and std::future
+#include <atomic>
+#include <cerrno>
 #include <filesystem>
+#include <sstream>
 
 // to find absolute path of project root dir
 #ifdef _WIN32
     #include <windows.h>
 #elif __APPLE__
     #include <libproc.h>
+    #include <poll.h>
     #include <unistd.h>
 #elif __linux__
     #include <pthread.h>
+    #include <poll.h>
     #include <unistd.h>
 #endif
 
@@ -24,6 +29,7 @@
 #include "../include/ContentFileMeta.h"
 #include "../include/Session.h"
 #include "../include/Server.h"
+#include "../include/MetricsHttpServer.h"
 
 // Version History
 // VER          Date            Changes
@@ -79,6 +85,84 @@ std::string getContentsRootPath() {
 #endif
 }
 
+std::string getLocalTierCacheRootPath() {
+#ifdef __linux__
+    if (std::getenv("WSL_DISTRO_NAME")) {
+        return "/tmp/streaming-contents-cache";
+    } else {
+        return "/mnt/local-ssd/streaming-contents-cache"; // instance store SSD of AWS EC2.
+    }
+#elif _WIN32
+    return "C:\\dev\\streaming-contents-cache";
+#elif __APPLE__
+    return "/tmp/streaming-contents-cache";
+#else
+    throw std::runtime_error("Unsupported platform");
+#endif
+}
+
+// reads one line of the standard input without blocking for long, so that the console thread can be stopped.
+// false if stdin is closed, or the stop is requested. pendingInput keeps the bytes after the line.
+bool readConsoleLine(std::string& line, std::string& pendingInput, const std::atomic<bool>& isStopRequested) {
+    while (!isStopRequested) {
+#ifdef _WIN32
+        // signaled by any console event. getline may still wait for the rest of a typed line.
+        const HANDLE stdinHandle = GetStdHandle(STD_INPUT_HANDLE);
+        if (WaitForSingleObject(stdinHandle, C::CONSOLE_INPUT_POLL_INTERVAL_MS) != WAIT_OBJECT_0) continue;
+        return static_cast<bool>(std::getline(std::cin, line));
+#else
+        // read from the fd, not std::cin. lines buffered in std::cin would not wake up poll().
+        if (const size_t lineEnd = pendingInput.find('\n'); lineEnd != std::string::npos) {
+            line = pendingInput.substr(0, lineEnd);
+            pendingInput.erase(0, lineEnd + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            return true;
+        }
+        pollfd stdinPollFd{STDIN_FILENO, POLLIN, 0};
+        if (::poll(&stdinPollFd, 1, C::CONSOLE_INPUT_POLL_INTERVAL_MS) <= 0) continue;
+
+        char readBuf[256];
+        const ssize_t readCnt = ::read(STDIN_FILENO, readBuf, sizeof(readBuf));
+        if (readCnt < 0 && errno == EINTR) continue;
+        if (readCnt <= 0) {
+            // EOF. the last line may have no line break.
+            line = std::move(pendingInput);
+            pendingInput.clear();
+            return !line.empty();
+        }
+        pendingInput.append(readBuf, static_cast<size_t>(readCnt));
+#endif
+    }
+    return false;
+}
+
+// runtime commands from the standard input. ex) pin <title>, unpin <title>, pinned
+// returns when stdin is closed, or soon after isStopRequested is set.
+void runConsoleCommandLoop(
+    ContentsStorage& contentsStorage, const std::shared_ptr<Logger>& logger, const std::atomic<bool>& isStopRequested
+) {
+    std::string line;
+    std::string pendingInput;
+    while (readConsoleLine(line, pendingInput, isStopRequested)) {
+        std::istringstream lineStream(line);
+        std::string command;
+        std::string contentTitle;
+        lineStream >> command >> contentTitle;
+
+        if (command == C::PIN_COMMAND && !contentTitle.empty()) {
+            contentsStorage.pinContent(contentTitle);
+        } else if (command == C::UNPIN_COMMAND && !contentTitle.empty()) {
+            contentsStorage.unpinContent(contentTitle);
+        } else if (command == C::PINNED_LIST_COMMAND) {
+            std::string titles = ">> ";
+            for (const std::string& title : contentsStorage.getPinnedContentTitles()) titles += title + ", ";
+            logger->warning("Pinned contents: " + titles);
+        } else if (!command.empty()) {
+            logger->warning("Dongvin, unknown command : " + line + ". usage : pin <title>, unpin <title>, pinned");
+        }
+    }
+}
+
 int main() {
     std::shared_ptr<Logger> logger = Logger::getLogger(C::MAIN);
     logger->warning("=================================================================");
@@ -100,6 +184,8 @@ int main() {
     }
 
     // make threads pool for worker io_context pool
+    // in the shard mode, each io_context is one shard with one thread pinned to its own core.
+    const int threadCntPerWorkerIoContext = C::USE_REUSEPORT_SHARDS ? 1 : C::THREAD_CNT_PER_WORKER_IO_CONTEXT;
     std::vector<std::shared_ptr<boost::asio::io_context>> ioContextPool;
     std::vector<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> workGuardVec;
     for (int i = 0; i < cpuCoreCnt; ++i) {
@@ -110,9 +196,10 @@ int main() {
         workGuardVec.emplace_back(boost::asio::make_work_guard(*workerIoContextPtr));
 
         // create worker threads for this io_context
-        for (int j = 0; j < C::THREAD_CNT_PER_WORKER_IO_CONTEXT; ++j) {
-            threadVec.emplace_back([workerIoContextPtr]() {
+        for (int j = 0; j < threadCntPerWorkerIoContext; ++j) {
+            threadVec.emplace_back([workerIoContextPtr, i]() {
                 Util::set_thread_priority();
+                if (C::USE_REUSEPORT_SHARDS) Util::set_thread_affinity(i);
                 workerIoContextPtr->run();
             });
         }
@@ -120,7 +207,7 @@ int main() {
 
     logger->warning(
         "Made io_cotext.run() worker thread pool with thread cnt: "
-        + std::to_string(cpuCoreCnt + (cpuCoreCnt*C::THREAD_CNT_PER_WORKER_IO_CONTEXT))
+        + std::to_string(cpuCoreCnt + (cpuCoreCnt*threadCntPerWorkerIoContext))
     );
 
     // used std::promise to synchronize the shutdown process
@@ -164,6 +251,15 @@ int main() {
 
     ContentsStorage contentsStorage(contentsRootPath);
     contentsStorage.init();
+    if (C::USE_LOCAL_TIER_CACHE) {
+        contentsStorage.initTierCache(getLocalTierCacheRootPath());
+    }
+    contentsStorage.startWatchingContentRoot();
+    // joined before contentsStorage goes out of scope.
+    std::atomic<bool> isConsoleStopRequested = false;
+    std::thread consoleThread([&contentsStorage, logger, &isConsoleStopRequested]() {
+        runConsoleCommandLoop(contentsStorage, logger, isConsoleStopRequested);
+    });
 
     std::string projectRootDirPath = getProjectRoot();
 
@@ -177,6 +273,16 @@ int main() {
         projectRootDirPath,
         inputIntervalMsForSessionRemoval
     );
+
+    // scrapes run on its own thread. a missing endpoint does not stop the rtsp service.
+    std::unique_ptr<MetricsHttpServer> metricsHttpServerPtr;
+    if (C::USE_MONITORING_HTTP_SERVER) {
+        metricsHttpServerPtr = std::make_unique<MetricsHttpServer>(
+            server, C::MONITORING_HTTP_SERVER_ADDRESS, C::MONITORING_HTTP_SERVER_PORT
+        );
+        if (!metricsHttpServerPtr->start()) metricsHttpServerPtr.reset();
+    }
+
     // server.start(); is blocking function.
     // if server stop with uncaught exception, the following shutting down logic will never work.
     server.start();
@@ -184,6 +290,10 @@ int main() {
     // Wait for shutdown to complete
     shutdownFuture.wait();
 
+    if (metricsHttpServerPtr) metricsHttpServerPtr->stop();
+    isConsoleStopRequested = true;
+    if (consoleThread.joinable()) consoleThread.join();
+
     // do cleaning before shutting down.
 
     for (auto& thread : threadVec) {
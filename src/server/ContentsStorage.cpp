@@ -1,61 +1,418 @@
 #include "../include/ContentsStorage.h"
 #include "../constants/C.h"
+#include "../constants/Util.h"
 
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 ContentsStorage::ContentsStorage(const std::string contentStorage)
   : logger(Logger::getLogger(C::CONTENTS_STORAGE)),
     contentRootPath(contentStorage),
-    parent(std::filesystem::path(contentStorage)) {}
+    parent(std::filesystem::path(contentStorage)) {
+#if defined(__linux__) || defined(__APPLE__)
+  if (C::USE_DIRECT_IO_BLOCK_CACHE) {
+    blockCachePtr = std::make_unique<BlockCache>(C::DIRECT_IO_BLOCK_CACHE_CAPACITY, C::DIRECT_IO_BLOCK_SIZE);
+  }
+#endif
+  if (C::LAZY_CONTENT_LOADING) {
+    loaderThreadPoolPtr = std::make_unique<boost::asio::thread_pool>(C::CONTENT_LOADING_MAX_THREAD_CNT);
+  }
+  if (C::USE_CAM_SWITCH_PREWARM) {
+    prewarmThreadPoolPtr = std::make_unique<boost::asio::thread_pool>(C::CAM_SWITCH_PREWARM_THREAD_CNT);
+  }
+}
 
 ContentsStorage::~ContentsStorage() {
   shutdown();
 }
 
 void ContentsStorage::init() {
-  std::vector<std::filesystem::path> files;
+  auto initialCatalogPtr = std::make_shared<ContentCatalog>();
   for (const auto& entry : std::filesystem::directory_iterator(parent)) {
     if (entry.is_directory()) {
-      files.push_back(entry.path());
+      initialCatalogPtr->entries.emplace(entry.path().filename().string(), makeCatalogEntry(nullptr));
     }
   }
-
-  for (const std::filesystem::path& contentPath : files) {
-    std::string contentTitle = contentPath.filename().string();
-    readers.try_emplace(contentTitle, ContentFileMeta(contentPath));
-  }
+  publishCatalog(initialCatalogPtr);
 
   std::string availableContents = ">> ";
-  for (auto& kvPair : readers) {
-    kvPair.second.init();
+  for (const auto& kvPair : initialCatalogPtr->entries) {
     availableContents += kvPair.first + ", ";
   }
-
   logger->warning("Available contents: " + availableContents);
+
+  if (C::LAZY_CONTENT_LOADING) {
+    // metas are loaded on the first request. start up does not depend on the library size.
+    logger->warning(
+      "Dongvin, " + std::to_string(initialCatalogPtr->entries.size())
+      + " contents are found. loads each on the first request."
+    );
+  } else {
+    const auto initStartTime = std::chrono::steady_clock::now();
+    const int threadCnt = std::max(
+      1, std::min(static_cast<int>(initialCatalogPtr->entries.size()), C::CONTENT_LOADING_MAX_THREAD_CNT)
+    );
+    boost::asio::thread_pool loadingThreadPool(threadCnt);
+    for (const auto& kvPair : initialCatalogPtr->entries) {
+      const std::string& contentTitle = kvPair.first;
+      boost::asio::post(loadingThreadPool, [this, &contentTitle]() {
+        getCid(contentTitle);
+      });
+    }
+    loadingThreadPool.join();
+
+    const auto totalElapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - initStartTime
+    ).count();
+    logger->warning(
+      "Dongvin, " + std::to_string(initialCatalogPtr->entries.size()) + " contents are ready with "
+      + std::to_string(threadCnt) + " loading threads. took ms : " + std::to_string(totalElapsedMs)
+    );
+  }
+
+  for (const std::string& contentTitle : C::PRELOAD_CONTENT_LIST) {
+    pinContent(contentTitle);
+  }
 }
 
-ContentFileMeta & ContentsStorage::getCid(std::string cid) {
-  if (readers.find(cid) == readers.end()) {
-    throw std::runtime_error("Dongvin, invalid cid! : " + cid);
+std::shared_ptr<ContentFileMeta> ContentsStorage::getCid(const std::string& cid) {
+  {
+    const std::shared_ptr<const ContentCatalog> curCatalogPtr = getCatalog();
+    const auto it = curCatalogPtr->entries.find(cid);
+    if (it == curCatalogPtr->entries.end()) {
+      logger->severe("Dongvin, invalid cid! : " + cid);
+      return nullptr;
+    }
+    it->second.lastAccessTimeMillisPtr->store(Util::getCurrentTimeMillis(), std::memory_order_relaxed);
+    if (it->second.metaPtr != nullptr || it->second.isLoadFailed) {
+      return it->second.metaPtr;
+    }
+  }
+
+  std::promise<std::shared_ptr<ContentFileMeta>> loadingPromise;
+  std::shared_future<std::shared_ptr<ContentFileMeta>> loadingFuture;
+  bool isLoader = false;
+  uint64_t loadingRevision = 0;
+  {
+    std::lock_guard<std::mutex> guard(catalogWriteLock);
+    // check again. other thread may have published the meta.
+    const std::shared_ptr<const ContentCatalog> curCatalogPtr = getCatalog();
+    const auto it = curCatalogPtr->entries.find(cid);
+    if (it == curCatalogPtr->entries.end()) {
+      logger->severe("Dongvin, content was removed while loading! : " + cid);
+      return nullptr;
+    }
+    if (it->second.metaPtr != nullptr || it->second.isLoadFailed) {
+      return it->second.metaPtr;
+    }
+    loadingRevision = it->second.revision;
+
+    if (auto loadingIt = loadingContents.find(cid); loadingIt != loadingContents.end()) {
+      loadingFuture = loadingIt->second;
+    } else {
+      isLoader = true;
+      loadingFuture = loadingPromise.get_future().share();
+      loadingContents.emplace(cid, loadingFuture);
+    }
+  }
+
+  // single flight. only the first requester loads without holding the lock, others wait for it.
+  if (isLoader) {
+    std::shared_ptr<ContentFileMeta> contentFileMetaPtr = loadContent(cid);
+    {
+      std::lock_guard<std::mutex> guard(catalogWriteLock);
+      const std::shared_ptr<const ContentCatalog> curCatalogPtr = getCatalog();
+      const auto it = curCatalogPtr->entries.find(cid);
+      // not published if the directory was reloaded or removed while loading.
+      // a failure is published too, so that a broken content is not loaded again on every request.
+      if (it != curCatalogPtr->entries.end() && it->second.revision == loadingRevision) {
+        auto newCatalogPtr = std::make_shared<ContentCatalog>(*curCatalogPtr);
+        ContentCatalog::Entry& entry = newCatalogPtr->entries.at(cid);
+        entry.metaPtr = contentFileMetaPtr;
+        entry.isLoadFailed = contentFileMetaPtr == nullptr;
+        publishCatalog(std::move(newCatalogPtr));
+      }
+      loadingContents.erase(cid);
+    }
+    loadingPromise.set_value(contentFileMetaPtr);
   }
+  return loadingFuture.get();
+}
+
+bool ContentsStorage::needsLoading(const std::string& cid) const {
+  const std::shared_ptr<const ContentCatalog> curCatalogPtr = getCatalog();
+  const auto it = curCatalogPtr->entries.find(cid);
+  return it != curCatalogPtr->entries.end() && it->second.metaPtr == nullptr && !it->second.isLoadFailed;
+}
+
+void ContentsStorage::loadContentAsync(const std::string& cid, std::function<void()> onLoaded) {
+  if (loaderThreadPoolPtr == nullptr) {
+    // every content was loaded on start up.
+    onLoaded();
+    return;
+  }
+  // concurrent requests for the same content still load once. later ones wait on a loader thread.
+  boost::asio::post(*loaderThreadPoolPtr, [this, cid, onLoaded = std::move(onLoaded)]() {
+    getCid(cid);
+    onLoaded();
+  });
+}
+
+bool ContentsStorage::hasContent(const std::string& cid) const {
+  const std::shared_ptr<const ContentCatalog> curCatalogPtr = getCatalog();
+  return curCatalogPtr->entries.find(cid) != curCatalogPtr->entries.end();
+}
+
+uint64_t ContentsStorage::getContentRevision(const std::string& cid) const {
+  const std::shared_ptr<const ContentCatalog> curCatalogPtr = getCatalog();
+  const auto it = curCatalogPtr->entries.find(cid);
+  return it == curCatalogPtr->entries.end() ? 0 : it->second.revision;
+}
+
+void ContentsStorage::evictColdContents() {
+  if (!C::LAZY_CONTENT_LOADING) return;
+
+  std::shared_ptr<const ContentCatalog> oldCatalogPtr;
+  std::string evictedContents;
+  {
+    std::lock_guard<std::mutex> guard(catalogWriteLock);
+    oldCatalogPtr = getCatalog();
+    const int64_t now = Util::getCurrentTimeMillis();
+
+    std::vector<std::string> coldContentTitles;
+    for (const auto& [contentTitle, entry] : oldCatalogPtr->entries) {
+      // use_count 1 : neither a session nor an older catalog holds this meta.
+      const bool isIdle = now - entry.lastAccessTimeMillisPtr->load(std::memory_order_relaxed)
+        > C::COLD_CONTENT_EVICTION_TIMEOUT_MS;
+      if (entry.metaPtr != nullptr && isIdle && entry.metaPtr.use_count() == 1) {
+        coldContentTitles.push_back(contentTitle);
+      }
+    }
+    if (coldContentTitles.empty()) return;
+
+    auto newCatalogPtr = std::make_shared<ContentCatalog>(*oldCatalogPtr);
+    for (const std::string& contentTitle : coldContentTitles) {
+      newCatalogPtr->entries.at(contentTitle).metaPtr = nullptr;
+      evictedContents += contentTitle + ", ";
+    }
+    publishCatalog(std::move(newCatalogPtr));
+  }
+
+  // metas are destroyed here, out of the lock.
+  oldCatalogPtr.reset();
+  logger->warning("Dongvin, evicted cold content metas : " + evictedContents);
+}
+
+void ContentsStorage::startWatchingContentRoot() {
+  if (!C::USE_CONTENT_HOT_RELOAD || rootWatcherPtr != nullptr) return;
+  rootWatcherPtr = std::make_unique<ContentRootWatcher>(parent, [this](const std::string& contentTitle) {
+    reloadContent(contentTitle);
+  });
+  if (!rootWatcherPtr->start()) {
+    rootWatcherPtr.reset();
+  }
+}
+
+std::shared_ptr<const ContentsStorage::ContentCatalog> ContentsStorage::getCatalog() const {
+  return std::atomic_load(&catalogPtr);
+}
+
+void ContentsStorage::publishCatalog(std::shared_ptr<const ContentCatalog> newCatalogPtr) {
+  std::atomic_store(&catalogPtr, std::move(newCatalogPtr));
+}
 
-  // return reference : FileReader is not allowed to copy
-  ContentFileMeta& fileReader = readers.at(cid);
-  return fileReader;
+ContentsStorage::ContentCatalog::Entry ContentsStorage::makeCatalogEntry(std::shared_ptr<ContentFileMeta> metaPtr) {
+  ContentCatalog::Entry entry;
+  entry.metaPtr = std::move(metaPtr);
+  entry.lastAccessTimeMillisPtr = std::make_shared<std::atomic<int64_t>>(Util::getCurrentTimeMillis());
+  entry.revision = ++catalogRevision;
+  return entry;
 }
 
-const std::unordered_map<std::string, ContentFileMeta> & ContentsStorage::getContentFileMetaMap() const {
-  return readers;
+std::shared_ptr<ContentFileMeta> ContentsStorage::loadContent(const std::string& contentTitle) {
+  const auto startTime = std::chrono::steady_clock::now();
+  auto contentFileMetaPtr = std::make_shared<ContentFileMeta>(parent / contentTitle);
+  bool initResult = false;
+  try {
+    initResult = contentFileMetaPtr->init();
+  } catch (const std::exception& e) {
+    logger->severe("Dongvin, exception while loading content! : " + contentTitle);
+    std::cerr << e.what() << "\n";
+  }
+  const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now() - startTime
+  ).count();
+  logger->info(
+    "Dongvin, loaded content : " + contentTitle + ", result : " + (initResult ? "ok" : "failed")
+    + ", took ms : " + std::to_string(elapsedMs)
+  );
+  return initResult ? contentFileMetaPtr : nullptr;
+}
+
+void ContentsStorage::reloadContent(const std::string& contentTitle) {
+  const std::filesystem::path contentPath = parent / contentTitle;
+  std::error_code ec;
+  const bool isRemoved = !std::filesystem::is_directory(contentPath, ec);
+
+  // cached bytes of the old files must not be served to new sessions.
+  if (blockCachePtr != nullptr) {
+    blockCachePtr->invalidate(contentPath.string());
+    if (tierCachePtr != nullptr) blockCachePtr->invalidate(tierCachePtr->getFastContentPath(contentTitle));
+  }
+  if (tierCachePtr != nullptr) tierCachePtr->invalidate(contentTitle);
+
+  if (isRemoved) {
+    {
+      std::lock_guard<std::mutex> guard(catalogWriteLock);
+      auto newCatalogPtr = std::make_shared<ContentCatalog>(*getCatalog());
+      if (newCatalogPtr->entries.erase(contentTitle) == 0) return;
+      publishCatalog(std::move(newCatalogPtr));
+    }
+    if (getPinnedContent(contentTitle) != nullptr) unpinContent(contentTitle);
+    logger->warning("Dongvin, content was removed : " + contentTitle);
+    return;
+  }
+
+  // build the new meta out of the lock. loaded metas are rebuilt, the others are loaded on the next request.
+  bool needLoad = !C::LAZY_CONTENT_LOADING;
+  std::shared_ptr<ContentFileMeta> oldMetaPtr = nullptr;
+  {
+    const std::shared_ptr<const ContentCatalog> curCatalogPtr = getCatalog();
+    if (auto it = curCatalogPtr->entries.find(contentTitle); it != curCatalogPtr->entries.end()) {
+      oldMetaPtr = it->second.metaPtr;
+      needLoad = needLoad || oldMetaPtr != nullptr;
+    }
+  }
+  std::shared_ptr<ContentFileMeta> newMetaPtr = needLoad ? loadContent(contentTitle) : nullptr;
+  if (needLoad && newMetaPtr == nullptr && oldMetaPtr != nullptr) {
+    logger->severe("Dongvin, failed to reload content. keeps the previous meta. : " + contentTitle);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(catalogWriteLock);
+    auto newCatalogPtr = std::make_shared<ContentCatalog>(*getCatalog());
+    newCatalogPtr->entries[contentTitle] = makeCatalogEntry(std::move(newMetaPtr));
+    publishCatalog(std::move(newCatalogPtr));
+  }
+
+  if (getPinnedContent(contentTitle) != nullptr) {
+    // sessions holding the old pinned content keep it until they end.
+    unpinContent(contentTitle);
+    pinContent(contentTitle);
+  }
+  logger->warning(
+    "Dongvin, reloaded content : " + contentTitle + (oldMetaPtr != nullptr ? ", replaced the loaded meta" : "")
+  );
 }
 
 void ContentsStorage::shutdown() {
-  // circulate through reference. FileReader is not allowed to copy.
-  for (auto& kvPair : readers) {
-    kvPair.second.shutdown();
+  if (rootWatcherPtr != nullptr) rootWatcherPtr->stop();
+  if (loaderThreadPoolPtr != nullptr) {
+    // queued loads are dropped. a running one finishes before the metas are shut down.
+    loaderThreadPoolPtr->stop();
+    loaderThreadPoolPtr->join();
+    loaderThreadPoolPtr = nullptr;
+  }
+  if (prewarmThreadPoolPtr != nullptr) {
+    prewarmThreadPoolPtr->stop();
+    prewarmThreadPoolPtr->join();
+    prewarmThreadPoolPtr = nullptr;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(catalogWriteLock);
+    for (const auto& kvPair : getCatalog()->entries) {
+      if (kvPair.second.metaPtr != nullptr) kvPair.second.metaPtr->shutdown();
+    }
+    publishCatalog(std::make_shared<const ContentCatalog>());
+  }
+
+  if (blockCachePtr != nullptr) {
+    logger->warning("Dongvin, block cache stats : " + blockCachePtr->getStats());
+    blockCachePtr->shutdown();
   }
-  readers.clear();
+
+  if (tierCachePtr != nullptr) tierCachePtr->shutdown();
+
+  std::lock_guard<std::mutex> guard(pinnedContentsLock);
+  pinnedContents.clear();
 }
 
 std::string ContentsStorage::getContentRootPath() {
   return contentRootPath;
 }
+
+BlockCache * ContentsStorage::getBlockCache() const {
+  return blockCachePtr.get();
+}
+
+void ContentsStorage::initTierCache(const std::string& fastRootPath) {
+  tierCachePtr = std::make_unique<TieredContentCache>(contentRootPath, fastRootPath, C::LOCAL_TIER_CACHE_QUOTA_BYTES);
+  tierCachePtr->init();
+}
+
+boost::asio::thread_pool* ContentsStorage::getPrewarmThreadPool() const {
+  return prewarmThreadPoolPtr.get();
+}
+
+TieredContentCache * ContentsStorage::getTierCache() const {
+  return tierCachePtr.get();
+}
+
+bool ContentsStorage::pinContent(const std::string& contentTitle) {
+  if (!hasContent(contentTitle)) {
+    logger->severe("Dongvin, cannot pin unknown content! : " + contentTitle);
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> guard(pinnedContentsLock);
+    if (pinnedContents.find(contentTitle) != pinnedContents.end()) return true;
+  }
+
+  // load without holding the lock. sessions keep reading from the disk until it is done.
+  auto pinnedContentPtr = std::make_shared<PinnedContent>(parent / contentTitle);
+  if (!pinnedContentPtr->load()) {
+    logger->severe("Dongvin, failed to pin content! : " + contentTitle);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> guard(pinnedContentsLock);
+  pinnedContents[contentTitle] = std::move(pinnedContentPtr);
+  logger->warning(
+    "Dongvin, pinned content : " + contentTitle
+    + ", bytes : " + std::to_string(pinnedContents.at(contentTitle)->getByteSize())
+    + ", locked : " + (pinnedContents.at(contentTitle)->isLocked() ? "true" : "false")
+  );
+  return true;
+}
+
+bool ContentsStorage::unpinContent(const std::string& contentTitle) {
+  std::lock_guard<std::mutex> guard(pinnedContentsLock);
+  if (pinnedContents.erase(contentTitle) == 0) {
+    logger->warning("Dongvin, content is not pinned : " + contentTitle);
+    return false;
+  }
+  logger->warning("Dongvin, unpinned content : " + contentTitle);
+  return true;
+}
+
+std::shared_ptr<const PinnedContent> ContentsStorage::getPinnedContent(const std::string& contentTitle) const {
+  std::lock_guard<std::mutex> guard(pinnedContentsLock);
+  if (auto it = pinnedContents.find(contentTitle); it != pinnedContents.end()) {
+    return it->second;
+  }
+  return nullptr;
+}
+
+std::vector<std::string> ContentsStorage::getPinnedContentTitles() const {
+  std::lock_guard<std::mutex> guard(pinnedContentsLock);
+  std::vector<std::string> titles;
+  for (const auto& [contentTitle, pinnedContentPtr] : pinnedContents) {
+    titles.push_back(contentTitle);
+  }
+  return titles;
+}
@@ -0,0 +1,414 @@
+#include "../include/MetricsHttpServer.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <string_view>
+#include <utility>
+
+#if defined(__linux__)
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+#include "../constants/C.h"
+#include "../include/MediaClock.h"
+#include "../include/Server.h"
+#include "../include/Session.h"
+
+using boost::asio::ip::tcp;
+
+struct MetricsHttpServer::HttpConnection {
+  explicit HttpConnection(tcp::socket inputSocket)
+    : socket(std::move(inputSocket)),
+      timer(socket.get_executor()),
+      requestBuf(C::MONITORING_HTTP_MAX_REQUEST_SIZE) {}
+
+  tcp::socket socket;
+  boost::asio::steady_timer timer;
+  boost::asio::streambuf requestBuf;
+  std::string response;
+};
+
+namespace {
+  void appendMetricHead(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+  }
+
+  template<typename T>
+  void appendSample(std::string& out, const char* name, std::string_view labels, T value) {
+    out += name;
+    if (!labels.empty()) {
+      out += '{';
+      out += labels;
+      out += '}';
+    }
+    out += ' ';
+    out += std::to_string(value);
+    out += '\n';
+  }
+}
+
+MetricsHttpServer::MetricsHttpServer(Server& inputServer, std::string inputAddress, int inputPort)
+  : logger(Logger::getLogger(C::METRICS_HTTP_SERVER)),
+    server(inputServer),
+    address(std::move(inputAddress)),
+    port(inputPort),
+    acceptor(io_context) {}
+
+MetricsHttpServer::~MetricsHttpServer() {
+  stop();
+}
+
+bool MetricsHttpServer::start() {
+  boost::system::error_code ec;
+  const tcp::endpoint endpoint(boost::asio::ip::make_address(address, ec), static_cast<unsigned short>(port));
+  if (!ec) acceptor.open(endpoint.protocol(), ec);
+  if (!ec) acceptor.set_option(tcp::acceptor::reuse_address(true), ec);
+  if (!ec) acceptor.bind(endpoint, ec);
+  if (!ec) acceptor.listen(boost::asio::socket_base::max_listen_connections, ec);
+  if (ec) {
+    logger->severe(
+      "Dongvin, failed to open metrics http server. " + address + ":" + std::to_string(port) + ", " + ec.message()
+    );
+    return false;
+  }
+
+  asyncAccept();
+  thread = std::thread([this](){ io_context.run(); });
+  logger->info3("Dongvin, metrics http server starts! " + address + ":" + std::to_string(port));
+  return true;
+}
+
+void MetricsHttpServer::stop() {
+  io_context.stop();
+  if (thread.joinable()) thread.join();
+}
+
+void MetricsHttpServer::asyncAccept() {
+  acceptor.async_accept([this](const boost::system::error_code& ec, tcp::socket socket) {
+    if (ec == boost::asio::error::operation_aborted) return;
+    if (!ec) {
+      auto connectionPtr = std::make_shared<HttpConnection>(std::move(socket));
+      closeOnTimeout(connectionPtr);
+      boost::asio::async_read_until(
+        connectionPtr->socket, connectionPtr->requestBuf, "\r\n\r\n",
+        [this, connectionPtr](const boost::system::error_code& readError, std::size_t) {
+          if (!readError) onRequest(connectionPtr);
+        }
+      );
+    }
+    asyncAccept();
+  });
+}
+
+void MetricsHttpServer::closeOnTimeout(const std::shared_ptr<HttpConnection>& connectionPtr) {
+  connectionPtr->timer.expires_after(std::chrono::milliseconds(C::MONITORING_HTTP_TIMEOUT_MS));
+  // weak, so that a finished connection is freed at once. its timer is cancelled then.
+  const std::weak_ptr<HttpConnection> weakConnectionPtr = connectionPtr;
+  connectionPtr->timer.async_wait([weakConnectionPtr](const boost::system::error_code& ec) {
+    if (ec == boost::asio::error::operation_aborted) return;
+    if (const auto lockedConnectionPtr = weakConnectionPtr.lock()) {
+      // the pending read or write ends with an error, which releases the connection.
+      boost::system::error_code ignored;
+      lockedConnectionPtr->socket.shutdown(tcp::socket::shutdown_both, ignored);
+      lockedConnectionPtr->socket.close(ignored);
+    }
+  });
+}
+
+void MetricsHttpServer::onRequest(const std::shared_ptr<HttpConnection>& connectionPtr) {
+  // request line only. e.g. GET /metrics HTTP/1.1
+  const auto requestData = connectionPtr->requestBuf.data();
+  const std::string_view request(
+    static_cast<const char*>(requestData.data()), requestData.size()
+  );
+  const std::string_view requestLine = request.substr(0, request.find("\r\n"));
+  const size_t pathBegin = requestLine.find(' ');
+  const size_t pathEnd = pathBegin == std::string_view::npos ? pathBegin : requestLine.find(' ', pathBegin + 1);
+  const std::string_view method = requestLine.substr(0, pathBegin);
+  const std::string_view path = pathEnd == std::string_view::npos
+    ? std::string_view{} : requestLine.substr(pathBegin + 1, pathEnd - pathBegin - 1);
+
+  std::string body;
+  std::string status = "200 OK";
+  if (method != "GET") {
+    status = "405 Method Not Allowed";
+  } else if (path != C::MONITORING_METRICS_PATH) {
+    status = "404 Not Found";
+  } else {
+    body.reserve(lastResponseSize + lastResponseSize / 4);
+    renderMetrics(body);
+    lastResponseSize = body.size();
+  }
+
+  std::string& response = connectionPtr->response;
+  response.reserve(body.size() + 128);
+  response += "HTTP/1.1 ";
+  response += status;
+  response += "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: ";
+  response += std::to_string(body.size());
+  response += "\r\nConnection: close\r\n\r\n";
+  response += body;
+
+  boost::asio::async_write(
+    connectionPtr->socket, boost::asio::buffer(response),
+    [connectionPtr](const boost::system::error_code&, std::size_t) {
+      connectionPtr->timer.cancel();
+      boost::system::error_code ignored;
+      connectionPtr->socket.shutdown(tcp::socket::shutdown_both, ignored);
+      connectionPtr->socket.close(ignored);
+    }
+  );
+}
+
+void MetricsHttpServer::renderMetrics(std::string& out) {
+  // server wide
+  const SessionRegistryStats registryStats = server.getSessionRegistryStats();
+  const std::vector<std::shared_ptr<Session>> sessions = server.getSessionsSnapshot();
+
+  std::vector<std::pair<std::string, SessionMetrics>> sessionMetricsVec;
+  if (C::USE_MONITORING_PER_SESSION_METRICS) sessionMetricsVec.reserve(sessions.size());
+  SessionMetrics liveSessionsMetrics;
+  int64_t pausedCnt = 0;
+  int64_t parkedCnt = 0;
+  for (const auto& sessionPtr : sessions) {
+    SessionMetrics metrics = sessionPtr->getMetrics();
+    if (metrics.isPaused) ++pausedCnt;
+    if (metrics.isParked) ++parkedCnt;
+    liveSessionsMetrics.txBitrateBps += metrics.txBitrateBps;
+    liveSessionsMetrics.queuedRtpCnt += metrics.queuedRtpCnt;
+    liveSessionsMetrics.allocatedBytesForSample += metrics.allocatedBytesForSample;
+    liveSessionsMetrics.prewarmedBytes += metrics.prewarmedBytes;
+    liveSessionsMetrics.sentRtpCnt += metrics.sentRtpCnt;
+    liveSessionsMetrics.lateSampleCnt += metrics.lateSampleCnt;
+    liveSessionsMetrics.droppedRtpCnt += metrics.droppedRtpCnt;
+    liveSessionsMetrics.frameLatenessMaxUs =
+      std::max(liveSessionsMetrics.frameLatenessMaxUs, metrics.frameLatenessMaxUs);
+    if (C::USE_MONITORING_PER_SESSION_METRICS) {
+      sessionMetricsVec.emplace_back("session_id=\"" + sessionPtr->getSessionId() + "\"", metrics);
+    }
+  }
+
+  appendMetricHead(out, "rtsp_sessions", "gauge", "Sessions by state. paused and parked ones are live too.");
+  appendSample(out, "rtsp_sessions", "state=\"live\"", registryStats.liveSessionCnt);
+  appendSample(out, "rtsp_sessions", "state=\"retired\"", registryStats.retiredSessionCnt);
+  appendSample(out, "rtsp_sessions", "state=\"paused\"", pausedCnt);
+  appendSample(out, "rtsp_sessions", "state=\"parked\"", parkedCnt);
+  appendMetricHead(out, "rtsp_sessions_added_total", "counter", "Sessions accepted since the start.");
+  appendSample(out, "rtsp_sessions_added_total", "", registryStats.totalAddedCnt);
+
+  if (const int64_t rssBytes = getResidentMemoryBytes(); rssBytes >= 0) {
+    appendMetricHead(out, "process_resident_memory_bytes", "gauge", "Resident memory size in bytes.");
+    appendSample(out, "process_resident_memory_bytes", "", rssBytes);
+  }
+
+  const HotPathMetrics& hotPathMetrics = HotPathMetrics::getShared();
+  appendMetricHead(
+    out, "rtsp_hot_path_latency_us", "summary",
+    "Hot path latency. sample_read, rtp_queue_dwell, socket_write and periodic_task_lateness."
+  );
+  // merged from the per thread shards once per scrape.
+  appendSummary(out, "rtsp_hot_path_latency_us", "path=\"sample_read\"", hotPathMetrics.sampleReadUs.getSnapshot());
+  appendSummary(
+    out, "rtsp_hot_path_latency_us", "path=\"rtp_queue_dwell\"", hotPathMetrics.rtpQueueDwellUs.getSnapshot()
+  );
+  appendSummary(out, "rtsp_hot_path_latency_us", "path=\"socket_write\"", hotPathMetrics.socketWriteUs.getSnapshot());
+  appendSummary(
+    out, "rtsp_hot_path_latency_us", "path=\"periodic_task_lateness\"",
+    hotPathMetrics.periodicTaskLatenessUs.getSnapshot()
+  );
+
+  // server side lateness only. the client measures the network on top of this.
+  const LatencyHistogram::Snapshot frameLatenessSnapshot = hotPathMetrics.frameLatenessUs.getSnapshot();
+  appendMetricHead(
+    out, "rtsp_frame_lateness_us", "summary",
+    "Last packet of a video frame written, after the deadline from its sample no and unit time. early is 0."
+  );
+  appendSummary(out, "rtsp_frame_lateness_us", "", frameLatenessSnapshot);
+  if (frameLatenessSnapshot.totalCnt > 0) {
+    appendMetricHead(
+      out, "rtsp_frames_on_time_ratio", "gauge",
+      "Video frames written within FRAME_ON_TIME_THRESHOLD_US after the deadline. off by one bucket at most."
+    );
+    appendSample(
+      out, "rtsp_frames_on_time_ratio", "",
+      static_cast<double>(frameLatenessSnapshot.getCountAtOrBelow(C::FRAME_ON_TIME_THRESHOLD_US))
+        / static_cast<double>(frameLatenessSnapshot.totalCnt)
+    );
+  }
+
+  std::vector<const LatenessHistogram*> clockHistograms;
+  size_t trackCnt = 0;
+  int64_t skippedTickCnt = 0;
+  for (const auto& mediaClockPtr : server.getMediaClocks()) {
+    clockHistograms.push_back(&mediaClockPtr->getLatenessHistogram());
+    trackCnt += mediaClockPtr->getTrackCnt();
+    skippedTickCnt += mediaClockPtr->getLatenessHistogram().getSkippedCnt();
+  }
+  appendHistogram(
+    out, "rtsp_media_clock_lateness_us", "Wake up lateness of the media clocks against the sample deadlines.",
+    clockHistograms
+  );
+  appendMetricHead(out, "rtsp_media_clock_skipped_ticks_total", "counter", "Sample ticks skipped after a long stall.");
+  appendSample(out, "rtsp_media_clock_skipped_ticks_total", "", skippedTickCnt);
+  appendMetricHead(out, "rtsp_media_clock_tracks", "gauge", "Sample reading tracks on the media clocks.");
+  appendSample(out, "rtsp_media_clock_tracks", "", trackCnt);
+
+  // over the live sessions only, so that these are gauges. they drop when a session ends.
+  appendMetricHead(
+    out, "rtsp_live_sessions_tx_bitrate_bps", "gauge", "TX bitrate of the last sampling period, summed."
+  );
+  appendSample(out, "rtsp_live_sessions_tx_bitrate_bps", "", liveSessionsMetrics.txBitrateBps);
+  appendMetricHead(out, "rtsp_live_sessions_rtp_queue_depth", "gauge", "RTP packets waiting for the tx threads.");
+  appendSample(out, "rtsp_live_sessions_rtp_queue_depth", "", liveSessionsMetrics.queuedRtpCnt);
+  appendMetricHead(
+    out, "rtsp_live_sessions_allocated_sample_bytes", "gauge", "Bytes of samples read but not sent yet, summed."
+  );
+  appendSample(out, "rtsp_live_sessions_allocated_sample_bytes", "", liveSessionsMetrics.allocatedBytesForSample);
+  appendMetricHead(
+    out, "rtsp_live_sessions_prewarmed_bytes", "gauge", "Bytes of sibling cam samples kept for cam switching, summed."
+  );
+  appendSample(out, "rtsp_live_sessions_prewarmed_bytes", "", liveSessionsMetrics.prewarmedBytes);
+  appendMetricHead(out, "rtsp_live_sessions_rtp_sent", "gauge", "RTP packets written by the live sessions.");
+  appendSample(out, "rtsp_live_sessions_rtp_sent", "", liveSessionsMetrics.sentRtpCnt);
+  appendMetricHead(
+    out, "rtsp_live_sessions_samples_late", "gauge", "Sample reading ticks put off by the live sessions."
+  );
+  appendSample(out, "rtsp_live_sessions_samples_late", "", liveSessionsMetrics.lateSampleCnt);
+  appendMetricHead(out, "rtsp_live_sessions_rtp_dropped", "gauge", "RTP packets discarded by the live sessions.");
+  appendSample(out, "rtsp_live_sessions_rtp_dropped", "", liveSessionsMetrics.droppedRtpCnt);
+  appendMetricHead(
+    out, "rtsp_live_sessions_frame_lateness_max_us", "gauge", "The largest frame lateness of a live session."
+  );
+  appendSample(out, "rtsp_live_sessions_frame_lateness_max_us", "", liveSessionsMetrics.frameLatenessMaxUs);
+
+  if (!C::USE_MONITORING_PER_SESSION_METRICS) return;
+
+  // per session. all the samples of one metric are written together.
+  appendMetricHead(out, "rtsp_session_tx_bitrate_bps", "gauge", "TX bitrate of the last sampling period.");
+  for (const auto& [labels, metrics] : sessionMetricsVec) {
+    appendSample(out, "rtsp_session_tx_bitrate_bps", labels, metrics.txBitrateBps);
+  }
+  appendMetricHead(out, "rtsp_session_rtp_queue_depth", "gauge", "RTP packets waiting for the tx thread.");
+  for (const auto& [labels, metrics] : sessionMetricsVec) {
+    appendSample(out, "rtsp_session_rtp_queue_depth", labels, metrics.queuedRtpCnt);
+  }
+  appendMetricHead(out, "rtsp_session_allocated_sample_bytes", "gauge", "Bytes of samples read but not sent yet.");
+  for (const auto& [labels, metrics] : sessionMetricsVec) {
+    appendSample(out, "rtsp_session_allocated_sample_bytes", labels, metrics.allocatedBytesForSample);
+  }
+  appendMetricHead(
+    out, "rtsp_session_prewarmed_bytes", "gauge", "Bytes of sibling cam samples kept for cam switching."
+  );
+  for (const auto& [labels, metrics] : sessionMetricsVec) {
+    appendSample(out, "rtsp_session_prewarmed_bytes", labels, metrics.prewarmedBytes);
+  }
+  appendMetricHead(out, "rtsp_session_rtp_sent_total", "counter", "RTP packets written to the socket.");
+  for (const auto& [labels, metrics] : sessionMetricsVec) {
+    appendSample(out, "rtsp_session_rtp_sent_total", labels, metrics.sentRtpCnt);
+  }
+  appendMetricHead(out, "rtsp_session_samples_read_total", "counter", "Samples read by media type.");
+  for (const auto& [labels, metrics] : sessionMetricsVec) {
+    appendSample(out, "rtsp_session_samples_read_total", labels + ",media=\"video\"", metrics.readVideoSampleCnt);
+    appendSample(out, "rtsp_session_samples_read_total", labels + ",media=\"audio\"", metrics.readAudioSampleCnt);
+  }
+  appendMetricHead(
+    out, "rtsp_session_samples_late_total", "counter", "Sample reading ticks put off since the client buffer was full."
+  );
+  for (const auto& [labels, metrics] : sessionMetricsVec) {
+    appendSample(out, "rtsp_session_samples_late_total", labels, metrics.lateSampleCnt);
+  }
+  appendMetricHead(out, "rtsp_session_rtp_dropped_total", "counter", "RTP packets discarded without being sent.");
+  for (const auto& [labels, metrics] : sessionMetricsVec) {
+    appendSample(out, "rtsp_session_rtp_dropped_total", labels, metrics.droppedRtpCnt);
+  }
+  appendMetricHead(out, "rtsp_session_frames_delivered_total", "counter", "Video frames written, against a deadline.");
+  for (const auto& [labels, metrics] : sessionMetricsVec) {
+    appendSample(out, "rtsp_session_frames_delivered_total", labels, metrics.deliveredFrameCnt);
+  }
+  appendMetricHead(
+    out, "rtsp_session_frames_on_time_total", "counter", "Video frames written within FRAME_ON_TIME_THRESHOLD_US."
+  );
+  for (const auto& [labels, metrics] : sessionMetricsVec) {
+    appendSample(out, "rtsp_session_frames_on_time_total", labels, metrics.onTimeFrameCnt);
+  }
+  appendMetricHead(out, "rtsp_session_frame_lateness_us", "gauge", "Frame lateness by stat. p99 is a bucket bound.");
+  for (const auto& [labels, metrics] : sessionMetricsVec) {
+    appendSample(out, "rtsp_session_frame_lateness_us", labels + ",stat=\"p99\"", metrics.frameLatenessP99Us);
+    appendSample(out, "rtsp_session_frame_lateness_us", labels + ",stat=\"max\"", metrics.frameLatenessMaxUs);
+  }
+}
+
+void MetricsHttpServer::appendHistogram(
+  std::string& out,
+  const char* name,
+  const char* help,
+  const std::vector<const LatenessHistogram*>& histograms
+) {
+  appendMetricHead(out, name, "histogram", help);
+  const std::string bucketName = std::string(name) + "_bucket";
+  uint64_t cumulativeCnt = 0;
+  int64_t sumUs = 0;
+  for (size_t bucketIdx = 0; bucketIdx < LatenessHistogram::BUCKET_CNT; ++bucketIdx) {
+    for (const LatenessHistogram* histogramPtr : histograms) cumulativeCnt += histogramPtr->getCount(bucketIdx);
+    const std::string le = bucketIdx < LatenessHistogram::BUCKET_BOUNDS_US.size()
+      ? std::to_string(LatenessHistogram::BUCKET_BOUNDS_US[bucketIdx]) : "+Inf";
+    appendSample(out, bucketName.c_str(), "le=\"" + le + "\"", cumulativeCnt);
+  }
+  for (const LatenessHistogram* histogramPtr : histograms) sumUs += histogramPtr->getSumUs();
+  appendSample(out, (std::string(name) + "_sum").c_str(), "", sumUs);
+  appendSample(out, (std::string(name) + "_count").c_str(), "", cumulativeCnt);
+}
+
+void MetricsHttpServer::appendSummary(
+  std::string& out,
+  const char* name,
+  const std::string& labels,
+  const LatencyHistogram::Snapshot& snapshot
+) {
+  const std::string labelPrefix = labels.empty() ? labels : labels + ",";
+  const std::string sumName = std::string(name) + "_sum";
+  const std::string countName = std::string(name) + "_count";
+  static const std::array<std::pair<const char*, double>, 4> quantiles = {{
+    {"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}, {"0.999", 0.999}
+  }};
+  for (const auto& [quantileLabel, quantile] : quantiles) {
+    appendSample(
+      out, name, labelPrefix + "quantile=\"" + quantileLabel + "\"", snapshot.getValueAtQuantile(quantile)
+    );
+  }
+  appendSample(out, name, labelPrefix + "quantile=\"1\"", snapshot.maxUs);
+  appendSample(out, sumName.c_str(), labels, snapshot.sumUs);
+  appendSample(out, countName.c_str(), labels, snapshot.totalCnt);
+}
+
+int64_t MetricsHttpServer::getResidentMemoryBytes() {
+#if defined(__linux__)
+  // second field : resident pages
+  std::ifstream statm("/proc/self/statm");
+  int64_t totalPageCnt = 0;
+  int64_t residentPageCnt = 0;
+  if (statm >> totalPageCnt >> residentPageCnt) return residentPageCnt * sysconf(_SC_PAGESIZE);
+  return C::INVALID;
+#elif defined(__APPLE__)
+  mach_task_basic_info info{};
+  mach_msg_type_number_t infoCnt = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &infoCnt) == KERN_SUCCESS) {
+    return static_cast<int64_t>(info.resident_size);
+  }
+  return C::INVALID;
+#else
+  return C::INVALID;
+#endif
+}
@@ -29,7 +29,12 @@ Server::Server(
     projectRootPath(inputProjectRoot),
     removeClosedSessionTask(
       inputIoContext, boost::asio::make_strand(inputIoContext), inputIntervalMs
-    ){}
+    ),
+    removeClosedSessionIntervalMs(inputIntervalMs){
+  for (const auto& workerIoContextPtr : ioContextPool) {
+    mediaClocks.push_back(std::make_unique<MediaClock>(*workerIoContextPtr));
+  }
+}
 
 Server::~Server() {
   shutdownServer();
@@ -40,12 +45,64 @@ void Server::start() {
   sntpTimeProvider.start();
 
   removeClosedSessionTask.setTask([&](){
-    shutdownSessions.clear();
-    logger->severe("Dongvin, completely removed sessions.");
+    const size_t removedCnt = sessionRegistry.clearRetired();
+    logger->severe("Dongvin, completely removed sessions. cnt : " + std::to_string(removedCnt));
+    contentsStorage.evictColdContents();
   });
   removeClosedSessionTask.start();
   logger->info3("Dongvin, timer for closed session removal starts!");
 
+  if (C::USE_REUSEPORT_SHARDS && startShards()) {
+    return;
+  }
+  runAcceptLoop();
+}
+
+std::shared_ptr<Session> Server::createSession(
+  boost::asio::io_context& sessionIoContext,
+  std::shared_ptr<boost::asio::io_context> workerIoContextPtr,
+  std::shared_ptr<tcp::socket> socketPtr
+) {
+  std::string sessionId = getSessionId();
+
+  // makes session and starts it.
+  std::chrono::milliseconds zeroInterval(C::ZERO);
+  std::shared_ptr<Session> sessionPtr = std::make_shared<Session>(
+    sessionIoContext, workerIoContextPtr, getMediaClock(workerIoContextPtr), socketPtr, sessionId,
+    *this, contentsStorage, sntpTimeProvider, zeroInterval
+  );
+
+  // used weak pointer to break the circular dependencies
+  auto inputStreamHandlerPtr = std::make_shared<StreamHandler>(sessionId, sessionPtr, contentsStorage);
+  auto rtspHandlerPtr = std::make_shared<RtspHandler>(sessionId, sessionPtr, inputStreamHandlerPtr);
+  auto rtpHandlerPtr = std::make_shared<RtpHandler>(sessionId, sessionPtr, inputStreamHandlerPtr);
+
+  sessionPtr->setStreamHandlerPtr(inputStreamHandlerPtr);
+  sessionPtr->setRtspHandlerPtr(rtspHandlerPtr);
+  sessionPtr->setRtpHandlerPtr(rtpHandlerPtr);
+  sessionPtr->start();
+  return sessionPtr;
+}
+
+bool Server::startShards() {
+  for (int i = 0; i < static_cast<int>(ioContextPool.size()); ++i) {
+    auto shardPtr = std::make_shared<ServerShard>(i, *this, ioContextPool[i], removeClosedSessionIntervalMs);
+    if (!shardPtr->start()) {
+      logger->severe("Dongvin, failed to start shards. falls back to the single acceptor.");
+      // started shards are already accepting. their pending accepts are aborted and release them.
+      for (auto& startedShardPtr : shards) {
+        startedShardPtr->stop();
+      }
+      shards.clear();
+      return false;
+    }
+    shards.push_back(std::move(shardPtr));
+  }
+  logger->info3("Dongvin, SO_REUSEPORT shards start! shard cnt : " + std::to_string(shards.size()));
+  return true;
+}
+
+void Server::runAcceptLoop() {
   tcp::acceptor acceptor(
     io_context, tcp::endpoint(tcp::v4(), C::RTSP_RTP_TCP_PORT)
   );
@@ -54,31 +111,15 @@ void Server::start() {
     while (true) {
       auto socketPtr = std::make_shared<tcp::socket>(io_context);
       acceptor.accept(*socketPtr);
-      std::string sessionId = getSessionId();
 
       auto workerIoContextPtr = getNextWorkerIoContextPtr();
+      std::shared_ptr<Session> sessionPtr = createSession(io_context, workerIoContextPtr, socketPtr);
+      const std::string sessionId = sessionPtr->getSessionId();
 
-      // makes session and starts it.
-      std::chrono::milliseconds zeroInterval(C::ZERO);
-      std::shared_ptr<Session> sessionPtr = std::make_shared<Session>(
-        io_context, workerIoContextPtr, socketPtr, sessionId,
-        *this, contentsStorage, sntpTimeProvider, zeroInterval
-      );
-
-      // used weak pointer to break the circular dependencies
-      auto inputStreamHandlerPtr = std::make_shared<StreamHandler>(sessionId, sessionPtr, contentsStorage);
-      auto rtspHandlerPtr = std::make_shared<RtspHandler>(sessionId, sessionPtr, inputStreamHandlerPtr);
-      auto rtpHandlerPtr = std::make_shared<RtpHandler>(sessionId, sessionPtr, inputStreamHandlerPtr);
-
-      sessionPtr->setStreamHandlerPtr(inputStreamHandlerPtr);
-      sessionPtr->setRtspHandlerPtr(rtspHandlerPtr);
-      sessionPtr->setRtpHandlerPtr(rtpHandlerPtr);
-      sessionPtr->start();
-
-      sessions.insert({sessionId, sessionPtr});
+      sessionRegistry.add(sessionId, sessionPtr);
       logger->warning(
         "Dongvin, new client arrives, id: " + sessionId
-        + ", total number of clients: " + std::to_string(sessions.size())
+        + ", total number of clients: " + std::to_string(sessionRegistry.getLiveSessionCnt())
       );
     }
   } catch (const std::exception& e) {
@@ -88,7 +129,16 @@ void Server::start() {
   }
 }
 
-std::unordered_map<std::string, std::shared_ptr<Session>> & Server::getSessions() {
+SessionRegistry& Server::getSessionRegistry() {
+  return sessionRegistry;
+}
+
+std::vector<std::shared_ptr<Session>> Server::getSessionsSnapshot() const {
+  std::vector<std::shared_ptr<Session>> sessions = sessionRegistry.snapshot();
+  for (const auto& shardPtr : shards) {
+    std::vector<std::shared_ptr<Session>> shardSessions = shardPtr->getSessionRegistry().snapshot();
+    sessions.insert(sessions.end(), shardSessions.begin(), shardSessions.end());
+  }
   return sessions;
 }
 
@@ -105,33 +155,40 @@ void Server::shutdownServer() {
   removeClosedSessionTask.stop();
   try {
     // save bitrate test record first.
-    for (auto& kvPair : sessions) {
-      kvPair.second->recordBitrateTestResult();
+    for (auto& sessionPtr : sessionRegistry.snapshot()) {
+      sessionPtr->recordBitrateTestResult();
     }
   } catch (const std::exception& e){
     logger->severe("Dongvin, exception while shutting down Server!");
     std::cerr << e.what() << "\n";
   }
-  sessions.clear();
+  sessionRegistry.clear();
+  for (auto& shardPtr : shards) {
+    shardPtr->stop();
+  }
+  for (auto& mediaClockPtr : mediaClocks) {
+    mediaClockPtr->stop();
+  }
   contentsStorage.shutdown();
 }
 
 void Server::afterTerminatingSession(const std::string& sessionId) {
-  if (sessions.find(sessionId) != sessions.end()) {
-    auto sessionPtr = sessions[sessionId];
-
-    sessions.erase(sessionId);
-    shutdownSessions.insert({sessionId, std::move(sessionPtr)});
+  // called from teardown threads. the registry locks only the bucket of this id.
+  if (sessionRegistry.retire(sessionId)) {
     logger->warning(
         "Dongvin, " + sessionId + " shuts down. Remaining session cnt : "
-            + std::to_string(sessions.size())
+            + std::to_string(sessionRegistry.getLiveSessionCnt())
     );
+    return;
+  }
+  for (auto& shardPtr : shards) {
+    if (shardPtr->retireSession(sessionId)) return;
   }
 }
 
 std::string Server::getSessionId() {
-  connectionCnt++;
-  return std::to_string(connectionCnt) + "_"
+  const int cnt = ++connectionCnt;
+  return std::to_string(cnt) + "_"
   + Util::getRandomKey(C::SESSION_KEY_BIT_SIZE);
 }
 
@@ -140,3 +197,26 @@ std::shared_ptr<boost::asio::io_context> Server::getNextWorkerIoContextPtr(){
   std::shared_ptr<boost::asio::io_context> ioContextPtr = ioContextPool[static_cast<int>(ioContextIdx)];
   return ioContextPtr;
 }
+
+SessionRegistryStats Server::getSessionRegistryStats() const {
+  SessionRegistryStats stats = sessionRegistry.getStats();
+  for (const auto& shardPtr : shards) {
+    const SessionRegistryStats shardStats = shardPtr->getSessionRegistry().getStats();
+    stats.liveSessionCnt += shardStats.liveSessionCnt;
+    stats.retiredSessionCnt += shardStats.retiredSessionCnt;
+    stats.totalAddedCnt += shardStats.totalAddedCnt;
+    stats.totalRetiredCnt += shardStats.totalRetiredCnt;
+  }
+  return stats;
+}
+
+const std::vector<std::unique_ptr<MediaClock>>& Server::getMediaClocks() const {
+  return mediaClocks;
+}
+
+MediaClock& Server::getMediaClock(const std::shared_ptr<boost::asio::io_context>& workerIoContextPtr) {
+  for (size_t i = 0; i < ioContextPool.size(); ++i) {
+    if (ioContextPool[i] == workerIoContextPtr) return *mediaClocks[i];
+  }
+  throw std::runtime_error("Dongvin, no media clock for the worker io_context!");
+}
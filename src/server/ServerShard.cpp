@@ -0,0 +1,111 @@
+#include "../include/ServerShard.h"
+#include "../include/Server.h"
+#include "../include/Session.h"
+#include "../constants/C.h"
+
+#include <iostream>
+
+using boost::asio::ip::tcp;
+
+ServerShard::ServerShard(
+  int inputShardIdx,
+  Server& inputServer,
+  std::shared_ptr<boost::asio::io_context> inputIoContextPtr,
+  std::chrono::milliseconds inputIntervalMs
+) : logger(Logger::getLogger(C::SERVER_SHARD)),
+    shardIdx(inputShardIdx),
+    server(inputServer),
+    ioContextPtr(std::move(inputIoContextPtr)),
+    acceptor(*ioContextPtr),
+    removeClosedSessionTask(
+      *ioContextPtr, boost::asio::make_strand(*ioContextPtr), inputIntervalMs
+    ) {}
+
+ServerShard::~ServerShard() {
+  stop();
+}
+
+bool ServerShard::start() {
+#if defined(__linux__) || defined(__APPLE__)
+  try {
+    const tcp::endpoint endpoint(tcp::v4(), C::RTSP_RTP_TCP_PORT);
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(tcp::acceptor::reuse_address(true));
+    // every shard binds the same port. the kernel spreads new connections over them.
+    acceptor.set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+    acceptor.bind(endpoint);
+    acceptor.listen();
+  } catch (const std::exception& e) {
+    logger->severe("Dongvin, failed to open SO_REUSEPORT acceptor! shard : " + std::to_string(shardIdx));
+    std::cerr << e.what() << "\n";
+    return false;
+  }
+
+  removeClosedSessionTask.setTask([this](){
+    sessionRegistry.clearRetired();
+  });
+  removeClosedSessionTask.start();
+
+  boost::asio::post(*ioContextPtr, [weakSelf = weak_from_this()](){
+    if (auto self = weakSelf.lock()) self->asyncAccept();
+  });
+  return true;
+#else
+  logger->warning("Dongvin, SO_REUSEPORT shards are supported on linux and macOS only.");
+  return false;
+#endif
+}
+
+void ServerShard::stop() {
+  removeClosedSessionTask.stop();
+  boost::system::error_code ignored_error;
+  acceptor.close(ignored_error);
+
+  try {
+    for (auto& sessionPtr : sessionRegistry.snapshot()) {
+      sessionPtr->recordBitrateTestResult();
+    }
+  } catch (const std::exception& e) {
+    logger->severe("Dongvin, exception while stopping shard : " + std::to_string(shardIdx));
+    std::cerr << e.what() << "\n";
+  }
+  sessionRegistry.clear();
+}
+
+bool ServerShard::retireSession(const std::string& sessionId) {
+  if (!sessionRegistry.retire(sessionId)) return false;
+  logger->warning(
+    "Dongvin, " + sessionId + " shuts down. shard : " + std::to_string(shardIdx)
+    + ", remaining session cnt of shard : " + std::to_string(sessionRegistry.getLiveSessionCnt())
+  );
+  return true;
+}
+
+const SessionRegistry& ServerShard::getSessionRegistry() const {
+  return sessionRegistry;
+}
+
+void ServerShard::asyncAccept() {
+  // stopped before the posted first accept ran.
+  if (!acceptor.is_open()) return;
+  auto socketPtr = std::make_shared<tcp::socket>(*ioContextPtr);
+  auto self = shared_from_this();
+  acceptor.async_accept(*socketPtr, [this, self, socketPtr](const boost::system::error_code& error) {
+    if (error == boost::asio::error::operation_aborted || !acceptor.is_open()) {
+      return;
+    }
+    if (error) {
+      logger->severe("Dongvin, accept failed. shard : " + std::to_string(shardIdx) + ", " + error.message());
+    } else {
+      // the shard's io_context is both the main and the worker io_context of the session.
+      std::shared_ptr<Session> sessionPtr = server.createSession(*ioContextPtr, ioContextPtr, socketPtr);
+      const std::string sessionId = sessionPtr->getSessionId();
+      sessionRegistry.add(sessionId, std::move(sessionPtr));
+      logger->warning(
+        "Dongvin, new client arrives, id: " + sessionId + ", shard : " + std::to_string(shardIdx)
+        + ", number of clients in shard : " + std::to_string(sessionRegistry.getLiveSessionCnt())
+      );
+    }
+    asyncAccept();
+  });
+}
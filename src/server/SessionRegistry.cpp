@@ -0,0 +1,100 @@
+#include "../include/SessionRegistry.h"
+
+#include <algorithm>
+#include <functional>
+
+void SessionRegistry::add(const std::string& sessionId, std::shared_ptr<Session> sessionPtr) {
+  Bucket& bucket = getBucket(sessionId);
+  std::lock_guard<std::mutex> guard(bucket.lock);
+  if (bucket.liveSessions.insert_or_assign(sessionId, std::move(sessionPtr)).second) {
+    liveSessionCnt.fetch_add(1, std::memory_order_relaxed);
+    totalAddedCnt.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+std::shared_ptr<Session> SessionRegistry::find(const std::string& sessionId) const {
+  const Bucket& bucket = getBucket(sessionId);
+  std::lock_guard<std::mutex> guard(bucket.lock);
+  const auto it = bucket.liveSessions.find(sessionId);
+  return it == bucket.liveSessions.end() ? nullptr : it->second;
+}
+
+bool SessionRegistry::retire(const std::string& sessionId) {
+  Bucket& bucket = getBucket(sessionId);
+  std::lock_guard<std::mutex> guard(bucket.lock);
+  const auto it = bucket.liveSessions.find(sessionId);
+  if (it == bucket.liveSessions.end()) return false;
+
+  bucket.retiredSessions.insert_or_assign(sessionId, std::move(it->second));
+  bucket.liveSessions.erase(it);
+  liveSessionCnt.fetch_sub(1, std::memory_order_relaxed);
+  retiredSessionCnt.fetch_add(1, std::memory_order_relaxed);
+  totalRetiredCnt.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+size_t SessionRegistry::clearRetired() {
+  size_t clearedCnt = 0;
+  for (Bucket& bucket : buckets) {
+    // destroy sessions outside of the lock. ~Session() may take a while.
+    std::unordered_map<std::string, std::shared_ptr<Session>> retiredSessions;
+    {
+      std::lock_guard<std::mutex> guard(bucket.lock);
+      retiredSessions.swap(bucket.retiredSessions);
+    }
+    clearedCnt += retiredSessions.size();
+  }
+  retiredSessionCnt.fetch_sub(static_cast<int64_t>(clearedCnt), std::memory_order_relaxed);
+  return clearedCnt;
+}
+
+std::vector<std::shared_ptr<Session>> SessionRegistry::snapshot() const {
+  std::array<std::unique_lock<std::mutex>, C::SESSION_REGISTRY_BUCKET_CNT> guards;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    guards[i] = std::unique_lock<std::mutex>(buckets[i].lock);
+  }
+
+  std::vector<std::shared_ptr<Session>> sessions;
+  sessions.reserve(static_cast<size_t>(std::max<int64_t>(liveSessionCnt.load(std::memory_order_relaxed), 0)));
+  for (const Bucket& bucket : buckets) {
+    for (const auto& kvPair : bucket.liveSessions) {
+      sessions.push_back(kvPair.second);
+    }
+  }
+  return sessions;
+}
+
+SessionRegistryStats SessionRegistry::getStats() const {
+  SessionRegistryStats stats;
+  stats.liveSessionCnt = liveSessionCnt.load(std::memory_order_relaxed);
+  stats.retiredSessionCnt = retiredSessionCnt.load(std::memory_order_relaxed);
+  stats.totalAddedCnt = totalAddedCnt.load(std::memory_order_relaxed);
+  stats.totalRetiredCnt = totalRetiredCnt.load(std::memory_order_relaxed);
+  return stats;
+}
+
+int64_t SessionRegistry::getLiveSessionCnt() const {
+  return liveSessionCnt.load(std::memory_order_relaxed);
+}
+
+void SessionRegistry::clear() {
+  for (Bucket& bucket : buckets) {
+    std::unordered_map<std::string, std::shared_ptr<Session>> liveSessions;
+    std::unordered_map<std::string, std::shared_ptr<Session>> retiredSessions;
+    {
+      std::lock_guard<std::mutex> guard(bucket.lock);
+      liveSessions.swap(bucket.liveSessions);
+      retiredSessions.swap(bucket.retiredSessions);
+    }
+    liveSessionCnt.fetch_sub(static_cast<int64_t>(liveSessions.size()), std::memory_order_relaxed);
+    retiredSessionCnt.fetch_sub(static_cast<int64_t>(retiredSessions.size()), std::memory_order_relaxed);
+  }
+}
+
+SessionRegistry::Bucket& SessionRegistry::getBucket(const std::string& sessionId) {
+  return buckets[std::hash<std::string>{}(sessionId) % buckets.size()];
+}
+
+const SessionRegistry::Bucket& SessionRegistry::getBucket(const std::string& sessionId) const {
+  return buckets[std::hash<std::string>{}(sessionId) % buckets.size()];
+}
@@ -0,0 +1,260 @@
+#include "../include/BlockCache.h"
+#include "../../../constants/C.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#if defined(__linux__) || defined(__APPLE__)
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <cstdlib>
+#endif
+
+BlockCache::BlockCache(int64_t inputCapacityBytes, int64_t inputBlockSize)
+  : logger(Logger::getLogger(C::BLOCK_CACHE)),
+    capacityBytes(inputCapacityBytes),
+    blockSize(inputBlockSize) {}
+
+BlockCache::~BlockCache() {
+  shutdown();
+}
+
+BlockCache::FileHandle::~FileHandle() {
+#if defined(__linux__) || defined(__APPLE__)
+  if (fd != -1) ::close(fd);
+#endif
+}
+
+void BlockCache::AlignedDeleter::operator()(unsigned char* ptr) const noexcept {
+#if defined(__linux__) || defined(__APPLE__)
+  std::free(ptr);
+#endif
+}
+
+bool BlockCache::read(const std::string& filePath, int64_t offset, int64_t len, unsigned char* dst) noexcept {
+  if (len <= 0) return true;
+  try {
+    const int64_t firstBlockIdx = offset / blockSize;
+    const int64_t lastBlockIdx = (offset + len - 1) / blockSize;
+    int64_t copied = 0;
+    for (int64_t blockIdx = firstBlockIdx; blockIdx <= lastBlockIdx; ++blockIdx) {
+      const std::shared_ptr<Block> blockPtr = getBlock(filePath, blockIdx);
+      if (blockPtr == nullptr) return false;
+
+      const int64_t blockStart = blockIdx * blockSize;
+      const int64_t from = std::max(offset, blockStart) - blockStart;
+      const int64_t to = std::min(offset + len, blockStart + blockPtr->validLen) - blockStart;
+      if (to <= from) {
+        // requested range is over the end of the file.
+        return false;
+      }
+      std::memcpy(dst + copied, blockPtr->data.get() + from, to - from);
+      copied += (to - from);
+    }
+    return copied == len;
+  } catch (const std::exception& e) {
+    logger->severe("Dongvin, exception while reading block cache! file : " + filePath);
+    std::cerr << e.what() << "\n";
+    return false;
+  }
+}
+
+void BlockCache::updatePlaybackWindow(
+  const std::string& sessionId, const std::string& filePath, int64_t beginOffset, int64_t endOffset
+) {
+  std::lock_guard<std::mutex> guard(lock);
+  std::vector<PlaybackWindow>& windows = sessionWindows[sessionId];
+  PlaybackWindow newWindow{filePath, beginOffset / blockSize, std::max(beginOffset, endOffset) / blockSize};
+  for (PlaybackWindow& window : windows) {
+    if (window.filePath == filePath) {
+      window = std::move(newWindow);
+      return;
+    }
+  }
+  windows.push_back(std::move(newWindow));
+}
+
+void BlockCache::removeSession(const std::string& sessionId) {
+  std::lock_guard<std::mutex> guard(lock);
+  sessionWindows.erase(sessionId);
+}
+
+void BlockCache::invalidate(const std::string& dirPath) {
+  const std::string prefix = (std::filesystem::path(dirPath) / "").string();
+  std::lock_guard<std::mutex> guard(lock);
+  for (auto it = files.begin(); it != files.end();) {
+    if (it->first.rfind(prefix, 0) != 0) {
+      ++it;
+      continue;
+    }
+    // the fd is closed once the running reads of the old file end.
+    cachedBytes -= static_cast<int64_t>(it->second.blocks.size()) * blockSize;
+    it = files.erase(it);
+  }
+}
+
+std::string BlockCache::getStats() {
+  int64_t bytes = 0;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    bytes = cachedBytes;
+  }
+  return "cached bytes: " + std::to_string(bytes)
+    + ", hit: " + std::to_string(hitCnt.load())
+    + ", miss: " + std::to_string(missCnt.load())
+    + ", evicted: " + std::to_string(evictedCnt.load());
+}
+
+void BlockCache::shutdown() {
+  std::lock_guard<std::mutex> guard(lock);
+  // fds are closed by the last reader.
+  files.clear();
+  sessionWindows.clear();
+  cachedBytes = 0;
+}
+
+std::shared_ptr<BlockCache::Block> BlockCache::getBlock(const std::string& filePath, int64_t blockIdx) {
+  std::shared_ptr<FileHandle> fileHandlePtr = nullptr;
+  uint64_t generation = 0;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    FileEntry* entry = getFileEntry(filePath);
+    if (entry == nullptr) return nullptr;
+    fileHandlePtr = entry->fileHandlePtr;
+    generation = entry->generation;
+
+    auto& blocks = entry->blocks;
+    if (auto it = blocks.find(blockIdx); it != blocks.end()) {
+      it->second->lastAccessTick = ++accessTick;
+      hitCnt.fetch_add(1, std::memory_order_relaxed);
+      return it->second;
+    }
+  }
+
+  // read from the disk without holding the lock.
+  missCnt.fetch_add(1, std::memory_order_relaxed);
+  std::shared_ptr<Block> newBlockPtr = loadBlock(fileHandlePtr->fd, blockIdx);
+  if (newBlockPtr == nullptr) return nullptr;
+
+  std::lock_guard<std::mutex> guard(lock);
+  auto fileIt = files.find(filePath);
+  // invalidated or shut down while reading. the block may be of the replaced file, so it is not cached.
+  if (fileIt == files.end() || fileIt->second.generation != generation) return newBlockPtr;
+
+  // other session may have loaded the same block in the meantime.
+  auto [it, inserted] = fileIt->second.blocks.try_emplace(blockIdx, newBlockPtr);
+  it->second->lastAccessTick = ++accessTick;
+  if (inserted) {
+    cachedBytes += blockSize;
+    evictIfNeeded();
+  }
+  return it->second;
+}
+
+std::shared_ptr<BlockCache::Block> BlockCache::loadBlock(int fd, int64_t blockIdx) {
+#if defined(__linux__) || defined(__APPLE__)
+  void* rawPtr = nullptr;
+  if (posix_memalign(&rawPtr, C::DIRECT_IO_ALIGNMENT, static_cast<size_t>(blockSize)) != 0) {
+    logger->severe("Dongvin, failed to allocate aligned buffer for block cache!");
+    return nullptr;
+  }
+  auto blockPtr = std::make_shared<Block>();
+  blockPtr->data.reset(static_cast<unsigned char*>(rawPtr));
+
+  // O_DIRECT needs aligned offset, length, and buffer. one read of the whole block.
+  // a short read is the end of the file. a follow-up read would be unaligned and fail with EINVAL.
+  ssize_t readCnt = -1;
+  do {
+    readCnt = ::pread(fd, blockPtr->data.get(), static_cast<size_t>(blockSize), static_cast<off_t>(blockIdx * blockSize));
+  } while (readCnt < 0 && errno == EINTR);
+  if (readCnt < 0) {
+    logger->severe("Dongvin, pread failed on block cache! block idx : " + std::to_string(blockIdx));
+    return nullptr;
+  }
+  blockPtr->validLen = readCnt;
+  return blockPtr;
+#else
+  return nullptr;
+#endif
+}
+
+BlockCache::FileEntry* BlockCache::getFileEntry(const std::string& filePath) {
+  // lock must be held by the caller.
+  if (auto it = files.find(filePath); it != files.end()) return &it->second;
+
+  int fd = -1;
+#if defined(__linux__)
+  fd = ::open(filePath.c_str(), O_RDONLY | O_DIRECT);
+  if (fd == -1) {
+    // some file systems(tmpfs, ...) do not support O_DIRECT.
+    logger->warning("Dongvin, O_DIRECT is not supported. open without it. file : " + filePath);
+    fd = ::open(filePath.c_str(), O_RDONLY);
+  }
+#elif defined(__APPLE__)
+  fd = ::open(filePath.c_str(), O_RDONLY);
+  if (fd != -1) fcntl(fd, F_NOCACHE, 1);
+#endif
+
+  if (fd == -1) {
+    logger->severe("Dongvin, failed to open file for block cache! file : " + filePath);
+    return nullptr;
+  }
+  FileEntry& entry = files[filePath];
+  entry.fileHandlePtr = std::make_shared<FileHandle>(fd);
+  entry.generation = ++lastGeneration;
+  return &entry;
+}
+
+void BlockCache::evictIfNeeded() {
+  // lock must be held by the caller.
+  if (cachedBytes <= capacityBytes) return;
+
+  // evict down to the low water mark at once to amortize the scanning cost.
+  const int64_t lowWaterMark = capacityBytes / 10 * 9;
+
+  std::unordered_map<std::string, std::vector<std::pair<int64_t, int64_t>>> neededRanges;
+  for (const auto& [sessionId, windows] : sessionWindows) {
+    for (const PlaybackWindow& window : windows) {
+      neededRanges[window.filePath].emplace_back(window.beginBlockIdx, window.endBlockIdx);
+    }
+  }
+
+  struct Candidate {
+    bool isNeeded;
+    uint64_t lastAccessTick;
+    FileEntry* entry;
+    int64_t blockIdx;
+  };
+  std::vector<Candidate> candidates;
+  for (auto& [filePath, entry] : files) {
+    const auto rangeIt = neededRanges.find(filePath);
+    for (const auto& [blockIdx, blockPtr] : entry.blocks) {
+      bool isNeeded = false;
+      if (rangeIt != neededRanges.end()) {
+        for (const auto& [beginIdx, endIdx] : rangeIt->second) {
+          if (blockIdx >= beginIdx && blockIdx <= endIdx) {
+            isNeeded = true;
+            break;
+          }
+        }
+      }
+      candidates.push_back({isNeeded, blockPtr->lastAccessTick, &entry, blockIdx});
+    }
+  }
+
+  // blocks outside every playback window go first, then the least recently used ones.
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate& lhs, const Candidate& rhs) {
+    if (lhs.isNeeded != rhs.isNeeded) return !lhs.isNeeded;
+    return lhs.lastAccessTick < rhs.lastAccessTick;
+  });
+
+  for (const Candidate& candidate : candidates) {
+    if (cachedBytes <= lowWaterMark) break;
+    candidate.entry->blocks.erase(candidate.blockIdx);
+    cachedBytes -= blockSize;
+    evictedCnt.fetch_add(1, std::memory_order_relaxed);
+  }
+}
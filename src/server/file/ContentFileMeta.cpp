@@ -16,24 +16,36 @@ ContentFileMeta::ContentFileMeta(ContentFileMeta && other) noexcept
   : logger(std::move(other.logger)),
     cidDirectory(other.cidDirectory),
     configFile(other.configFile),
+    contentTitle(std::move(other.contentTitle)),
     audioFile(std::move(other.audioFile)),
     videoFiles(std::move(other.videoFiles)),
+    refCamDirName(std::move(other.refCamDirName)),
+    mbpsTypeList(std::move(other.mbpsTypeList)),
+    refVideoRtpHeads(std::move(other.refVideoRtpHeads)),
+    audioRtpHeads(std::move(other.audioRtpHeads)),
     rtspSdpMessage(other.rtspSdpMessage),
     rtpInfo(other.rtpInfo),
-    v0Images(std::move(other.v0Images)) {
+    v0Images(std::move(other.v0Images)),
+    preRenderedSdp(std::move(other.preRenderedSdp)),
+    accData(std::move(other.accData)),
+    v0ImageData(std::move(other.v0ImageData)) {
   other.shutdown();
 }
 
 int ContentFileMeta::getNumberOfCamDirectories() const {
+  // every bitrate variant has the same cams.
+  if (!mbpsTypeList.empty()) {
+    return static_cast<int>(videoFiles.size() / mbpsTypeList.size());
+  }
   return static_cast<int>(videoFiles.size());
 }
 
 int ContentFileMeta::getRefVideoSampleCnt() const {
   // return cam 0's V1 video files sample cnt
-  if (videoFiles.find(C::REF_CAM) == videoFiles.end()) {
+  if (videoFiles.find(refCamDirName) == videoFiles.end()) {
     throw std::runtime_error("ref cam directory not initialized!");
   }
-  return static_cast<int>(videoFiles.at(C::REF_CAM).getConstVideoSampleInfoList()[0].size());
+  return static_cast<int>(videoFiles.at(refCamDirName).getConstVideoSampleInfoList()[0].size());
 }
 
 bool ContentFileMeta::init() {
@@ -42,12 +54,33 @@ bool ContentFileMeta::init() {
     return false;
   }
 
-  bool initResult = handleCamDirectories(cidDirectory);
+  // sample size trailers are read from the index sidecar if it is still valid.
+  indexSidecarPtr = std::make_unique<ContentIndexSidecar>(cidDirectory);
+  const bool isSidecarLoaded = indexSidecarPtr->load();
+
+  bool initResult = handleCamDirectories(cidDirectory) && initMbpsTypeList();
   if (!initResult) {
+    indexSidecarPtr.reset();
     logger->severe("Invalid cam directories! Content name : " + contentTitle);
     return false;
   }
 
+  if (indexSidecarPtr->needSave()) {
+    if (indexSidecarPtr->save()) {
+      logger->info("Dongvin, index sidecar was " + std::string(isSidecarLoaded ? "updated" : "created") + ". id : " + contentTitle);
+    }
+  } else {
+    logger->info("Dongvin, loaded from index sidecar. id : " + contentTitle);
+  }
+  // video sample infos were built. mapped sidecar is not needed anymore.
+  indexSidecarPtr.reset();
+
+  initResult = renderDescribeSdp();
+  if (!initResult) {
+    logger->severe("Invalid SDP in rtsp config! Content name : " + contentTitle);
+    return false;
+  }
+
   initResult = handleConfigFile(cidDirectory);
   if (!initResult) {
     logger->severe("Invalid SDP config! Content name : " + contentTitle);
@@ -90,16 +123,16 @@ RtpInfo ContentFileMeta::getRtpInfoCopy() {
 std::string ContentFileMeta::getMediaInfoCopy() {
   return rtspSdpMessage;
 }
-std::vector<unsigned char> ContentFileMeta::getAccDataCopy() {
-  return Util::readAllBytesFromFilePath(configFile);
+std::shared_ptr<const PreRenderedSdp> ContentFileMeta::getPreRenderedSdp() const {
+  return preRenderedSdp;
 }
 
-std::vector<std::vector<unsigned char>> ContentFileMeta::getAllV0ImagesCopy() {
-  std::vector<std::vector<unsigned char>> imageBinaryList;
-  for (std::filesystem::path& imageFilePath : v0Images) {
-    imageBinaryList.push_back(Util::readAllBytesFromFilePath(imageFilePath));
-  }
-  return imageBinaryList;
+std::shared_ptr<const std::vector<unsigned char>> ContentFileMeta::getAccData() const {
+  return accData;
+}
+
+std::shared_ptr<const std::vector<std::vector<unsigned char>>> ContentFileMeta::getAllV0Images() const {
+  return v0ImageData;
 }
 
 int ContentFileMeta::getAudioSampleSize() const {
@@ -107,15 +140,9 @@ int ContentFileMeta::getAudioSampleSize() const {
 }
 
 int ContentFileMeta::getVideoSampleSize() const {
-  if (videoFiles.find(C::REF_CAM) != videoFiles.end()) {
-    return static_cast<int>(videoFiles.at(C::REF_CAM).getConstVideoSampleInfoList()[0].size());
-  } else {
-    // adaptive bitrate supporting case
-    for (const std::string& possibleRefCam : C::ADAPTIVE_BITRATE_REF_CAM_LIST) {
-      if (videoFiles.find(possibleRefCam) != videoFiles.end()) {
-        return static_cast<int>(videoFiles.at(possibleRefCam).getConstVideoSampleInfoList()[0].size());
-      }
-    }
+  // cam0, or cam0 of the highest bitrate in adaptive bitrate supporting case
+  if (videoFiles.find(refCamDirName) != videoFiles.end()) {
+    return static_cast<int>(videoFiles.at(refCamDirName).getConstVideoSampleInfoList()[0].size());
   }
   return C::INVALID;
 }
@@ -128,6 +155,36 @@ const std::unordered_map<std::string, VideoAccess>& ContentFileMeta::getConstVid
   return videoFiles;
 }
 
+const std::vector<int>& ContentFileMeta::getMbpsTypeList() const {
+  return mbpsTypeList;
+}
+
+const std::string& ContentFileMeta::getRefCamDirName() const {
+  return refCamDirName;
+}
+
+const VideoAccess* ContentFileMeta::findVideoAccess(int camId, int mbps) const {
+  const auto iter = videoFiles.find(getCamDirName(camId, mbps));
+  return iter == videoFiles.end() ? nullptr : &iter->second;
+}
+
+std::string ContentFileMeta::getCamDirName(int camId, int mbps) {
+  std::string camDirName = C::CAM_DIR_PREFIX + std::to_string(camId);
+  if (mbps != C::INVALID) {
+    camDirName += C::ADAPTIVE_BITRATE_DIR_DELIMITER + std::to_string(mbps) + C::ADAPTIVE_BITRATE_MBPS_SUFFIX;
+  }
+  return camDirName;
+}
+
+bool ContentFileMeta::getFirstRtpHead(int streamId, int sampleNo, SampleRtpHead& outRtpHead) const {
+  const std::vector<SampleRtpHead>& rtpHeads = streamId == C::VIDEO_ID ? refVideoRtpHeads : audioRtpHeads;
+  if (sampleNo < 0 || sampleNo >= static_cast<int>(rtpHeads.size()) || !rtpHeads[sampleNo].isValid) {
+    return false;
+  }
+  outRtpHead = rtpHeads[sampleNo];
+  return true;
+}
+
 bool ContentFileMeta::handleCamDirectories(const std::filesystem::path &inputCidDirectory) {
   std::vector<std::filesystem::path> camDirectoryList;
   for (std::filesystem::path camDirectory : std::filesystem::directory_iterator(inputCidDirectory)) {
@@ -141,14 +198,93 @@ bool ContentFileMeta::handleCamDirectories(const std::filesystem::path &inputCid
     }
   );
 
+  std::vector<std::filesystem::path> refCamDirectoryList;
+  std::vector<std::filesystem::path> memberCamDirectoryList;
   for (std::filesystem::path camDirectory : camDirectoryList) {
     if (!is_directory(camDirectory)) continue;
     if (camDirectory.filename() == C::HYBRID_META_DIR) continue;
+    if (isRefCamDirectory(camDirectory.filename().string())) {
+      refCamDirectoryList.push_back(camDirectory);
+    } else {
+      memberCamDirectoryList.push_back(camDirectory);
+    }
+  }
+
+  // ref cam goes first. member cams need gop value in its config file.
+  for (const std::filesystem::path& camDirectory : refCamDirectoryList) {
     bool result = loadStreamFilesInCamDirectories(camDirectory);
     if (!result) {
       return false;
     }
   }
+
+  // one after another. contents are loaded in parallel on the bounded loading pool already.
+  for (const std::filesystem::path& camDirectory : memberCamDirectoryList) {
+    bool result = loadStreamFilesInCamDirectories(camDirectory);
+    if (!result) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ContentFileMeta::isRefCamDirectory(const std::string& camDirectoryName) {
+  return camDirectoryName == C::REF_CAM ||
+    C::ADAPTIVE_BITRATE_REF_CAM_LIST.at(0).find(camDirectoryName) != std::string::npos;
+}
+
+int ContentFileMeta::parseMbps(const std::string& camDirectoryName) {
+  const size_t delimiterPos = camDirectoryName.rfind(C::ADAPTIVE_BITRATE_DIR_DELIMITER);
+  if (
+    delimiterPos == std::string::npos
+    || camDirectoryName.back() != C::ADAPTIVE_BITRATE_MBPS_SUFFIX
+    || camDirectoryName.size() < delimiterPos + 3
+  ) {
+    return C::INVALID;
+  }
+  int mbps = C::INVALID;
+  const std::string_view mbpsView(camDirectoryName.data() + delimiterPos + 1, camDirectoryName.size() - delimiterPos - 2);
+  if (!Util::parseNumber(mbpsView, mbps) || mbps <= 0) return C::INVALID;
+  return mbps;
+}
+
+bool ContentFileMeta::initMbpsTypeList() {
+  std::vector<int> mbpsList;
+  for (const auto& [camDirName, videoAccess] : videoFiles) {
+    const int mbps = parseMbps(camDirName);
+    if (mbps != C::INVALID && std::find(mbpsList.begin(), mbpsList.end(), mbps) == mbpsList.end()) {
+      mbpsList.push_back(mbps);
+    }
+  }
+  if (mbpsList.empty()) return true; // no bitrate variant
+
+  std::sort(mbpsList.begin(), mbpsList.end(), std::greater<>());
+  if (getCamDirName(C::ZERO, mbpsList.front()) != refCamDirName) {
+    logger->severe("Dongvin, ref cam must be cam0 of the highest bitrate! ref cam : " + refCamDirName);
+    return false;
+  }
+
+  // every variant must have the same cams and the same samples, so that the session can switch on any key frame.
+  const size_t camCnt = videoFiles.size() / mbpsList.size();
+  const size_t refSampleCnt = videoFiles.at(refCamDirName).getConstVideoSampleInfoList()[0].size();
+  bool isValid = camCnt * mbpsList.size() == videoFiles.size();
+  for (int mbps : mbpsList) {
+    for (int camId = 0; isValid && camId < static_cast<int>(camCnt); ++camId) {
+      const VideoAccess* videoAccessPtr = findVideoAccess(camId, mbps);
+      isValid = videoAccessPtr != nullptr
+        && videoAccessPtr->getConstVideoSampleInfoList().size() > C::REAR_VIDEO_VID
+        && videoAccessPtr->getConstVideoSampleInfoList()[0].size() == refSampleCnt;
+    }
+  }
+  if (!isValid) {
+    logger->severe("Dongvin, bitrate variant cam directories do not match each other! : " + contentTitle);
+    return false;
+  }
+
+  std::string mbpsStr;
+  for (int mbps : mbpsList) mbpsStr += std::to_string(mbps) + "m ";
+  logger->info("Dongvin, id : " + contentTitle + ", bitrate variants : " + mbpsStr);
+  mbpsTypeList = std::move(mbpsList);
   return true;
 }
 
@@ -157,27 +293,99 @@ bool ContentFileMeta::handleConfigFile(const std::filesystem::path &inputCidDire
     if (!is_directory(dir) && dir.filename().string().find("acc") != std::string::npos) {
       // std::filesystem::path type is 'Copyable'!!
       configFile = dir;
+      accData = std::make_shared<const std::vector<unsigned char>>(Util::readAllBytesFromFilePath(configFile));
       return true;
     }
   }
   return false;
 }
 
+bool ContentFileMeta::renderDescribeSdp() {
+  const auto unitCntIter = rtpInfo.kv.find(C::FRAME_COUNT_KEY);
+  const auto gopIter = rtpInfo.kv.find(C::GOP_KEY);
+  if (unitCntIter == rtpInfo.kv.end() || unitCntIter->second.size() <= C::AUDIO_ID
+      || gopIter == rtpInfo.kv.end() || gopIter->second.empty()) {
+    logger->severe("Dongvin, no frame count or gop in rtsp config! : " + contentTitle);
+    return false;
+  }
+  const std::vector<int64_t>& unitCnt = unitCntIter->second;
+  const std::vector<int64_t>& gop = gopIter->second;
+
+  auto rendered = std::make_shared<PreRenderedSdp>();
+  std::vector<std::string> lines = Util::splitToVecByString(rtspSdpMessage, C::CRLF);
+  try {
+    for (auto i = 0; i < lines.size(); ++i) {
+      const std::string line = lines[i];
+      if (line == C::EMPTY_STRING) continue;
+
+      if (line.rfind("c=", 0) == 0) {
+        lines[i] = "c=IN IP4 0.0.0.0"; // don't need to know ip addr of client
+      } else if (line.rfind("a=control:", 0) == 0){
+        int trackId = std::stoi(Util::splitToVecBySingleChar(line, '=')[2]);
+        std::string track = "/trackID="+std::to_string(trackId);
+        lines[i] = "a=control:"+std::string{C::DUMMY_CONTENT_BASE}+track;
+        if(trackId <= C::AUDIO_ID){
+          rendered->trackUrlSuffixes.emplace_back(trackId, track);
+        }
+      } else if (line.rfind("AS", 0) == 0){ // application specific for bandwidth.
+        lines[i] = C::EMPTY_STRING;
+      } else if (line.rfind("a=tool:", 0) == 0) {
+        lines[i] = C::EMPTY_STRING;
+      } else if (line.rfind("a=fmtp:", 0) == 0) {
+        if(Util::trim( Util::splitToVecBySingleChar(line, ':')[1] ).rfind("97", 0) == 0){ // audio
+          // refer to Table 9 (streamType Values) in ISO/IEC 14496-1 (coding of audio-visual objects)
+          lines[i] +=";streamType=5";
+          lines[i] += ";ucnt="+std::to_string(unitCnt[1]);
+        } else if (Util::trim( Util::splitToVecBySingleChar(line, ':')[1] ).rfind("96", 0) == 0){ // video
+          // refer to Table 9 (streamType Values) in ISO/IEC 14496-1 (coding of audio-visual objects)
+          lines[i] +=";streamType=4";
+          lines[i] += ";dGop="+std::to_string(gop[0]);
+          lines[i] += ";ucnt="+std::to_string(unitCnt[0]);
+        }
+      } else if (line.rfind("b=AS:", 0) == 0) {
+        // bitrate of the first play.
+        rendered->kbpsBitrate += std::stoi(Util::splitToVecBySingleChar(line, ':')[1]);
+      }
+    }//for
+  } catch (const std::exception& e) {
+    logger->severe("Dongvin, failed to render SDP! : " + contentTitle);
+    std::cerr << e.what() << "\n";
+    return false;
+  }
+
+  for (const std::string& line : lines) {
+    if (line == C::EMPTY_STRING) {
+      continue;
+    }
+    rendered->sdp += (line + std::string{C::CRLF});
+  }
+  preRenderedSdp = std::move(rendered);
+  return true;
+}
+
 bool ContentFileMeta::handleV0Images(const std::filesystem::path &inputCidDirectory) {
   for (std::filesystem::path dir : std::filesystem::directory_iterator(inputCidDirectory)) {
     if (!is_directory(dir) && dir.filename().string().find("jpg") != std::string::npos) {
       v0Images.push_back(dir);
     }
   }
+
+  std::vector<std::vector<unsigned char>> imageBinaryList;
+  imageBinaryList.reserve(v0Images.size());
+  for (const std::filesystem::path& imageFilePath : v0Images) {
+    imageBinaryList.push_back(Util::readAllBytesFromFilePath(imageFilePath));
+  }
+  v0ImageData = std::make_shared<const std::vector<std::vector<unsigned char>>>(std::move(imageBinaryList));
   return !v0Images.empty();
 }
 
 bool ContentFileMeta::loadStreamFilesInCamDirectories(const std::filesystem::path &inputCidDirectory) {
   std::string camDirectoryName = inputCidDirectory.filename().string();
-  bool isRefCam = (
-      camDirectoryName == C::REF_CAM ||
-      C::ADAPTIVE_BITRATE_REF_CAM_LIST.at(0).find(camDirectoryName) != std::string::npos
-    );
+  bool isRefCam = isRefCamDirectory(camDirectoryName);
+  if (isRefCam) {
+    // ref cam is loaded alone, before the member cams.
+    refCamDirName = camDirectoryName;
+  }
 
   std::vector<std::filesystem::path> streamingFileList;
   for (std::filesystem::path camDirectory : std::filesystem::directory_iterator(inputCidDirectory)) {
@@ -283,32 +491,32 @@ std::vector<int64_t> ContentFileMeta::getValues(std::string inputMsg, std::strin
 void ContentFileMeta::loadRtpAudioMetaData(
     const std::filesystem::path &inputAudio, AudioAccess& inputAudioFile
   ) {
-  inputAudioFile.getAccess().open(inputAudio, std::ios::in | std::ios::binary);
-  int64_t audioFileSize = Util::getFileSize(inputAudio);
-  std::vector<unsigned char> metaData = readMetaData(audioFileSize, inputAudioFile.getAccess());
-  std::vector<int16_t> sizes = getSizes(metaData);
+  std::vector<int16_t> ownedSizes;
+  const SampleSizesView sizes = loadSampleSizes(inputAudio, ownedSizes);
 
   int64_t offset = 0;
-  for (const int16_t size : sizes) {
+  std::vector<std::pair<int64_t, int64_t>> sampleRanges;
+  sampleRanges.reserve(sizes.cnt);
+  for (size_t i = 0; i < sizes.cnt; ++i) {
+    const int16_t size = sizes.data[i];
     inputAudioFile.getMeta().emplace_back(size, offset);
+    sampleRanges.emplace_back(offset, size);
     offset += size;
   }
   showAudioMinMaxSize(inputAudioFile.getConstMeta());
-
-  inputAudioFile.getAccess().close();
+  loadSampleRtpHeads(inputAudio, sampleRanges, audioRtpHeads);
 }
 
 void ContentFileMeta::showAudioMinMaxSize(const std::vector<AudioSampleInfo> &audioMetaData) {
-  std::vector<int> lenList;
-  for (auto i = 0; i < audioMetaData.size(); ++i) {
-    AudioSampleInfo aInfo = audioMetaData[i];
+  // single pass. no need to sort just for min and max.
+  int64_t min = INT64_MAX;
+  int64_t max = INT64_MIN;
+  for (const AudioSampleInfo& aInfo : audioMetaData) {
     if (aInfo.len == 0) continue; // dummy info
-    lenList.push_back(aInfo.len);
+    min = std::min<int64_t>(min, aInfo.len);
+    max = std::max<int64_t>(max, aInfo.len);
   }
-  // int sort ascending
-  std::sort(lenList.begin(), lenList.end());
-  int64_t min = lenList[0];
-  int64_t max = lenList[lenList.size() - 1];
+  if (min > max) return;
   logger->info(
     "Dongvin, id : " + contentTitle + ", audio (min, max)=("
     + std::to_string(min) + "," + std::to_string(max) + ")"
@@ -320,66 +528,54 @@ const std::filesystem::path& inputCamDir, std::vector<std::filesystem::path>& vi
 ) {
   VideoAccess va{};
 
-  // open ifstreams for member viedos
+  // member videos in file name order
   std::sort(
     videos.begin(), videos.end(),
     [](const std::filesystem::path& lhs, const std::filesystem::path& rhs) {
       return lhs.filename() < rhs.filename();
     }
   );
-  for (const std::filesystem::path& videoPath : videos) {
-    va.getAccessList().emplace_back(videoPath, std::ios::in | std::ios::binary);
-  }
-
-  // check
-  if (videos.size() != va.getConstAccessList().size()) {
-    throw std::runtime_error("opening video reading ifstreams failed!");
-  }
-  for (auto i = 0; i < videos.size(); ++i) {
-    if (!va.getConstAccessList()[i].is_open()) {
-      throw std::runtime_error("opening video reading ifstreams failed! filename : " + videos[i].filename().string());
-    }
-  }
 
   // open Video Sample meta data
   int memberVideoId = 0;
-  for (std::ifstream& access : va.getAccessList()) {
-    if (access.is_open()) {
-      auto& videoSampleMetaList = va.getVideoSampleInfoList();
-      int64_t videoFileSize = Util::getFileSize(videos.at(memberVideoId));
-      loadRtpMemberVideoMetaData(videoFileSize, access, videoSampleMetaList, memberVideoId);
-      memberVideoId++;
-    } else {
-      logger->severe("Failed to open video reading ifstream!");
-      throw std::runtime_error("Failed to open video reading ifstream!");
+  for (const std::filesystem::path& videoPath : videos) {
+    std::vector<int16_t> ownedSizes;
+    const SampleSizesView sizes = loadSampleSizes(videoPath, ownedSizes);
+    loadRtpMemberVideoMetaData(sizes, va.getVideoSampleInfoList(), memberVideoId);
+
+    // seek and cam switching take timestamps from the front video of cam0.
+    if (memberVideoId == 0 && inputCamDir.filename().string() == refCamDirName) {
+      std::vector<std::pair<int64_t, int64_t>> sampleRanges;
+      sampleRanges.reserve(va.getVideoSampleInfoList().back().size());
+      for (const VideoSampleInfo& sampleInfo : va.getVideoSampleInfoList().back()) {
+        sampleRanges.emplace_back(sampleInfo.getOffset(), sampleInfo.getSize());
+      }
+      loadSampleRtpHeads(videoPath, sampleRanges, refVideoRtpHeads);
     }
+    memberVideoId++;
   }
 
-  // std::ifstream object in VideoAccess should never be user after initializing video sample meta.
-  va.clearAllIFStreams();
   videoFiles.insert({inputCamDir.filename().string(), std::move(va)});
 }
 
 void ContentFileMeta::loadRtpMemberVideoMetaData(
-    int64_t videoFileSize,
-    std::ifstream &inputIfstream,
+    const SampleSizesView& sizes,
     std::vector<std::vector<VideoSampleInfo>>& input2dMetaList,
     int memberId
 ) {
   input2dMetaList.emplace_back();
 
-  std::vector<unsigned char> metaData = readMetaData(videoFileSize, inputIfstream);
-  std::vector<int16_t> sizes = getSizes(metaData);
-
   int sampleCount = 0;
   int64_t offset = 0;
   if (rtpInfo.kv.find(C::GOP_KEY) == rtpInfo.kv.end()) {
     throw std::runtime_error("Failed to find gop key! : loadRtpMemberVideoMetaData");
   }
-  std::vector<int64_t> gops = rtpInfo.kv[C::GOP_KEY];
+  // read only access. member cams are loaded concurrently.
+  const std::vector<int64_t>& gops = rtpInfo.kv.at(C::GOP_KEY);
   int gop = static_cast<int>(gops[0]);
 
-  for (const int16_t size : sizes) { // size must start with -1, refer to transcoder app.
+  for (size_t i = 0; i < sizes.cnt; ++i) { // size must start with -1, refer to transcoder app.
+    const int16_t size = sizes.data[i];
     if (size == C::INVALID) {
       VideoSampleInfo newVSampleInfo{};
       newVSampleInfo.setOffset(offset);
@@ -409,15 +605,15 @@ void ContentFileMeta::loadRtpMemberVideoMetaData(
 void ContentFileMeta::showVideoMinMaxSize(
   const std::vector<VideoSampleInfo> &videoMetaData, int memberId
 ) {
-  std::vector<int> lenList;
-  for (auto i=0; i < videoMetaData.size(); ++i) {
-    VideoSampleInfo vInfo = videoMetaData[i];
+  // single pass. no need to sort just for min and max.
+  int64_t min = INT64_MAX;
+  int64_t max = INT64_MIN;
+  for (const VideoSampleInfo& vInfo : videoMetaData) {
     if (vInfo.getSize()==0) continue; // dummy info
-    lenList.push_back(vInfo.getSize());
+    min = std::min<int64_t>(min, vInfo.getSize());
+    max = std::max<int64_t>(max, vInfo.getSize());
   }
-  std::sort(lenList.begin(), lenList.end());
-  int64_t min = lenList[0];
-  int64_t max = lenList[lenList.size() - 1];
+  if (min > max) return;
   logger->info(
     "Dongvin, id : " + contentTitle + ", memberId: " + std::to_string(memberId)
     + ", video (min, max)=(" + std::to_string(min) + "," + std::to_string(max) + ")"
@@ -432,6 +628,25 @@ std::vector<std::vector<VideoSampleInfo>> ContentFileMeta::getVideoMetaInternal(
   return vMetaList;
 }
 
+SampleSizesView ContentFileMeta::loadSampleSizes(
+  const std::filesystem::path& filePath, std::vector<int16_t>& ownedSizes
+) {
+  SampleSizesView sizes;
+  if (indexSidecarPtr != nullptr && indexSidecarPtr->find(filePath, sizes)) {
+    return sizes;
+  }
+
+  // no valid index. read the size trailer of the file.
+  std::ifstream access(filePath, std::ios::in | std::ios::binary);
+  std::vector<unsigned char> metaData = readMetaData(Util::getFileSize(filePath), access);
+  ownedSizes = getSizes(metaData);
+  if (indexSidecarPtr != nullptr) indexSidecarPtr->add(filePath, ownedSizes);
+
+  sizes.data = ownedSizes.data();
+  sizes.cnt = ownedSizes.size();
+  return sizes;
+}
+
 std::vector<unsigned char> ContentFileMeta::readMetaData(
   int64_t fileSize, std::ifstream &inputFileStream
 ) {
@@ -473,4 +688,61 @@ std::vector<int16_t> ContentFileMeta::getSizes(std::vector<unsigned char>& metaD
   }
 
   return sizes;
-}
\ No newline at end of file
+}
+
+void ContentFileMeta::loadSampleRtpHeads(
+  const std::filesystem::path& filePath,
+  const std::vector<std::pair<int64_t, int64_t>>& sampleRanges,
+  std::vector<SampleRtpHead>& outRtpHeads
+) {
+  SampleRtpHeadsView rtpHeads;
+  if (
+    indexSidecarPtr != nullptr && indexSidecarPtr->findRtpHeads(filePath, rtpHeads)
+    && rtpHeads.cnt == sampleRanges.size()
+  ) {
+    // copied. the mapped sidecar is unmapped after init().
+    outRtpHeads.assign(rtpHeads.data, rtpHeads.data + rtpHeads.cnt);
+    return;
+  }
+
+  outRtpHeads = readSampleRtpHeads(filePath, sampleRanges);
+  if (indexSidecarPtr != nullptr) indexSidecarPtr->addRtpHeads(filePath, outRtpHeads);
+}
+
+std::vector<SampleRtpHead> ContentFileMeta::readSampleRtpHeads(
+  const std::filesystem::path& filePath, const std::vector<std::pair<int64_t, int64_t>>& sampleRanges
+) {
+  // $ | ch | len(2) | v,p,x,cc | m,pt | seq(2) | timestamp(4). big endian.
+  constexpr int64_t HEAD_LEN = C::TCP_RTP_HEAD_LEN + 8;
+  std::vector<SampleRtpHead> rtpHeads(sampleRanges.size());
+  std::ifstream access(filePath, std::ios::in | std::ios::binary);
+  if (!access.is_open()) {
+    logger->severe("Dongvin, failed to open file to read rtp heads! path : " + filePath.string());
+    return rtpHeads;
+  }
+
+  unsigned char head[HEAD_LEN];
+  int failedCnt = 0;
+  for (size_t i = 0; i < sampleRanges.size(); ++i) {
+    const auto& [offset, len] = sampleRanges[i];
+    if (len < HEAD_LEN) continue; // dummy sample
+    access.seekg(offset, std::ios::beg);
+    if (!access.read(reinterpret_cast<std::istream::char_type*>(head), HEAD_LEN)) {
+      access.clear();
+      failedCnt++;
+      continue;
+    }
+    const int base = C::TCP_RTP_HEAD_LEN;
+    rtpHeads[i].seq = static_cast<uint16_t>((head[base + 2] << 8) | head[base + 3]);
+    rtpHeads[i].timestamp = (static_cast<uint32_t>(head[base + 4]) << 24) | (static_cast<uint32_t>(head[base + 5]) << 16)
+      | (static_cast<uint32_t>(head[base + 6]) << 8) | static_cast<uint32_t>(head[base + 7]);
+    rtpHeads[i].isValid = 1;
+  }
+  if (failedCnt > 0) {
+    logger->warning(
+      "Dongvin, failed to read rtp heads of some samples. they are read on demand. cnt : "
+      + std::to_string(failedCnt) + ", path : " + filePath.string()
+    );
+  }
+  return rtpHeads;
+}
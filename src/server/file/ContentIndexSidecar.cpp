@@ -0,0 +1,269 @@
+#include "../include/ContentIndexSidecar.h"
+#include "../../../constants/C.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+  constexpr char MAGIC[4] = {'R', 'S', 'I', 'X'};
+  constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+  constexpr size_t HEADER_LEN = 16;
+  constexpr size_t ENTRY_FIXED_LEN = 32;
+  constexpr char TMP_SUFFIX[] = ".tmp";
+
+  size_t alignTo8(size_t len) {
+    return (len + 7) & ~static_cast<size_t>(7);
+  }
+
+  template <typename T>
+  T readAt(const unsigned char* base, size_t pos) {
+    T value;
+    std::memcpy(&value, base + pos, sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  void writeValue(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void writePadding(std::ofstream& out, size_t len) {
+    static constexpr char ZEROS[8] = {};
+    const size_t padLen = alignTo8(len) - len;
+    if (padLen > 0) out.write(ZEROS, static_cast<std::streamsize>(padLen));
+  }
+}
+
+ContentIndexSidecar::ContentIndexSidecar(const std::filesystem::path& inputContentPath)
+  : logger(Logger::getLogger(C::CONTENT_INDEX_SIDECAR)),
+    contentPath(inputContentPath),
+    sidecarPath(inputContentPath / C::CONTENT_INDEX_SIDECAR_FILE_NAME) {}
+
+ContentIndexSidecar::~ContentIndexSidecar() {
+  // views into the mapped region must be dropped before unmapping.
+  entries.clear();
+  mappedRegionPtr.reset();
+  fileMappingPtr.reset();
+}
+
+bool ContentIndexSidecar::load() {
+  std::error_code ec;
+  const auto sidecarSize = static_cast<size_t>(std::filesystem::file_size(sidecarPath, ec));
+  if (ec || sidecarSize < HEADER_LEN) return false;
+
+  try {
+    fileMappingPtr = std::make_unique<boost::interprocess::file_mapping>(
+      sidecarPath.string().c_str(), boost::interprocess::read_only
+    );
+    mappedRegionPtr = std::make_unique<boost::interprocess::mapped_region>(
+      *fileMappingPtr, boost::interprocess::read_only
+    );
+  } catch (const std::exception& e) {
+    logger->warning("Dongvin, failed to map index sidecar. path : " + sidecarPath.string());
+    std::cerr << e.what() << "\n";
+    return false;
+  }
+
+  const auto* base = static_cast<const unsigned char*>(mappedRegionPtr->get_address());
+  const size_t regionSize = mappedRegionPtr->get_size();
+  if (
+    std::memcmp(base, MAGIC, sizeof(MAGIC)) != 0
+    || readAt<uint32_t>(base, 4) != C::CONTENT_INDEX_SIDECAR_VERSION
+    || readAt<uint32_t>(base, 8) != BYTE_ORDER_MARK
+  ) {
+    logger->warning("Dongvin, index sidecar has other version or byte order. rebuild. path : " + sidecarPath.string());
+    return false;
+  }
+
+  const uint32_t entryCnt = readAt<uint32_t>(base, 12);
+  size_t pos = HEADER_LEN;
+  std::unordered_map<std::string, Entry> loadedEntries;
+  for (uint32_t i = 0; i < entryCnt; ++i) {
+    if (pos + ENTRY_FIXED_LEN > regionSize) return false;
+    const auto pathLen = readAt<uint32_t>(base, pos);
+    const auto sampleCnt = readAt<uint32_t>(base, pos + 4);
+    Entry entry;
+    entry.fileSize = readAt<int64_t>(base, pos + 8);
+    entry.mtime = readAt<int64_t>(base, pos + 16);
+    const auto rtpHeadCnt = readAt<uint32_t>(base, pos + 24);
+    pos += ENTRY_FIXED_LEN;
+
+    if (pos + alignTo8(pathLen) > regionSize) return false;
+    std::string relativePath(reinterpret_cast<const char*>(base + pos), pathLen);
+    pos += alignTo8(pathLen);
+
+    const size_t sizesLen = static_cast<size_t>(sampleCnt) * sizeof(int16_t);
+    if (pos + alignTo8(sizesLen) > regionSize) return false;
+    // 8 bytes aligned. read in place without copying.
+    entry.sizes.data = reinterpret_cast<const int16_t*>(base + pos);
+    entry.sizes.cnt = sampleCnt;
+    pos += alignTo8(sizesLen);
+
+    const size_t rtpHeadsLen = static_cast<size_t>(rtpHeadCnt) * sizeof(SampleRtpHead);
+    if (pos + rtpHeadsLen > regionSize) return false;
+    entry.rtpHeads.data = reinterpret_cast<const SampleRtpHead*>(base + pos);
+    entry.rtpHeads.cnt = rtpHeadCnt;
+    pos += rtpHeadsLen;
+
+    loadedEntries.emplace(std::move(relativePath), std::move(entry));
+  }
+
+  std::lock_guard<std::mutex> guard(lock);
+  entries = std::move(loadedEntries);
+  return true;
+}
+
+bool ContentIndexSidecar::find(const std::filesystem::path& filePath, SampleSizesView& outSizes) {
+  int64_t fileSize;
+  int64_t mtime;
+  if (!getFileStamp(filePath, fileSize, mtime)) return false;
+
+  std::lock_guard<std::mutex> guard(lock);
+  const Entry* entryPtr = findValidEntry(filePath, fileSize, mtime);
+  if (entryPtr == nullptr) return false;
+  outSizes = entryPtr->sizes;
+  return true;
+}
+
+void ContentIndexSidecar::add(const std::filesystem::path& filePath, const std::vector<int16_t>& sizes) {
+  Entry entry;
+  std::error_code ec;
+  entry.fileSize = static_cast<int64_t>(std::filesystem::file_size(filePath, ec));
+  if (ec) return;
+  entry.mtime = getMtime(filePath);
+  entry.ownedSizes = sizes;
+  entry.sizes.data = entry.ownedSizes.data();
+  entry.sizes.cnt = entry.ownedSizes.size();
+
+  std::lock_guard<std::mutex> guard(lock);
+  entries[getRelativePath(filePath)] = std::move(entry);
+  isDirty = true;
+}
+
+bool ContentIndexSidecar::findRtpHeads(const std::filesystem::path& filePath, SampleRtpHeadsView& outRtpHeads) {
+  int64_t fileSize;
+  int64_t mtime;
+  if (!getFileStamp(filePath, fileSize, mtime)) return false;
+
+  std::lock_guard<std::mutex> guard(lock);
+  const Entry* entryPtr = findValidEntry(filePath, fileSize, mtime);
+  if (entryPtr == nullptr || entryPtr->rtpHeads.cnt == 0) return false;
+  outRtpHeads = entryPtr->rtpHeads;
+  return true;
+}
+
+void ContentIndexSidecar::addRtpHeads(const std::filesystem::path& filePath, const std::vector<SampleRtpHead>& rtpHeads) {
+  std::lock_guard<std::mutex> guard(lock);
+  const auto it = entries.find(getRelativePath(filePath));
+  if (it == entries.end()) return;
+  Entry& entry = it->second;
+  entry.ownedRtpHeads = rtpHeads;
+  entry.rtpHeads.data = entry.ownedRtpHeads.data();
+  entry.rtpHeads.cnt = entry.ownedRtpHeads.size();
+  isDirty = true;
+}
+
+bool ContentIndexSidecar::needSave() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return isDirty;
+}
+
+bool ContentIndexSidecar::save() {
+  // write to the temp file and rename. a crash while writing never leaves a broken sidecar.
+  const std::filesystem::path tmpPath = sidecarPath.string() + TMP_SUFFIX;
+  try {
+    std::lock_guard<std::mutex> guard(lock);
+    std::ofstream out(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+      logger->warning("Dongvin, cannot write index sidecar. read only content root? path : " + tmpPath.string());
+      return false;
+    }
+
+    // drop entries of removed files.
+    std::vector<std::pair<const std::string*, const Entry*>> liveEntries;
+    for (const auto& [relativePath, entry] : entries) {
+      if (std::filesystem::exists(contentPath / relativePath)) liveEntries.emplace_back(&relativePath, &entry);
+    }
+
+    out.write(MAGIC, sizeof(MAGIC));
+    writeValue<uint32_t>(out, C::CONTENT_INDEX_SIDECAR_VERSION);
+    writeValue<uint32_t>(out, BYTE_ORDER_MARK);
+    writeValue<uint32_t>(out, static_cast<uint32_t>(liveEntries.size()));
+    for (const auto& [relativePathPtr, entryPtr] : liveEntries) {
+      const std::string& relativePath = *relativePathPtr;
+      const Entry& entry = *entryPtr;
+      writeValue<uint32_t>(out, static_cast<uint32_t>(relativePath.size()));
+      writeValue<uint32_t>(out, static_cast<uint32_t>(entry.sizes.cnt));
+      writeValue<int64_t>(out, entry.fileSize);
+      writeValue<int64_t>(out, entry.mtime);
+      writeValue<uint32_t>(out, static_cast<uint32_t>(entry.rtpHeads.cnt));
+      writeValue<uint32_t>(out, 0);
+      out.write(relativePath.data(), static_cast<std::streamsize>(relativePath.size()));
+      writePadding(out, relativePath.size());
+      const size_t sizesLen = entry.sizes.cnt * sizeof(int16_t);
+      out.write(reinterpret_cast<const char*>(entry.sizes.data), static_cast<std::streamsize>(sizesLen));
+      writePadding(out, sizesLen);
+      out.write(
+        reinterpret_cast<const char*>(entry.rtpHeads.data),
+        static_cast<std::streamsize>(entry.rtpHeads.cnt * sizeof(SampleRtpHead))
+      );
+    }
+    out.close();
+    if (!out) throw std::runtime_error("failed to write " + tmpPath.string());
+
+    // windows cannot replace a mapped file. entries do not point into the region after this.
+    for (auto& [relativePath, entry] : entries) {
+      if (entry.ownedSizes.empty() && entry.sizes.cnt > 0) {
+        entry.ownedSizes.assign(entry.sizes.data, entry.sizes.data + entry.sizes.cnt);
+        entry.sizes.data = entry.ownedSizes.data();
+      }
+      if (entry.ownedRtpHeads.empty() && entry.rtpHeads.cnt > 0) {
+        entry.ownedRtpHeads.assign(entry.rtpHeads.data, entry.rtpHeads.data + entry.rtpHeads.cnt);
+        entry.rtpHeads.data = entry.ownedRtpHeads.data();
+      }
+    }
+    mappedRegionPtr.reset();
+    fileMappingPtr.reset();
+
+    std::filesystem::rename(tmpPath, sidecarPath);
+    isDirty = false;
+    return true;
+  } catch (const std::exception& e) {
+    logger->warning("Dongvin, failed to save index sidecar. path : " + sidecarPath.string());
+    std::cerr << e.what() << "\n";
+    std::error_code ec;
+    std::filesystem::remove(tmpPath, ec);
+    return false;
+  }
+}
+
+int64_t ContentIndexSidecar::getMtime(const std::filesystem::path& filePath) {
+  std::error_code ec;
+  const auto writeTime = std::filesystem::last_write_time(filePath, ec);
+  if (ec) return C::INVALID_OFFSET;
+  return static_cast<int64_t>(writeTime.time_since_epoch().count());
+}
+
+bool ContentIndexSidecar::getFileStamp(const std::filesystem::path& filePath, int64_t& outFileSize, int64_t& outMtime) {
+  std::error_code ec;
+  outFileSize = static_cast<int64_t>(std::filesystem::file_size(filePath, ec));
+  if (ec) return false;
+  outMtime = getMtime(filePath);
+  return true;
+}
+
+ContentIndexSidecar::Entry* ContentIndexSidecar::findValidEntry(
+  const std::filesystem::path& filePath, int64_t fileSize, int64_t mtime
+) {
+  const auto it = entries.find(getRelativePath(filePath));
+  if (it == entries.end() || it->second.fileSize != fileSize || it->second.mtime != mtime) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+std::string ContentIndexSidecar::getRelativePath(const std::filesystem::path& filePath) const {
+  // lexical only. no file system access.
+  return filePath.lexically_relative(contentPath).generic_string();
+}
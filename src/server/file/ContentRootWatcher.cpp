@@ -0,0 +1,183 @@
+#include "../include/ContentRootWatcher.h"
+#include "../../../constants/C.h"
+#include "../../../constants/Util.h"
+
+#include <iostream>
+#include <vector>
+
+#ifdef __linux__
+  #include <poll.h>
+  #include <sys/inotify.h>
+  #include <unistd.h>
+#endif
+
+namespace {
+#ifdef __linux__
+  constexpr uint32_t DIR_WATCH_MASK =
+    IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_DELETE_SELF;
+  constexpr size_t EVENT_BUF_LEN = 64 * 1024;
+#endif
+}
+
+ContentRootWatcher::ContentRootWatcher(
+  std::filesystem::path inputRootPath,
+  std::function<void(const std::string&)> inputOnContentChanged
+) : logger(Logger::getLogger(C::CONTENT_ROOT_WATCHER)),
+    rootPath(std::move(inputRootPath)),
+    onContentChanged(std::move(inputOnContentChanged)) {}
+
+ContentRootWatcher::~ContentRootWatcher() {
+  stop();
+}
+
+bool ContentRootWatcher::start() {
+#ifdef __linux__
+  inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotifyFd < 0) {
+    logger->severe("Dongvin, failed to init inotify! hot reload is off. errno : " + std::to_string(errno));
+    return false;
+  }
+  addWatchRecursively(rootPath);
+
+  watcherThread = std::thread([this]() { run(); });
+  logger->warning(
+    "Dongvin, watching content root for hot reload. path : " + rootPath.string()
+    + ", watched dirs : " + std::to_string(watchDirs.size())
+  );
+  return true;
+#else
+  logger->warning("Dongvin, content hot reload is supported on linux only.");
+  return false;
+#endif
+}
+
+void ContentRootWatcher::stop() {
+  if (isStopped.exchange(true)) return;
+  if (watcherThread.joinable()) watcherThread.join();
+#ifdef __linux__
+  if (inotifyFd >= 0) {
+    close(inotifyFd);
+    inotifyFd = -1;
+  }
+#endif
+}
+
+void ContentRootWatcher::run() {
+#ifdef __linux__
+  while (!isStopped) {
+    pollfd pollFd{inotifyFd, POLLIN, 0};
+    const int ready = poll(&pollFd, 1, C::CONTENT_WATCH_POLL_INTERVAL_MS);
+    const int64_t now = Util::getCurrentTimeMillis();
+    if (ready > 0 && (pollFd.revents & POLLIN)) {
+      handleEvents(now);
+    }
+
+    // debounce. report titles which got no event for a while.
+    std::vector<std::string> changedTitles;
+    for (auto it = pendingTitles.begin(); it != pendingTitles.end();) {
+      if (now - it->second >= C::CONTENT_RELOAD_DEBOUNCE_MS) {
+        changedTitles.push_back(it->first);
+        it = pendingTitles.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    for (const std::string& contentTitle : changedTitles) {
+      try {
+        onContentChanged(contentTitle);
+      } catch (const std::exception& e) {
+        logger->severe("Dongvin, exception while reloading content! : " + contentTitle);
+        std::cerr << e.what() << "\n";
+      }
+    }
+  }
+#endif
+}
+
+void ContentRootWatcher::handleEvents(int64_t now) {
+#ifdef __linux__
+  alignas(inotify_event) char buf[EVENT_BUF_LEN];
+  while (true) {
+    const ssize_t len = read(inotifyFd, buf, sizeof(buf));
+    if (len <= 0) return;
+
+    for (char* ptr = buf; ptr < buf + len;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+      ptr += sizeof(inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        // some events were dropped. treat every content as changed.
+        logger->warning("Dongvin, inotify queue overflowed. reloads every content.");
+        markAllContentsChanged(now);
+        continue;
+      }
+
+      const auto it = watchDirs.find(event->wd);
+      if (it == watchDirs.end()) continue;
+      if (event->mask & IN_IGNORED) {
+        watchDirs.erase(it);
+        continue;
+      }
+
+      const std::filesystem::path dir = it->second;
+      const std::string name = event->len > 0 ? std::string(event->name) : C::EMPTY_STRING;
+      if (isIgnored(name)) continue;
+
+      const std::filesystem::path changedPath = name.empty() ? dir : dir / name;
+      if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+        addWatchRecursively(changedPath);
+      }
+
+      const std::string contentTitle = getContentTitle(changedPath);
+      if (!contentTitle.empty()) pendingTitles[contentTitle] = now;
+    }
+  }
+#endif
+}
+
+void ContentRootWatcher::addWatchRecursively(const std::filesystem::path& dir) {
+#ifdef __linux__
+  std::vector<std::filesystem::path> dirs{dir};
+  std::error_code ec;
+  for (auto it = std::filesystem::recursive_directory_iterator(dir, ec);
+       !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+    if (isIgnored(it->path().filename().string())) {
+      if (it->is_directory(ec)) it.disable_recursion_pending();
+      continue;
+    }
+    if (it->is_directory(ec)) dirs.push_back(it->path());
+  }
+
+  for (const std::filesystem::path& watchDir : dirs) {
+    const int wd = inotify_add_watch(inotifyFd, watchDir.string().c_str(), DIR_WATCH_MASK);
+    if (wd < 0) {
+      logger->warning("Dongvin, failed to watch directory. check max_user_watches. path : " + watchDir.string());
+      continue;
+    }
+    watchDirs[wd] = watchDir;
+  }
+#endif
+}
+
+void ContentRootWatcher::markAllContentsChanged(int64_t now) {
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(rootPath, ec)) {
+    const std::string contentTitle = entry.path().filename().string();
+    if (entry.is_directory(ec) && !isIgnored(contentTitle)) pendingTitles[contentTitle] = now;
+  }
+}
+
+std::string ContentRootWatcher::getContentTitle(const std::filesystem::path& path) const {
+  // the first component below the root. empty for the root itself.
+  const std::filesystem::path relativePath = path.lexically_relative(rootPath);
+  if (relativePath.empty() || relativePath == ".") return C::EMPTY_STRING;
+  const std::string contentTitle = relativePath.begin()->string();
+  if (contentTitle == ".." || isIgnored(contentTitle)) return C::EMPTY_STRING;
+  return contentTitle;
+}
+
+bool ContentRootWatcher::isIgnored(const std::string& fileName) {
+  // hidden files. the .index sidecar is rewritten by loading itself.
+  return !fileName.empty() && fileName[0] == '.';
+}
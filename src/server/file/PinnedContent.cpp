@@ -0,0 +1,104 @@
+#include "../include/PinnedContent.h"
+#include "../../../constants/C.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+  #include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+  #include <sys/mman.h>
+#endif
+
+namespace {
+  bool lockMemory(void* addr, size_t len) {
+#ifdef _WIN32
+    return VirtualLock(addr, len) != 0;
+#elif defined(__linux__) || defined(__APPLE__)
+    return mlock(addr, len) == 0;
+#else
+    return false;
+#endif
+  }
+
+  void unlockMemory(void* addr, size_t len) {
+#ifdef _WIN32
+    VirtualUnlock(addr, len);
+#elif defined(__linux__) || defined(__APPLE__)
+    munlock(addr, len);
+#endif
+  }
+}
+
+PinnedContent::PinnedContent(const std::filesystem::path& inputContentPath)
+  : logger(Logger::getLogger(C::PINNED_CONTENT)),
+    contentPath(inputContentPath) {}
+
+PinnedContent::~PinnedContent() {
+  if (locked) {
+    for (auto& [relativePath, buf] : files) {
+      if (!buf.empty()) unlockMemory(buf.data(), buf.size());
+    }
+  }
+}
+
+bool PinnedContent::load() {
+  try {
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(contentPath)) {
+      if (!entry.is_regular_file()) continue;
+      const std::string extension = entry.path().extension().string();
+      if (extension != std::string(".") + C::ASV && extension != std::string(".") + C::ASA) continue;
+
+      const auto fileSize = static_cast<int64_t>(entry.file_size());
+      std::vector<unsigned char> buf(fileSize);
+      std::ifstream fileStream(entry.path(), std::ios::in | std::ios::binary);
+      if (!fileStream.read(reinterpret_cast<std::ifstream::char_type*>(buf.data()), fileSize)) {
+        logger->severe("Dongvin, failed to read file for pinning! path : " + entry.path().string());
+        return false;
+      }
+
+      byteSize += fileSize;
+      files.emplace(std::filesystem::relative(entry.path(), contentPath).generic_string(), std::move(buf));
+    }
+  } catch (const std::exception& e) {
+    logger->severe("Dongvin, exception while pinning content! path : " + contentPath.string());
+    std::cerr << e.what() << "\n";
+    return false;
+  }
+
+  // lock after every buffer was allocated. vectors are not resized anymore.
+  locked = true;
+  for (auto& [relativePath, buf] : files) {
+    if (!buf.empty() && !lockMemory(buf.data(), buf.size())) {
+      locked = false;
+      break;
+    }
+  }
+  if (!locked) {
+    // still served from memory. pages can be swapped out, though.
+    for (auto& [relativePath, buf] : files) {
+      if (!buf.empty()) unlockMemory(buf.data(), buf.size());
+    }
+    logger->warning(
+      "Dongvin, failed to lock memory of pinned content. check RLIMIT_MEMLOCK. path : " + contentPath.string()
+    );
+  }
+  return true;
+}
+
+bool PinnedContent::read(const std::string& relativePath, int64_t offset, int64_t len, unsigned char* dst) const noexcept {
+  const auto it = files.find(relativePath);
+  if (it == files.end() || offset < 0 || len < 0) return false;
+  if (offset + len > static_cast<int64_t>(it->second.size())) return false;
+  std::memcpy(dst, it->second.data() + offset, len);
+  return true;
+}
+
+int64_t PinnedContent::getByteSize() const {
+  return byteSize;
+}
+
+bool PinnedContent::isLocked() const {
+  return locked;
+}
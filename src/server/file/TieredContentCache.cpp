@@ -0,0 +1,355 @@
+#include "../include/TieredContentCache.h"
+#include "../../../constants/Util.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+  constexpr char TMP_DIR_PREFIX[] = ".tmp-";
+}
+
+TieredContentCache::TieredContentCache(
+  std::string inputSlowRootPath,
+  std::string inputFastRootPath,
+  int64_t inputQuotaBytes
+) : logger(Logger::getLogger(C::TIERED_CONTENT_CACHE)),
+    slowRootPath(std::move(inputSlowRootPath)),
+    fastRootPath(std::move(inputFastRootPath)),
+    quotaBytes(inputQuotaBytes) {}
+
+TieredContentCache::~TieredContentCache() {
+  shutdown();
+}
+
+void TieredContentCache::init() {
+  try {
+    std::filesystem::create_directories(fastRootPath);
+
+    // adopt complete copies left from the previous run. remove half-done ones.
+    for (const auto& dirEntry : std::filesystem::directory_iterator(fastRootPath)) {
+      if (!dirEntry.is_directory()) continue;
+      const std::string name = dirEntry.path().filename().string();
+      if (name.rfind(TMP_DIR_PREFIX, 0) == 0 || !std::filesystem::is_directory(slowRootPath / name)) {
+        std::filesystem::remove_all(dirEntry.path());
+        continue;
+      }
+
+      const int64_t fastSize = getDirectoryByteSize(dirEntry.path());
+      if (fastSize != getDirectoryByteSize(slowRootPath / name)) {
+        logger->warning("Dongvin, stale local copy was removed. content : " + name);
+        std::filesystem::remove_all(dirEntry.path());
+        continue;
+      }
+
+      TierEntry& entry = entries[name];
+      entry.state = TierState::FAST;
+      entry.byteSize = fastSize;
+      usedBytes += fastSize;
+    }
+  } catch (const std::exception& e) {
+    logger->severe("Dongvin, failed to init local tier cache! path : " + fastRootPath.string());
+    std::cerr << e.what() << "\n";
+  }
+
+  copyWorker = std::thread([this]() { runCopyWorker(); });
+  logger->warning(
+    "Dongvin, local tier cache started. fast root : " + fastRootPath.string()
+    + ", adopted bytes : " + std::to_string(usedBytes)
+  );
+}
+
+void TieredContentCache::shutdown() {
+  if (isStopped.exchange(true)) return;
+  copyCondition.notify_all();
+  if (copyWorker.joinable()) copyWorker.join();
+  logger->warning("Dongvin, local tier cache stats : " + getStats());
+}
+
+std::string TieredContentCache::acquireContentPath(const std::string& contentTitle) {
+  bool needCopy = false;
+  std::string contentPath;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    TierEntry& entry = entries[contentTitle];
+    entry.accessCnt++;
+    entry.lastAccessTimeMillis = Util::getCurrentTimeMillis();
+    entry.inUseCnt++;
+
+    if (entry.state == TierState::FAST) {
+      fastReadCnt++;
+      contentPath = (fastRootPath / contentTitle).string();
+    } else {
+      slowReadCnt++;
+      needCopy = isCopyable(entry) && entry.accessCnt >= C::LOCAL_TIER_PROMOTION_ACCESS_CNT;
+      contentPath = (slowRootPath / contentTitle).string();
+    }
+  }
+
+  if (needCopy) enqueueCopy(contentTitle);
+  return contentPath;
+}
+
+void TieredContentCache::releaseContentPath(const std::string& contentTitle) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = entries.find(contentTitle);
+    if (it == entries.end() || it->second.inUseCnt == 0) return;
+    it->second.inUseCnt--;
+    if (it->second.inUseCnt > 0 || !it->second.isRemovalPending) return;
+  }
+  removeStaleCopy(contentTitle);
+}
+
+void TieredContentCache::promote(const std::string& contentTitle) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!isCopyable(entries[contentTitle])) return;
+  }
+  enqueueCopy(contentTitle);
+}
+
+void TieredContentCache::invalidate(const std::string& contentTitle) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = entries.find(contentTitle);
+    if (it == entries.end()) return;
+    TierEntry& entry = it->second;
+    // the changed content may copy fine. e.g. it fits in the quota now.
+    entry.failedCopyCnt = 0;
+    entry.nextCopyTimeMillis = 0;
+    if (entry.state == TierState::COPYING) {
+      entry.isStale = true;
+      return;
+    }
+    if (entry.state != TierState::FAST) return;
+    // new sessions read the slow tier from now on.
+    entry.accessCnt = 0;
+    entry.state = TierState::SLOW_ONLY;
+    entry.isRemovalPending = true;
+    if (entry.inUseCnt > 0) {
+      logger->info(
+        "Dongvin, stale local copy is removed after " + std::to_string(entry.inUseCnt)
+        + " sessions release it. content : " + contentTitle
+      );
+      return;
+    }
+  }
+  removeStaleCopy(contentTitle);
+}
+
+void TieredContentCache::removeStaleCopy(const std::string& contentTitle) {
+  std::error_code ec;
+  std::filesystem::remove_all(fastRootPath / contentTitle, ec);
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    TierEntry& entry = entries[contentTitle];
+    usedBytes -= entry.byteSize;
+    entry.byteSize = 0;
+    entry.isRemovalPending = false;
+  }
+  logger->info("Dongvin, dropped stale local copy. content : " + contentTitle);
+}
+
+bool TieredContentCache::isCopyable(const TierEntry& entry) {
+  return entry.state == TierState::SLOW_ONLY && !entry.isRemovalPending
+    && Util::getCurrentTimeMillis() >= entry.nextCopyTimeMillis;
+}
+
+std::string TieredContentCache::getFastContentPath(const std::string& contentTitle) const {
+  return (fastRootPath / contentTitle).string();
+}
+
+std::string TieredContentCache::getStats() {
+  int fastCnt = 0;
+  int64_t bytes = 0;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    for (const auto& [title, entry] : entries) {
+      if (entry.state == TierState::FAST) fastCnt++;
+    }
+    bytes = usedBytes;
+  }
+  return "fast contents: " + std::to_string(fastCnt)
+    + ", used bytes: " + std::to_string(bytes) + "/" + std::to_string(quotaBytes)
+    + ", fast read: " + std::to_string(fastReadCnt.load())
+    + ", slow read: " + std::to_string(slowReadCnt.load())
+    + ", evicted: " + std::to_string(evictedCnt.load());
+}
+
+void TieredContentCache::enqueueCopy(const std::string& contentTitle) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    TierEntry& entry = entries[contentTitle];
+    if (!isCopyable(entry)) return;
+    entry.state = TierState::COPYING;
+    copyQueue.push_back(contentTitle);
+  }
+  copyCondition.notify_one();
+}
+
+void TieredContentCache::runCopyWorker() {
+  while (true) {
+    std::string contentTitle;
+    {
+      std::unique_lock<std::mutex> uniqueLock(lock);
+      copyCondition.wait(uniqueLock, [this]() { return isStopped || !copyQueue.empty(); });
+      if (isStopped) return;
+      contentTitle = copyQueue.front();
+      copyQueue.pop_front();
+    }
+
+    const bool isCopied = copyContent(contentTitle);
+
+    bool isStaleCopy = false;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      TierEntry& entry = entries[contentTitle];
+      isStaleCopy = isCopied && entry.isStale;
+      entry.isStale = false;
+      entry.state = (isCopied && !isStaleCopy) ? TierState::FAST : TierState::SLOW_ONLY;
+      if (isStaleCopy) {
+        usedBytes -= entry.byteSize;
+        entry.byteSize = 0;
+      }
+      if (isCopied) {
+        entry.failedCopyCnt = 0;
+        entry.nextCopyTimeMillis = 0;
+      } else {
+        // each try walks the whole slow tier directory and may evict other copies. not on every access.
+        const int64_t retryDelayMs = std::min(
+          C::LOCAL_TIER_COPY_RETRY_BASE_MS << std::min(entry.failedCopyCnt, 16), C::LOCAL_TIER_COPY_RETRY_MAX_MS
+        );
+        entry.failedCopyCnt++;
+        entry.nextCopyTimeMillis = Util::getCurrentTimeMillis() + retryDelayMs;
+        logger->warning(
+          "Dongvin, local tier copy is retried after ms : " + std::to_string(retryDelayMs)
+          + ", failed cnt : " + std::to_string(entry.failedCopyCnt) + ", content : " + contentTitle
+        );
+      }
+    }
+
+    // content was changed while copying. copied again on the next access.
+    if (isStaleCopy) {
+      std::error_code ec;
+      std::filesystem::remove_all(fastRootPath / contentTitle, ec);
+    }
+  }
+}
+
+bool TieredContentCache::copyContent(const std::string& contentTitle) {
+  const std::filesystem::path srcDir = slowRootPath / contentTitle;
+  const std::filesystem::path tmpDir = fastRootPath / (TMP_DIR_PREFIX + contentTitle);
+  const std::filesystem::path dstDir = fastRootPath / contentTitle;
+
+  try {
+    const int64_t requiredBytes = getDirectoryByteSize(srcDir);
+    if (!makeRoomFor(contentTitle, requiredBytes)) {
+      logger->warning("Dongvin, not enough local tier quota. content : " + contentTitle);
+      return false;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    std::filesystem::remove_all(tmpDir);
+    std::vector<char> chunk(C::LOCAL_TIER_COPY_CHUNK_SIZE);
+    for (const auto& dirEntry : std::filesystem::recursive_directory_iterator(srcDir)) {
+      if (isStopped) throw std::runtime_error("stopped while copying");
+
+      const std::filesystem::path target = tmpDir / std::filesystem::relative(dirEntry.path(), srcDir);
+      if (dirEntry.is_directory()) {
+        std::filesystem::create_directories(target);
+        continue;
+      }
+      if (!dirEntry.is_regular_file()) continue;
+
+      std::filesystem::create_directories(target.parent_path());
+      std::ifstream in(dirEntry.path(), std::ios::in | std::ios::binary);
+      std::ofstream out(target, std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!in.is_open() || !out.is_open()) throw std::runtime_error("failed to open " + dirEntry.path().string());
+
+      while (in) {
+        if (isStopped) throw std::runtime_error("stopped while copying");
+        in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        if (in.gcount() > 0) out.write(chunk.data(), in.gcount());
+      }
+      if (!out) throw std::runtime_error("failed to write " + target.string());
+    }
+
+    // rename makes the copy visible at once. sessions never see a half-done copy.
+    std::filesystem::remove_all(dstDir);
+    std::filesystem::rename(tmpDir, dstDir);
+
+    const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime
+    ).count();
+    logger->info(
+      "Dongvin, copied content to local tier. content : " + contentTitle
+      + ", bytes : " + std::to_string(requiredBytes) + ", took ms : " + std::to_string(elapsedMs)
+    );
+    return true;
+  } catch (const std::exception& e) {
+    logger->severe("Dongvin, failed to copy content to local tier! content : " + contentTitle);
+    std::cerr << e.what() << "\n";
+
+    std::error_code ec;
+    std::filesystem::remove_all(tmpDir, ec);
+    std::lock_guard<std::mutex> guard(lock);
+    usedBytes -= entries[contentTitle].byteSize;
+    entries[contentTitle].byteSize = 0;
+    return false;
+  }
+}
+
+bool TieredContentCache::makeRoomFor(const std::string& contentTitle, int64_t requiredBytes) {
+  if (requiredBytes > quotaBytes) return false;
+
+  std::vector<std::string> victims;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    std::vector<std::pair<std::string, const TierEntry*>> candidates;
+    for (const auto& [title, entry] : entries) {
+      if (entry.state == TierState::FAST && entry.inUseCnt == 0) candidates.emplace_back(title, &entry);
+    }
+
+    // least popular first. older one first among the same popularity.
+    std::sort(candidates.begin(), candidates.end(), [](const auto& lhs, const auto& rhs) {
+      if (lhs.second->accessCnt != rhs.second->accessCnt) return lhs.second->accessCnt < rhs.second->accessCnt;
+      return lhs.second->lastAccessTimeMillis < rhs.second->lastAccessTimeMillis;
+    });
+
+    int64_t freeBytes = quotaBytes - usedBytes;
+    for (const auto& [title, entryPtr] : candidates) {
+      if (freeBytes >= requiredBytes) break;
+      freeBytes += entryPtr->byteSize;
+      victims.push_back(title);
+    }
+    if (freeBytes < requiredBytes) return false;
+
+    for (const std::string& title : victims) {
+      TierEntry& entry = entries.at(title);
+      usedBytes -= entry.byteSize;
+      entry.byteSize = 0;
+      entry.state = TierState::SLOW_ONLY;
+    }
+    // reserve the quota before copying.
+    usedBytes += requiredBytes;
+    entries[contentTitle].byteSize = requiredBytes;
+  }
+
+  for (const std::string& title : victims) {
+    std::error_code ec;
+    std::filesystem::remove_all(fastRootPath / title, ec);
+    evictedCnt++;
+    logger->info("Dongvin, evicted content from local tier. content : " + title);
+  }
+  return true;
+}
+
+int64_t TieredContentCache::getDirectoryByteSize(const std::filesystem::path& dir) const {
+  int64_t totalBytes = 0;
+  for (const auto& dirEntry : std::filesystem::recursive_directory_iterator(dir)) {
+    if (dirEntry.is_regular_file()) totalBytes += static_cast<int64_t>(dirEntry.file_size());
+  }
+  return totalBytes;
+}
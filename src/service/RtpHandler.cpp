@@ -1,5 +1,7 @@
 #include "../include/RtpHandler.h"
 
+#include "../include/LatencyHistogram.h"
+
 RtpHandler::RtpHandler(
   std::string inputSessionId,
   std::weak_ptr<Session> inputParentSessionPtr,
@@ -17,6 +19,9 @@ RtpHandler::~RtpHandler() {
     }
   }
   if (audioFileStream.is_open()) audioFileStream.close();
+
+  if (blockCachePtr != nullptr) blockCachePtr->removeSession(sessionId);
+  releaseTierContentPath();
 }
 
 [[nodiscard]] bool RtpHandler::openAllFileStreamsForVideoAndAudio() {
@@ -24,31 +29,64 @@ RtpHandler::~RtpHandler() {
     // video
     int camDirCnt = sessionPtr->getNumberOfCamDirectories();
     const std::string& contentRootDir = sessionPtr->getContentRootPath();
-    const std::string& contentTitle = sessionPtr->getContentTitle();
-
-    const std::string contentPath = contentRootDir + DIR_SEPARATOR + contentTitle;
-
-    for (int camId = 0; camId < camDirCnt; ++camId) {
-      camIdVideoFileStreamMap.insert({camId, std::vector<std::ifstream>{}});
-
-      const std::string camPath = contentPath + DIR_SEPARATOR + C::CAM_ID_LIST[camId];
-
-      auto& streamVec = camIdVideoFileStreamMap.at(camId);
-      // front Video in current cam
-      streamVec.emplace_back(camPath + DIR_SEPARATOR + "V1H.asv", std::ios::in | std::ios::binary);
-      // rear Video in current cam
-      streamVec.emplace_back(camPath + DIR_SEPARATOR + "V2H.asv", std::ios::in | std::ios::binary);
+    contentTitle = sessionPtr->getContentTitle();
+
+    // resolved on every open. the local copy may have been made or dropped since the last one.
+    std::string contentPath = contentRootDir + DIR_SEPARATOR + contentTitle;
+    blockCachePtr = sessionPtr->getContentsStorage().getBlockCache();
+    tierCachePtr = sessionPtr->getContentsStorage().getTierCache();
+    releaseTierContentPath();
+    if (tierCachePtr != nullptr) {
+      // read from the local copy if it is ready.
+      contentPath = tierCachePtr->acquireContentPath(contentTitle);
+      acquiredTierContentTitle = contentTitle;
+    }
 
-      for (const auto& access : camIdVideoFileStreamMap.at(camId)) {
-        if (!access.is_open()){
-          logger->severe("Dongvin, failed to open video file! : ");
-          return false;
+    // files of the previous open may be on the other tier.
+    std::unordered_map<int, std::vector<std::ifstream>>().swap(camIdVideoFileStreamMap);
+    if (audioFileStream.is_open()) audioFileStream.close();
+
+    // paths of every bitrate variant. only the current variant is opened here, others on their first switch.
+    std::vector<int> mbpsTypeList = sessionPtr->get_mbpsTypeList();
+    if (mbpsTypeList.empty()) mbpsTypeList.push_back(C::INVALID);
+    std::unordered_map<int, std::vector<std::string>> videoFilePathMap;
+    for (int variantIdx = 0; variantIdx < static_cast<int>(mbpsTypeList.size()); ++variantIdx) {
+      for (int camId = 0; camId < camDirCnt; ++camId) {
+        const std::string camPath
+          = contentPath + DIR_SEPARATOR + ContentFileMeta::getCamDirName(camId, mbpsTypeList[variantIdx]);
+
+        auto& pathVec = videoFilePathMap[toVideoFileKey(variantIdx, camId)];
+        // front Video in current cam
+        pathVec.push_back(camPath + DIR_SEPARATOR + "V1H.asv");
+        // rear Video in current cam
+        pathVec.push_back(camPath + DIR_SEPARATOR + "V2H.asv");
+      }
+    }
+    // audio. in the ref cam, which is cam0 of the highest bitrate.
+    audioFilePath = contentPath + DIR_SEPARATOR + ContentFileMeta::getCamDirName(0, mbpsTypeList[0]) + DIR_SEPARATOR + "V.asa";
+
+    auto newReadSourcePtr = std::make_shared<ReadSource>();
+    newReadSourcePtr->blockCachePtr = blockCachePtr;
+    newReadSourcePtr->pinnedContentPtr = sessionPtr->getContentsStorage().getPinnedContent(contentTitle);
+    if (newReadSourcePtr->pinnedContentPtr != nullptr) {
+      const std::filesystem::path contentDir(contentPath);
+      for (const auto& [videoFileKey, pathVec] : videoFilePathMap) {
+        for (const std::string& path : pathVec) {
+          newReadSourcePtr->pinnedKeyMap[path] = std::filesystem::relative(path, contentDir).generic_string();
         }
       }
+      newReadSourcePtr->pinnedKeyMap[audioFilePath]
+        = std::filesystem::relative(audioFilePath, contentDir).generic_string();
+    }
+    {
+      // a running prewarm job takes its paths and read source under the lock.
+      std::lock_guard<std::mutex> guard(prewarmLock);
+      camIdVideoFilePathMap.swap(videoFilePathMap);
+      readSourcePtr = std::move(newReadSourcePtr);
+      isPrewarmFilePathChanged = true;
     }
+    if (!openVideoFileStreamsOfVariant(bitrateVariantIdx)) return false;
 
-    // audio
-    const std::string audioFilePath = contentPath + DIR_SEPARATOR + C::CAM_ID_LIST[0] + DIR_SEPARATOR + "V.asa";
     audioFileStream.open(audioFilePath, std::ios::in | std::ios::binary);
     if (!audioFileStream.is_open()){
       logger->severe("Dongvin, failed to open audio file! path : " + audioFilePath);
@@ -62,6 +100,37 @@ RtpHandler::~RtpHandler() {
   }
 }
 
+bool RtpHandler::closeAllFileStreams() {
+  const bool wasOpen = !camIdVideoFileStreamMap.empty();
+  // std::ifstream closes on destruction.
+  std::unordered_map<int, std::vector<std::ifstream>>().swap(camIdVideoFileStreamMap);
+  if (audioFileStream.is_open()) audioFileStream.close();
+  {
+    std::lock_guard<std::mutex> guard(prewarmLock);
+    isFileStreamClosed = true;
+    std::vector<PrewarmSampleRange>().swap(pendingPrewarmRanges);
+    std::vector<PrewarmedSample>().swap(prewarmedSamples);
+    if (auto sessionPtr = parentSessionPtr.lock()) sessionPtr->addPrewarmedBytes(-prewarmedByteSize);
+    prewarmedByteSize = 0;
+    if (!isPrewarmRunning) prewarmVideoFileStreamMap.clear();
+  }
+  if (blockCachePtr != nullptr) blockCachePtr->removeSession(sessionId);
+  // a parked session does not hold the local copy. it can be evicted or replaced meanwhile.
+  releaseTierContentPath();
+  return wasOpen;
+}
+
+bool RtpHandler::reopenAllFileStreams() {
+  // the paths are resolved again, not reused.
+  if (!openAllFileStreamsForVideoAndAudio()) {
+    logger->severe("Dongvin, failed to reopen file streams! content : " + contentTitle);
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(prewarmLock);
+  isFileStreamClosed = false;
+  return true;
+}
+
 std::unique_ptr<Buffer> RtpHandler::readFirstRtpOfCurVideoSample(int sampleNo, int64_t offset, int64_t len) noexcept {
   std::vector<unsigned char> buf(len);
 
@@ -78,10 +147,7 @@ std::unique_ptr<Buffer> RtpHandler::readFirstRtpOfCurVideoSample(int sampleNo, i
     return nullptr;
   }
 
-  videoFileReadingStream.seekg(offset, std::ios::beg);
-  videoFileReadingStream.read(reinterpret_cast<std::istream::char_type*>(buf.data()), len);
-
-  if (videoFileReadingStream.gcount() != len) {
+  if (!readBytes(videoFileReadingStream, camIdVideoFilePathMap.at(0)[0], offset, len, buf.data())) {
     logger->severe("Dongvin, failed to read first rtp of current video sample! sampleNo : " + std::to_string(sampleNo));
     return nullptr;
   }
@@ -106,7 +172,8 @@ void RtpHandler::readVideoSample(
     return;
   }
 
-  const auto camIt = camIdVideoFileStreamMap.find(camId);
+  const int videoFileKey = toVideoFileKey(bitrateVariantIdx, camId);
+  const auto camIt = camIdVideoFileStreamMap.find(videoFileKey);
   if (camIt == camIdVideoFileStreamMap.end() || camIt->second.size() < 2) {
     logger->severe("Dongvin, invalid camId or insufficient video file streams! camId: " + std::to_string(camId));
     return;
@@ -160,14 +227,18 @@ void RtpHandler::readVideoSample(
       rtpInfo->offset = 0;
       rtpInfo->length = metaData.size();
       rtpInfo->isHybridMeta = true;
+      rtpInfo->sampleNo = sampleNo;
       sessionPtr->enqueueRtpForMemoryMgmt(rtpInfo);
       sessionPtr->enqueueRtpInfo(rtpInfo.get());
     } else {
-      // no front V sample meta for hybrid D & S. read sample from file stream.
-      frontVideoFileReadingStream.seekg(curFrontVideoSampleInfo.getOffset(), std::ios::beg);
-      const std::shared_ptr<Sample> frontVSamplePtr = std::make_shared<Sample>(
-        frontVideoFileReadingStream, curFrontVideoSampleInfo.getSize()
-      );
+      // no front V sample meta for hybrid D & S. read sample from memory if prewarmed, or from file stream.
+      std::shared_ptr<Sample> frontVSamplePtr = findPrewarmedSample(videoFileKey, sampleNo, C::FRONT_VIDEO_VID);
+      if (frontVSamplePtr == nullptr) {
+        frontVSamplePtr = readSample(
+          frontVideoFileReadingStream, camIdVideoFilePathMap.at(videoFileKey)[0],
+          curFrontVideoSampleInfo.getOffset(), curFrontVideoSampleInfo.getSize()
+        );
+      }
       if (frontVSamplePtr->refCount == C::INVALID) {
         logger->severe("Dongvin, fail to read front video sample! sample no : " + std::to_string(sampleNo));
         return;
@@ -184,6 +255,7 @@ void RtpHandler::readVideoSample(
           rtpInfo->offset = offsetForFrontVRtp;
           rtpInfo->length = rtpMeta.len;
           rtpInfo->isHybridMeta = false;
+          rtpInfo->sampleNo = sampleNo;
           offsetForFrontVRtp += rtpMeta.len;
           sessionPtr->enqueueRtpForMemoryMgmt(rtpInfo);
           sessionPtr->enqueueRtpInfo(rtpInfo.get());
@@ -207,6 +279,7 @@ void RtpHandler::readVideoSample(
       rtpInfo->offset = 0;
       rtpInfo->length = metaData.size();
       rtpInfo->isHybridMeta = true;
+      rtpInfo->sampleNo = sampleNo;
       sessionPtr->enqueueRtpForMemoryMgmt(rtpInfo);
       sessionPtr->enqueueRtpInfo(rtpInfo.get());
     } else {
@@ -227,11 +300,13 @@ void RtpHandler::readVideoSample(
         return;
       }
 
-      rearVideoFileReadingStream.seekg(curRearVideoSampleInfo.getOffset(), std::ios::beg);
-
-      const std::shared_ptr<Sample> rearVSamplePtr = std::make_shared<Sample>(
-        rearVideoFileReadingStream, curRearVideoSampleInfo.getSize()
-      );
+      std::shared_ptr<Sample> rearVSamplePtr = findPrewarmedSample(videoFileKey, sampleNo, C::REAR_VIDEO_VID);
+      if (rearVSamplePtr == nullptr) {
+        rearVSamplePtr = readSample(
+          rearVideoFileReadingStream, camIdVideoFilePathMap.at(videoFileKey)[1],
+          curRearVideoSampleInfo.getOffset(), curRearVideoSampleInfo.getSize()
+        );
+      }
 
       if (rearVSamplePtr->refCount == C::INVALID) {
         logger->severe("Dongvin, fail to read rear video sample! sample no : " + std::to_string(sampleNo));
@@ -249,6 +324,7 @@ void RtpHandler::readVideoSample(
           rtpInfo->offset = offsetForRearVRtp;
           rtpInfo->length = rtpMeta.len;
           rtpInfo->isHybridMeta = false;
+          rtpInfo->sampleNo = sampleNo;
           offsetForRearVRtp += rtpMeta.len;
           sessionPtr->enqueueRtpForMemoryMgmt(rtpInfo);
           sessionPtr->enqueueRtpInfo(rtpInfo.get());
@@ -268,10 +344,7 @@ std::unique_ptr<Buffer> RtpHandler::readFirstRtpOfCurAudioSample(int sampleNo, i
   }
 
   std::vector<unsigned char> buf(len);
-  audioFileStream.seekg(offset, std::ios::beg);
-  audioFileStream.read(reinterpret_cast<std::istream::char_type*>(buf.data()), len);
-
-  if (audioFileStream.gcount() != len) {
+  if (!readBytes(audioFileStream, audioFilePath, offset, len, buf.data())) {
     logger->severe("Dongvin, failed to read first rtp of current audio sample! sampleNo : " + std::to_string(sampleNo));
     return nullptr;
   }
@@ -293,9 +366,7 @@ void RtpHandler::readAudioSample(
       return;
     }
 
-    audioFileStream.seekg(offset, std::ios::beg);
-
-    const std::shared_ptr<Sample> audioSamplePtr = std::make_shared<Sample>(audioFileStream, len);
+    const std::shared_ptr<Sample> audioSamplePtr = readSample(audioFileStream, audioFilePath, offset, len);
 
     if (audioSamplePtr->refCount == C::INVALID) {
       logger->severe("Dongvin, failed to read audio sample! sample no : " + std::to_string(sampleNo));
@@ -308,6 +379,7 @@ void RtpHandler::readAudioSample(
       rtpInfo->offset = 0;
       rtpInfo->length = len;
       rtpInfo->isHybridMeta = false;
+      rtpInfo->sampleNo = sampleNo;
       sessionPtr->enqueueRtpForMemoryMgmt(rtpInfo);
       sessionPtr->enqueueRtpInfo(rtpInfo.get());
     } else {
@@ -337,6 +409,7 @@ void RtpHandler::readAudioSample(
       rtpInfo->offset = 0;
       rtpInfo->length = metaData.size();
       rtpInfo->isHybridMeta = true;
+      rtpInfo->sampleNo = sampleNo;
       sessionPtr->enqueueRtpForMemoryMgmt(rtpInfo);
       sessionPtr->enqueueRtpInfo(rtpInfo.get());
     } else {
@@ -376,3 +449,197 @@ void RtpHandler::readAudioSample(
 
 
 
+
+void RtpHandler::updateVideoPlaybackWindow(
+  int camId, int64_t frontBeginOffset, int64_t frontEndOffset, int64_t rearBeginOffset, int64_t rearEndOffset
+) {
+  if (blockCachePtr == nullptr) return;
+  const auto pathIt = camIdVideoFilePathMap.find(toVideoFileKey(bitrateVariantIdx, camId));
+  if (pathIt == camIdVideoFilePathMap.end() || pathIt->second.size() < 2) return;
+
+  blockCachePtr->updatePlaybackWindow(sessionId, pathIt->second[0], frontBeginOffset, frontEndOffset);
+  blockCachePtr->updatePlaybackWindow(sessionId, pathIt->second[1], rearBeginOffset, rearEndOffset);
+}
+
+void RtpHandler::updateAudioPlaybackWindow(int64_t beginOffset, int64_t endOffset) {
+  if (blockCachePtr == nullptr) return;
+  blockCachePtr->updatePlaybackWindow(sessionId, audioFilePath, beginOffset, endOffset);
+}
+
+void RtpHandler::prewarmSamples(std::vector<PrewarmSampleRange> ranges) {
+  auto sessionPtr = parentSessionPtr.lock();
+  if (sessionPtr == nullptr) return;
+  boost::asio::thread_pool* prewarmThreadPoolPtr = sessionPtr->getContentsStorage().getPrewarmThreadPool();
+  if (prewarmThreadPoolPtr == nullptr) return;
+  {
+    std::lock_guard<std::mutex> guard(prewarmLock);
+    // only the latest request matters. an older one which is not started yet is dropped.
+    pendingPrewarmRanges = std::move(ranges);
+    if (isPrewarmRunning) return;
+    isPrewarmRunning = true;
+  }
+  boost::asio::post(*prewarmThreadPoolPtr, [self = shared_from_this()](){ self->runPrewarm(); });
+}
+
+bool RtpHandler::setBitrateVariant(int variantIdx) {
+  if (!openVideoFileStreamsOfVariant(variantIdx)) return false;
+  bitrateVariantIdx = variantIdx;
+  return true;
+}
+
+bool RtpHandler::openVideoFileStreamsOfVariant(int variantIdx) {
+  // the ref cam, cam0 of variant 0, is always open. the first rtp of a sample is read from it.
+  for (const auto& [videoFileKey, pathVec] : camIdVideoFilePathMap) {
+    if (videoFileKey / C::MAX_CAM_DIR_NUMBER != variantIdx && videoFileKey != toVideoFileKey(0, 0)) continue;
+    auto& streamVec = camIdVideoFileStreamMap[videoFileKey];
+    if (!streamVec.empty()) continue;
+    for (const std::string& path : pathVec) {
+      streamVec.emplace_back(path, std::ios::in | std::ios::binary);
+      if (!streamVec.back().is_open()) {
+        logger->severe("Dongvin, failed to open video file! path : " + path);
+        camIdVideoFileStreamMap.erase(videoFileKey);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void RtpHandler::runPrewarm() {
+  while (true) {
+    std::vector<PrewarmSampleRange> ranges;
+    std::unordered_map<int, std::vector<std::string>> videoFilePathMap;
+    std::shared_ptr<const ReadSource> prewarmReadSourcePtr;
+    {
+      std::lock_guard<std::mutex> guard(prewarmLock);
+      if (pendingPrewarmRanges.empty()) {
+        isPrewarmRunning = false;
+        return;
+      }
+      ranges.swap(pendingPrewarmRanges);
+      // the strand replaces both on reopen. the pinned content stays alive with this copy.
+      videoFilePathMap = camIdVideoFilePathMap;
+      prewarmReadSourcePtr = readSourcePtr;
+      if (isPrewarmFilePathChanged) {
+        // may be on the other tier now.
+        prewarmVideoFileStreamMap.clear();
+        isPrewarmFilePathChanged = false;
+      }
+    }
+
+    std::vector<PrewarmedSample> samples;
+    samples.reserve(ranges.size());
+    int64_t byteSize = 0;
+    for (const PrewarmSampleRange& range : ranges) {
+      const int videoFileKey = toVideoFileKey(range.variantIdx, range.camId);
+      const auto pathIt = videoFilePathMap.find(videoFileKey);
+      if (pathIt == videoFilePathMap.end() || pathIt->second.size() < 2) continue;
+
+      auto& streamVec = prewarmVideoFileStreamMap[videoFileKey];
+      if (streamVec.empty()) {
+        for (const std::string& path : pathIt->second) {
+          streamVec.emplace_back(path, std::ios::in | std::ios::binary);
+        }
+      }
+
+      PrewarmedSample sample{videoFileKey, range.sampleNo, {}, {}};
+      sample.frontBuf.resize(range.frontLen);
+      sample.rearBuf.resize(range.rearLen);
+      if (
+        !readBytes(
+          *prewarmReadSourcePtr, streamVec[0], pathIt->second[0], range.frontOffset, range.frontLen,
+          sample.frontBuf.data()
+        )
+        || !readBytes(
+          *prewarmReadSourcePtr, streamVec[1], pathIt->second[1], range.rearOffset, range.rearLen,
+          sample.rearBuf.data()
+        )
+      ) {
+        logger->warning("Dongvin, failed to prewarm sample. cam : " + std::to_string(range.camId)
+          + ", sample no : " + std::to_string(range.sampleNo));
+        streamVec[0].clear();
+        streamVec[1].clear();
+        continue;
+      }
+      byteSize += range.frontLen + range.rearLen;
+      samples.push_back(std::move(sample));
+    }
+
+    std::lock_guard<std::mutex> guard(prewarmLock);
+    if (isFileStreamClosed) {
+      prewarmVideoFileStreamMap.clear();
+      isPrewarmRunning = false;
+      return;
+    }
+    // the replaced samples are released at once. held under the lock, so closing never misses these bytes.
+    if (auto sessionPtr = parentSessionPtr.lock()) sessionPtr->addPrewarmedBytes(byteSize - prewarmedByteSize);
+    prewarmedSamples = std::move(samples);
+    prewarmedByteSize = byteSize;
+  }
+}
+
+std::shared_ptr<Sample> RtpHandler::findPrewarmedSample(int videoFileKey, int sampleNo, int vid) {
+  std::lock_guard<std::mutex> guard(prewarmLock);
+  for (const PrewarmedSample& prewarmedSample : prewarmedSamples) {
+    if (prewarmedSample.videoFileKey != videoFileKey || prewarmedSample.sampleNo != sampleNo) continue;
+    // copied. the Sample's ref count is owned by the rtp tx path.
+    auto samplePtr = std::make_shared<Sample>();
+    samplePtr->buf = vid == C::FRONT_VIDEO_VID ? prewarmedSample.frontBuf : prewarmedSample.rearBuf;
+    return samplePtr;
+  }
+  return nullptr;
+}
+
+void RtpHandler::releaseTierContentPath() {
+  if (tierCachePtr == nullptr || acquiredTierContentTitle.empty()) return;
+  tierCachePtr->releaseContentPath(acquiredTierContentTitle);
+  acquiredTierContentTitle.clear();
+}
+
+int RtpHandler::toVideoFileKey(int variantIdx, int camId) {
+  return variantIdx * C::MAX_CAM_DIR_NUMBER + camId;
+}
+
+bool RtpHandler::readBytes(
+  std::ifstream& fileStream, const std::string& filePath, int64_t offset, int64_t len, unsigned char* dst
+) noexcept {
+  return readBytes(*readSourcePtr, fileStream, filePath, offset, len, dst);
+}
+
+bool RtpHandler::readBytes(
+  const ReadSource& readSource,
+  std::ifstream& fileStream,
+  const std::string& filePath,
+  int64_t offset,
+  int64_t len,
+  unsigned char* dst
+) noexcept {
+  if (readSource.pinnedContentPtr != nullptr) {
+    if (const auto it = readSource.pinnedKeyMap.find(filePath);
+      it != readSource.pinnedKeyMap.end() && readSource.pinnedContentPtr->read(it->second, offset, len, dst)) {
+      return true;
+    }
+  }
+
+  if (readSource.blockCachePtr != nullptr && readSource.blockCachePtr->read(filePath, offset, len, dst)) {
+    return true;
+  }
+
+  // block cache is not in use or failed. read through the std::ifstream.
+  fileStream.seekg(offset, std::ios::beg);
+  fileStream.read(reinterpret_cast<std::istream::char_type*>(dst), len);
+  return fileStream.gcount() == len;
+}
+
+std::shared_ptr<Sample> RtpHandler::readSample(
+  std::ifstream& fileStream, const std::string& filePath, int64_t offset, int64_t len
+) noexcept {
+  auto samplePtr = std::make_shared<Sample>();
+  samplePtr->buf.resize(len);
+  const int64_t readStartTimeNs = Util::getElapsedTimeNanoSec();
+  if (!readBytes(fileStream, filePath, offset, len, samplePtr->buf.data())) {
+    samplePtr->refCount = C::INVALID;
+  }
+  HotPathMetrics::getShared().sampleReadUs.record((Util::getElapsedTimeNanoSec() - readStartTimeNs) / 1000);
+  return samplePtr;
+}
@@ -4,7 +4,9 @@
 #include "../../include/Session.h"
 #include "../include/HybridSampleMeta.h"
 #include "../include/RtpHandler.h"
+#include "../include/RtspResponseWriter.h"
 
+#include <array>
 #include <cmath>
 #include <iostream>
 
@@ -19,40 +21,67 @@ RtspHandler::RtspHandler(
 
 RtspHandler::~RtspHandler() = default;
 
-void RtspHandler::run(Buffer& inputBuffer) {
-  std::string req = inputBuffer.getString();
+void RtspHandler::run(const RtspRequest& request, Buffer& outputBuffer) {
   logger->warning("Dongvin, " + sessionId + ", rtsp req: ");
-  for (auto& reqLine : Util::splitToVecByStringForRtspMsg(req, C::CRLF)) {
-    logger->info(reqLine);
+  std::string_view rest = request.raw;
+  while (!rest.empty()) {
+    const size_t lineEnd = rest.find(C::CRLF);
+    const std::string_view reqLine = rest.substr(0, lineEnd);
+    if (!reqLine.empty()) logger->info(std::string(reqLine));
+    rest.remove_prefix(lineEnd == std::string_view::npos ? rest.size() : lineEnd + 2);
   }
   std::cout << "\n";
 
-  handleRtspRequest(req, inputBuffer);
+  handleRtspRequest(request, outputBuffer);
 }
 
-void RtspHandler::handleRtspRequest(
-  std::string reqStr, Buffer& inputBuffer
-) {
-  int idx = reqStr.find(' ');
-  std::string method = reqStr.substr(0, idx);
-  if (std::find(C::RTSP_METHOD_VECTOR.begin(), C::RTSP_METHOD_VECTOR.end(), method) == C::RTSP_METHOD_VECTOR.end()) {
-    logger->severe("Dongvin, not implemented method! : " + method);
-    respondError(inputBuffer, C::METHOD_NOT_ALLOWED, method);
+std::string RtspHandler::findRequestedContent(const RtspRequest& request) {
+  if (!request.isValid || request.method != "OPTIONS") return C::EMPTY_STRING;
+  return findContents(request.url);
+}
+
+RtspHandler::MethodHandler RtspHandler::findMethodHandler(std::string_view method) {
+  // same methods as C::RTSP_METHOD_VECTOR.
+  static const std::array<std::pair<std::string_view, MethodHandler>, 7> METHOD_TABLE = {{
+    {"DESCRIBE", &RtspHandler::handleDescribe},
+    {"SETUP", &RtspHandler::handleSetup},
+    {"PLAY", &RtspHandler::handlePlay},
+    {"PAUSE", &RtspHandler::handlePause},
+    {"TEARDOWN", &RtspHandler::handleTeardown},
+    {"SET_PARAMETER", &RtspHandler::handleSetParameter},
+    {"OPTIONS", &RtspHandler::handleOptions}
+  }};
+  for (const auto& [methodName, methodHandler] : METHOD_TABLE) {
+    if (methodName == method) return methodHandler;
+  }
+  return nullptr;
+}
+
+void RtspHandler::handleRtspRequest(const RtspRequest& request, Buffer& inputBuffer) {
+  if (!request.isValid) {
+    logger->severe("Dongvin, malformed rtsp request!");
+    respondError(inputBuffer, C::BAD_REQUEST, std::string(request.method));
     return;
   }
 
-  std::vector<std::string> strings = Util::splitToVecByStringForRtspMsg(reqStr, C::CRLF);
-  int _cSeq = findCSeq(strings);
+  const MethodHandler methodHandler = findMethodHandler(request.method);
+  if (methodHandler == nullptr) {
+    logger->severe("Dongvin, not implemented method! : " + std::string(request.method));
+    respondError(inputBuffer, C::METHOD_NOT_ALLOWED, std::string(request.method));
+    return;
+  }
+
+  int _cSeq = findCSeq(request);
   if (_cSeq == -1) {
     // invalid CSeq. bad req.
     logger->severe("Dongvin, failed to find CSeq header!");
-    respondError(inputBuffer, C::BAD_REQUEST, method);
+    respondError(inputBuffer, C::BAD_REQUEST, std::string(request.method));
     return;
   }
   int next = cSeq + 1;
   if (next != _cSeq) {
     logger->severe("Dongvin, bad sequence number! server side/client side : " + std::to_string(next) + "/" + std::to_string(_cSeq));
-    respondError(inputBuffer, C::BAD_REQUEST, method);
+    respondError(inputBuffer, C::BAD_REQUEST, std::string(request.method));
     return;
   }
 
@@ -61,7 +90,7 @@ void RtspHandler::handleRtspRequest(
       // do not allowed proceeding without session id once session is set up.
       // Once session id is given to a client, all the following requests must
       // include the session id in the request.
-      if (inSession && !hasSessionId(strings)) {
+      if (inSession && !hasSessionId(request)) {
         wrongSessionIdRequestCnt++;
         if (wrongSessionIdRequestCnt >= C::WRONG_SESSION_ID_TOLERANCE_CNT) {
           // some kind of punks are sending wrong requests on the port assigned to
@@ -80,396 +109,422 @@ void RtspHandler::handleRtspRequest(
           return;
         }
         logger->severe("Dongvin, failed to find session id!");
-        respondError(inputBuffer, C::BAD_REQUEST, method);
+        respondError(inputBuffer, C::BAD_REQUEST, std::string(request.method));
         return;
       }
 
       cSeq = _cSeq;
 
-      if (method == "OPTIONS") {
-        sessionPtr->updateOptionsReqTimeMillis(
-          Util::getCurrentTimeMillis()
-        );
-        if (isThereMonitoringInfoHeader(strings)) {
-          // t: NTP time at which OPTION method was sent. (ms)
-          // sa: The amount of samples received by the client. (bitrate, utc time(ms))
-          // sr: The rate at which the client receives samples. (rate, utc time(ms))
-          // e.g. MonitoringInfo: t=1719479800907;sa=7731176,1719479798405,1099016,1719479799406;sr=32040696,1719479798387,25152971,1719479798487
-          std::string info = strings[strings.size()-1];
-          std::vector<std::string> words =
-            Util::splitToVecBySingleChar(
-              Util::trim( Util::splitToVecBySingleChar(info, ':')[1] ), ';'
-            );
-
-          for (std::string w : words) {
-            if (w.rfind("rb", 0) == 0) {
-              std::vector<std::string> bitrateAndTime =
-                Util::splitToVecBySingleChar(
-                  Util::splitToVecBySingleChar(w, '=')[1], ','
-                );
-
-              for (auto i=0; i < bitrateAndTime.size(); i+=2) {
-                RxBitrate rxBitrate(
-                  std::stoll(bitrateAndTime[i]), std::stoll(bitrateAndTime[i+1])
-                );
-                sessionPtr->addRxBitrate(rxBitrate);
-              }
-
-            }
-          }
-        }
+      // dispatch through the method table.
+      (this->*methodHandler)(request, inputBuffer, sessionPtr, ptrForStreamHandler);
+      return;
+    }
+    logger->severe("Dongvin, failed to get weak StreamHandler ptr!");
+    respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, std::string(request.method));
+    return;
+  }
+  logger->severe("Dongvin, failed to get weak session ptr!");
+  respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, std::string(request.method));
+}// end of handleRtspRequest();
 
-        userName = findUserName(strings);
-        std::string cid = findContents(strings[0]);
-        if (sessionPtr->onCid(cid)) {
-          respondOptions(inputBuffer);
-          return;
-        }
-        logger->severe("Dongvin, server doesn't have content : " + cid);
-        respondError(inputBuffer, C::BAD_REQUEST, method);
-        return;
-      } else if (method == "DESCRIBE") {
-        // assume url and username are correct or same. Don't check again.
-        std::string fullCid = Util::splitToVecBySingleChar(strings[0], ' ')[1];
-        std::string mediaInfo = getMediaInfo(fullCid);
-        respondDescribe(inputBuffer, mediaInfo);
-      } else if (method == "SETUP") {
-        // assume url and username are correct or same. Don't check again.
-        std::string transport = findTransport(strings);
-        std::string hybridMode = findHybridMode(strings);
-        std::string notToTxList = findNotTx(strings);
-        if (transport == C::EMPTY_STRING && hybridMode == C::EMPTY_STRING) {
-          logger->severe("Dongvin, invalid SETUP header!");
-          respondError(inputBuffer, C::BAD_REQUEST, method);
-          return;
-        }
+void RtspHandler::handleOptions(
+  const RtspRequest& request, Buffer& inputBuffer,
+  const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& /*ptrForStreamHandler*/
+) {
+  sessionPtr->updateOptionsReqTimeMillis(
+    Util::getCurrentTimeMillis()
+  );
+  if (isThereMonitoringInfoHeader(request)) {
+    // t: NTP time at which OPTION method was sent. (ms)
+    // sa: The amount of samples received by the client. (bitrate, utc time(ms))
+    // sr: The rate at which the client receives samples. (rate, utc time(ms))
+    // e.g. MonitoringInfo: t=1719479800907;sa=7731176,1719479798405,1099016,1719479799406;sr=32040696,1719479798387,25152971,1719479798487
+    std::string_view bitrateAndTime = Util::findParamValue(request.getHeader("MonitoringInfo"), "rb");
+    while (!bitrateAndTime.empty()) {
+      const size_t bitrateEnd = bitrateAndTime.find(',');
+      if (bitrateEnd == std::string_view::npos) break;
+      const size_t timeEnd = bitrateAndTime.find(',', bitrateEnd + 1);
+      int64_t bitrate = 0;
+      int64_t utcTimeMillis = 0;
+      if (
+        Util::parseNumber(bitrateAndTime.substr(0, bitrateEnd), bitrate)
+        && Util::parseNumber(bitrateAndTime.substr(bitrateEnd + 1, timeEnd - bitrateEnd - 1), utcTimeMillis)
+      ) {
+        RxBitrate rxBitrate(bitrate, utcTimeMillis);
+        sessionPtr->addRxBitrate(rxBitrate);
+      }
+      bitrateAndTime.remove_prefix(timeEnd == std::string_view::npos ? bitrateAndTime.size() : timeEnd + 1);
+    }
+  }
 
-        if (transport != C::EMPTY_STRING && hybridMode == C::EMPTY_STRING) {
-          // process the setup req on track ids.
-          int trackId = findTrackId(strings[0]);
-          std::vector<int> channels = findChannels(transport);
-
-          // don't make new thread for reading member videos.
-          // the thread reading ref front video samples must read the member video samples too.
-          if (trackId <= C::AUDIO_ID) {
-            sessionPtr->onChannel(trackId, channels);
-          }
-
-          int ssrcIdx;
-          if (trackId > C::AUDIO_ID) {
-            ssrcIdx = C::VIDEO_ID;
-          } else {
-            ssrcIdx = trackId;
-          }
-
-          // dongvin : record content's title at Session object.
-          if (sessionPtr->getContentTitle() == C::EMPTY_STRING) {
-            std::string contentTitle = getContentsTitle(ptrForStreamHandler->getStreamUrls());
-            if (contentTitle != C::EMPTY_STRING) {
-              sessionPtr->updateContentTitleOfCurSession(contentTitle);
-            }
-          }
-
-          std::vector<int64_t> ssrc = ptrForStreamHandler->getSsrc();
-          respondSetup(
-            inputBuffer, transport, sessionId, ssrc[ssrcIdx], trackId,
-            sessionPtr->getRefVideoSampleCnt(), sessionPtr->getNumberOfCamDirectories()
-          );
-          return;
-        } else {
-          // process not tx sample numbers for hybrid D & S.
-          parseHybridVideoSampleMetaDataForDandS(notToTxList);
-          respondSetupForHybrid(inputBuffer, sessionId, hybridMode);
-          return;
-        }
-      } else if (method == "PLAY") {
-        if (isContainingPlayInfoHeader((strings))) {
-          // dongvin : receiving play req to resume play from pause state
-
-          if (sessionPtr->getPauseStatus()) {
-            // if session is in pause state
-
-            // 헤더를 파싱해서 클라이언트가 PAUSE 요청 날리기 직전까지 수신 완료한 가장 최근 샘플의 idx들을 알아낸다.
-            // Jenny, sample index can be -1
-            int receivedVideoSampleIdx = findLatestReceivedSampleIdx(strings, "videoIndex");
-            int receivedAudioSampleIdx = findLatestReceivedSampleIdx(strings, "audioIndex");
-            int receivedVideoRtpIdx = findLatestReceivedSampleIdx(strings, "videoRtpIndex");
-
-            // video & audio readInfo 내의 curSampeNo를 초기화 한다.
-            // received idx 들은 클라이언트가 이미 수신 완료한 것이므로, 이것 바로 다음 샘플부터 보내게 만든다.
-            if(receivedVideoSampleIdx != -1) ptrForStreamHandler->updateCurSampleNo(
-              C::VIDEO_ID, receivedVideoSampleIdx + 1
-            );
-            if(receivedAudioSampleIdx != -1) ptrForStreamHandler->updateCurSampleNo(
-              C::AUDIO_ID, receivedAudioSampleIdx + 1
-            );
-
-            if (receivedVideoRtpIdx > 0) {
-              ptrForStreamHandler->updateRtpRemoteCnt(receivedVideoRtpIdx);
-            }
-          }
-          respondPlayAfterPause(inputBuffer);
-          sessionPtr->updatePauseStatus(false);
-          return;
-        } else if (isSeekRequest(strings)) {
-          // dongvin, play req for Seek operation
-          sessionPtr->updatePauseStatus(false);
-          sessionPtr->stopCurrentMediaReadingTasks(true);
-
-          std::vector<float> npt = findNormalPlayTime(strings);
-          if (npt.empty() || !isValidPlayTime(npt)) {
-            std::string nptElem = "[";
-            for (float f : npt) {
-              nptElem += std::to_string(f);
-              nptElem += ",";
-            }
-            nptElem += "]";
-            logger->severe("Dongvin, invalid npt in play req for seek : " + nptElem);
-            respondError(inputBuffer, C::BAD_REQUEST, method);
-            return;
-          }
-          // valid npt
-          sessionPtr->onUserRequestingPlayTime(npt);
-
-          std::vector<int64_t> timestamp0 = ptrForStreamHandler->getTimestamp();
-          respondPlay(inputBuffer, timestamp0, sessionId);
-
-          Util::delayedExecutorAsyncByIoContext(
-            sessionPtr->getIoContext(),
-            C::DELAY_BEFORE_RTP_START_ON_SEEK,
-            [sessionPtr](){sessionPtr->onPlayStart();}
-          );
-          return;
-        } else {
-          // dongvin, process initial play req.
-          sessionPtr->updatePlayTimeDurationMillis(
-            std::max(
-              ptrForStreamHandler->getPlayTimeUs(C::VIDEO_ID)/1000,
-              ptrForStreamHandler->getPlayTimeUs(C::AUDIO_ID)/1000
-            )
-          );
+  userName = findUserName(request);
+  std::string cid = findContents(request.url);
+  if (sessionPtr->onCid(cid)) {
+    respondOptions(inputBuffer);
+    return;
+  }
+  logger->severe("Dongvin, server doesn't have content : " + cid);
+  respondError(inputBuffer, C::BAD_REQUEST, "OPTIONS");
+}
 
-          std::vector<float> npt = findNormalPlayTime(strings);
-
-          if (!isLookingSampleControInUse(strings)){
-            sessionPtr->updatePFrameTxStatus(true);
-          }
-
-          if (sessionPtr->getDeviceModelNo() == C::EMPTY_STRING) {
-            std::string deviceName = findDeviceModelName(strings);
-            if (deviceName != C::EMPTY_STRING) {
-              sessionPtr->updateDeviceModelNo(deviceName);
-            }
-          }
-
-          if (sessionPtr->getManufacturer() == C::EMPTY_STRING) {
-            std::string manufacturer = findManufacturer(strings);
-            if (manufacturer != C::EMPTY_STRING) {
-              sessionPtr->updateManufacturer(manufacturer);
-            }
-          }
-
-          if (npt.empty() || !isValidPlayTime(npt)) {
-            std::string nptElem = "[";
-            for (float f : npt) {
-              nptElem += std::to_string(f);
-              nptElem += ",";
-            }
-            nptElem += "]";
-            logger->severe("Dongvin, invalid npt in play req for initial play : " + nptElem);
-            respondError(inputBuffer, C::BAD_REQUEST, method);
-            return;
-          } else {
-
-            // open all video and audio std::ifstream.
-            std::weak_ptr<RtpHandler> weakPtr = sessionPtr->getRtpHandlerPtr();
-            if (auto rtpHandlePtr = weakPtr.lock()) {
-              if (bool initResult = rtpHandlePtr->openAllFileStreamsForVideoAndAudio(); !initResult) {
-                logger->severe("Dongvin, failed to open video/audio file stream! session id : " + sessionId);
-                respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, method);
-                return;
-              }
-            } else {
-              logger->severe("Dongvin, failed to get RtpHandler ptr!");
-              respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, method);
-              return;
-            }
-
-            if (auto handlePtr = streamHandlerPtr.lock()){
-              if (
-                bool cacheResult = handlePtr->setVideoAudioSampleMetaDataCache(sessionPtr->getContentTitle());
-                !cacheResult
-              ) {
-                logger->severe("Dongvin, failed to init cache video and audio sample meta data!");
-                respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, method);
-                return;
-              }
-            } else{
-              logger->severe("Dongvin, failed to get streamHandler ptr!");
-              respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, method);
-              return;
-            }
-
-            ptrForStreamHandler->setCamId(0);
-            sessionPtr->onUserRequestingPlayTime(npt);
-
-            std::vector<int64_t> timestamp0 = ptrForStreamHandler->getTimestamp();
-            respondPlay(inputBuffer, timestamp0, sessionId);
-
-            Util::delayedExecutorAsyncByIoContext(
-              sessionPtr->getIoContext(),
-              C::DELAY_BEFORE_RTP_START,
-              [sessionPtr](){sessionPtr->onPlayStart();}
-            );
-
-            sessionPtr->updatePauseStatus(false);
-            return;
-          }
-          inSession = true;
-        }// end of else for initial play
-      } else if (method == "PAUSE") {
-        // dongvin, if pause req come at puase state, just return 200 OK response.
-        if (sessionPtr->getPauseStatus()) {
-          respondPause(inputBuffer);
-          return;
-        }
-        sessionPtr->updatePauseStatus(true);
-        respondPause(inputBuffer);
-        return;
-      } else if (method == "TEARDOWN") {
-        respondTeardown(inputBuffer);
-        inSession = false;
-        wrongSessionIdRequestCnt = 0;
-        return;
-      } else if (method == "SET_PARAMETER") {
-        // last string is the switching info.
-        // for instance, SwitchingInfo: next=1;tv=1234567;ta=45678900
-        // CameraInfo: cam=0;next=1;tv=1234567;ta=45678900
-
-        const std::string& info = strings[strings.size() - 1];
-        std::vector<std::string> words = Util::splitToVecBySingleChar(
-          Util::trim(Util::splitToVecBySingleChar(info, ':')[1]), ';'
-        );
+void RtspHandler::handleDescribe(
+  const RtspRequest& request, Buffer& inputBuffer,
+  const std::shared_ptr<Session>& /*sessionPtr*/, const std::shared_ptr<StreamHandler>& /*ptrForStreamHandler*/
+) {
+  // assume url and username are correct or same. Don't check again.
+  std::string fullCid(request.url);
+  std::string mediaInfo = getMediaInfo(fullCid);
+  respondDescribe(inputBuffer, mediaInfo);
 
-        // tvIdx : video's sample time index in client side
-        // taIdx : audio's sample time index in client side
-
-        int64_t tvIdx = C::UNSET;
-        int64_t taIdx = C::UNSET;
-        int nextVid = C::UNSET;
-        int cam = C::UNSET;
-        int targetBitrate = C::UNSET;
-        bool sampleLimitForPauseSwitching = false;
-        std::string pFrameControlAction = C::EMPTY_STRING;
-        for (std::string w : words) {
-          if(w.rfind("tvIdx", 0) == 0) tvIdx = std::stoll(Util::splitToVecBySingleChar(w, '=')[1]);
-          else if(w.rfind("taIdx", 0) == 0) taIdx = std::stoll(Util::splitToVecBySingleChar(w, '=')[1]);
-          else if(w.rfind("next", 0) == 0) nextVid = std::stoi(Util::splitToVecBySingleChar(w, '=')[1]);
-          else if(w.rfind("cam", 0) == 0) cam = std::stoi(Util::splitToVecBySingleChar(w, '=')[1]);
-          else if(w.rfind("tBit", 0) == 0) targetBitrate = std::stoi(Util::splitToVecBySingleChar(w, '=')[1]);
-          else if(w.rfind("limitSamples", 0) == 0) {
-            std::string boolStr = Util::splitToVecBySingleChar(w, '=')[1];
-            sampleLimitForPauseSwitching = boolStr == "true" ? true : false;
-          }
-          else if(w.find("-p") != std::string::npos ) pFrameControlAction = w;
-        }
-        std::vector<int64_t> switchingInfo = {tvIdx, taIdx};
+  if (!inputBuffer.getString().empty()) {
+    logger->info("Dongvin, id : " + sessionId + ", rtsp response: \n" + inputBuffer.getString());
+  }
+}
 
-        logger->info2(
-          "Dongvin, id:"+sessionId+", switching request comes in!, " +
-              "cam: "+ std::to_string(cam)+"vid: "+std::to_string(nextVid)+", time: "
-              + "["+std::to_string(switchingInfo[0])+","+std::to_string(switchingInfo[1])+"] (us)"
-        );
+void RtspHandler::handleSetup(
+  const RtspRequest& request, Buffer& inputBuffer,
+  const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& ptrForStreamHandler
+) {
+  // assume url and username are correct or same. Don't check again.
+  std::string_view transport = findTransport(request);
+  std::string_view hybridMode = findHybridMode(request);
+  std::string_view notToTxList = findNotTx(request);
+  if (transport.empty() && hybridMode.empty()) {
+    logger->severe("Dongvin, invalid SETUP header!");
+    respondError(inputBuffer, C::BAD_REQUEST, "SETUP");
+    return;
+  }
 
-        bool isValid = false;
-        if (info.find(C::CAM_CHANG_KEY) != std::string::npos) {
-          sessionPtr->updateIsInCamSwitching(true);
-          int maxCam = ptrForStreamHandler->getMaxCamNumber();
-          int maxVnum = ptrForStreamHandler->getMainVideoNumber();
-          isValid = cam < maxCam && nextVid < maxVnum;
-          if (!isValid) {
-            logger->info("Dongvin, invalid next id or video id for cam change!");
-            sessionPtr->updateIsInCamSwitching(false);
-            respondError(inputBuffer, C::BAD_REQUEST, method);
-            return;
-          }
-          respondCameraChange(inputBuffer, cam);
-          sessionPtr->onCameraChange(cam, nextVid, switchingInfo);
-          Util::delayedExecutorAsyncByIoContext(
-              sessionPtr->getIoContext(),
-              C::UPDATE_CAM_SWITCHING_STATUS_DELAY_MILLIS,
-              [sessionPtr](){sessionPtr->updateIsInCamSwitching(false);}
-          );
-          return;
-        } else if (info.find(C::P_FRAME_KEY) != std::string::npos) {
-          logger->info2(
-            "Dongvin, id:" + sessionId+", looking sample control request comes in! : " + pFrameControlAction
-          );
-          bool pFrameTxMode = pFrameControlAction == C::SEND_P_FRAMES ? true : false;
-          sessionPtr->updatePFrameTxStatus(pFrameTxMode);
-          respondPFrameControl(inputBuffer, pFrameTxMode);
-          return;
-        } else {
-          logger->info("Dongvin, invalid set_parameter header!");
-          respondError(inputBuffer, C::BAD_REQUEST, method);
+  if (!transport.empty() && hybridMode.empty()) {
+    // process the setup req on track ids.
+    int trackId = findTrackId(request.url);
+    std::vector<int> channels = findChannels(transport);
+    if (trackId == C::INVALID || channels.size() != 2) {
+      logger->severe("Dongvin, invalid track id or interleaved channels in SETUP!");
+      respondError(inputBuffer, C::BAD_REQUEST, "SETUP");
+      return;
+    }
+
+    // don't make new thread for reading member videos.
+    // the thread reading ref front video samples must read the member video samples too.
+    if (trackId <= C::AUDIO_ID) {
+      sessionPtr->onChannel(trackId, channels);
+    }
+
+    int ssrcIdx;
+    if (trackId > C::AUDIO_ID) {
+      ssrcIdx = C::VIDEO_ID;
+    } else {
+      ssrcIdx = trackId;
+    }
+
+    // dongvin : record content's title at Session object.
+    if (sessionPtr->getContentTitle() == C::EMPTY_STRING) {
+      std::string contentTitle = getContentsTitle(ptrForStreamHandler->getStreamUrls());
+      if (contentTitle != C::EMPTY_STRING) {
+        sessionPtr->updateContentTitleOfCurSession(contentTitle);
+      }
+    }
+
+    std::vector<int64_t> ssrc = ptrForStreamHandler->getSsrc();
+    respondSetup(
+      inputBuffer, std::string(transport), sessionId, ssrc[ssrcIdx], trackId,
+      sessionPtr->getRefVideoSampleCnt(), sessionPtr->getNumberOfCamDirectories()
+    );
+  } else {
+    // process not tx sample numbers for hybrid D & S.
+    parseHybridVideoSampleMetaDataForDandS(std::string(notToTxList));
+    respondSetupForHybrid(inputBuffer, sessionId, std::string(hybridMode));
+  }
+}
+
+void RtspHandler::handlePlay(
+  const RtspRequest& request, Buffer& inputBuffer,
+  const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& ptrForStreamHandler
+) {
+  const std::string method = "PLAY";
+  // every kind of play needs the files and timers which a parked session released.
+  if (const int unparkStatus = sessionPtr->unpark(); unparkStatus != C::OK) {
+    respondError(inputBuffer, unparkStatus, method);
+    return;
+  }
+  if (isContainingPlayInfoHeader(request)) {
+    // dongvin : receiving play req to resume play from pause state
+
+    if (sessionPtr->getPauseStatus()) {
+      // if session is in pause state
+
+      // 헤더를 파싱해서 클라이언트가 PAUSE 요청 날리기 직전까지 수신 완료한 가장 최근 샘플의 idx들을 알아낸다.
+      // Jenny, sample index can be -1
+      int receivedVideoSampleIdx = findLatestReceivedSampleIdx(request, "videoIndex");
+      int receivedAudioSampleIdx = findLatestReceivedSampleIdx(request, "audioIndex");
+      int receivedVideoRtpIdx = findLatestReceivedSampleIdx(request, "videoRtpIndex");
+
+      // video & audio readInfo 내의 curSampeNo를 초기화 한다.
+      // received idx 들은 클라이언트가 이미 수신 완료한 것이므로, 이것 바로 다음 샘플부터 보내게 만든다.
+      if(receivedVideoSampleIdx != -1) ptrForStreamHandler->updateCurSampleNo(
+        C::VIDEO_ID, receivedVideoSampleIdx + 1
+      );
+      if(receivedAudioSampleIdx != -1) ptrForStreamHandler->updateCurSampleNo(
+        C::AUDIO_ID, receivedAudioSampleIdx + 1
+      );
+
+      if (receivedVideoRtpIdx > 0) {
+        ptrForStreamHandler->updateRtpRemoteCnt(receivedVideoRtpIdx);
+      }
+    }
+    respondPlayAfterPause(inputBuffer);
+    sessionPtr->updatePauseStatus(false);
+    if (sessionPtr->getPlayRestartStatus()) {
+      // parked while paused. the reading tracks start again from the resume position.
+      sessionPtr->schedulePlayStart(inputBuffer, C::ZERO);
+    }
+    return;
+  } else if (isSeekRequest(request)) {
+    // dongvin, play req for Seek operation
+    sessionPtr->updatePauseStatus(false);
+    sessionPtr->stopCurrentMediaReadingTasks(true);
+
+    std::vector<float> npt = findNormalPlayTime(request);
+    if (npt.empty() || !isValidPlayTime(npt)) {
+      std::string nptElem = "[";
+      for (float f : npt) {
+        nptElem += std::to_string(f);
+        nptElem += ",";
+      }
+      nptElem += "]";
+      logger->severe("Dongvin, invalid npt in play req for seek : " + nptElem);
+      respondError(inputBuffer, C::BAD_REQUEST, method);
+      return;
+    }
+    // valid npt
+    sessionPtr->onUserRequestingPlayTime(npt);
+
+    std::vector<int64_t> timestamp0 = ptrForStreamHandler->getTimestamp();
+    respondPlay(inputBuffer, timestamp0, sessionId);
+    sessionPtr->schedulePlayStart(inputBuffer, C::DELAY_BEFORE_RTP_START_ON_SEEK);
+    return;
+  } else {
+    // dongvin, process initial play req.
+    sessionPtr->updatePlayTimeDurationMillis(
+      std::max(
+        ptrForStreamHandler->getPlayTimeUs(C::VIDEO_ID)/1000,
+        ptrForStreamHandler->getPlayTimeUs(C::AUDIO_ID)/1000
+      )
+    );
+
+    std::vector<float> npt = findNormalPlayTime(request);
+
+    if (!isLookingSampleControInUse(request)){
+      sessionPtr->updatePFrameTxStatus(true);
+    }
+
+    if (sessionPtr->getDeviceModelNo() == C::EMPTY_STRING) {
+      std::string_view deviceName = findDeviceModelName(request);
+      if (!deviceName.empty()) {
+        sessionPtr->updateDeviceModelNo(std::string(deviceName));
+      }
+    }
+
+    if (sessionPtr->getManufacturer() == C::EMPTY_STRING) {
+      std::string_view manufacturer = findManufacturer(request);
+      if (!manufacturer.empty()) {
+        sessionPtr->updateManufacturer(std::string(manufacturer));
+      }
+    }
+
+    if (npt.empty() || !isValidPlayTime(npt)) {
+      std::string nptElem = "[";
+      for (float f : npt) {
+        nptElem += std::to_string(f);
+        nptElem += ",";
+      }
+      nptElem += "]";
+      logger->severe("Dongvin, invalid npt in play req for initial play : " + nptElem);
+      respondError(inputBuffer, C::BAD_REQUEST, method);
+      return;
+    } else {
+
+      // open all video and audio std::ifstream.
+      std::weak_ptr<RtpHandler> weakPtr = sessionPtr->getRtpHandlerPtr();
+      if (auto rtpHandlePtr = weakPtr.lock()) {
+        if (bool initResult = rtpHandlePtr->openAllFileStreamsForVideoAndAudio(); !initResult) {
+          logger->severe("Dongvin, failed to open video/audio file stream! session id : " + sessionId);
+          respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, method);
           return;
         }
       } else {
-        logger->warning("Dongvin, invalid or not implemented method: " + method);
-        respondError(inputBuffer, C::BAD_REQUEST, method);
+        logger->severe("Dongvin, failed to get RtpHandler ptr!");
+        respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, method);
         return;
       }
 
-      if (!inputBuffer.getString().empty()) {
-        logger->info("Dongvin, id : " + sessionId + ", rtsp response: \n" + inputBuffer.getString());
+      if (auto handlePtr = streamHandlerPtr.lock()){
+        if (
+          bool cacheResult = handlePtr->setVideoAudioSampleMetaDataCache(sessionPtr->getContentTitle());
+          !cacheResult
+        ) {
+          logger->severe("Dongvin, failed to init cache video and audio sample meta data!");
+          respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, method);
+          return;
+        }
+      } else{
+        logger->severe("Dongvin, failed to get streamHandler ptr!");
+        respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, method);
+        return;
       }
+
+      ptrForStreamHandler->setCamId(0);
+      sessionPtr->onUserRequestingPlayTime(npt);
+
+      std::vector<int64_t> timestamp0 = ptrForStreamHandler->getTimestamp();
+      respondPlay(inputBuffer, timestamp0, sessionId);
+      sessionPtr->schedulePlayStart(inputBuffer, C::DELAY_BEFORE_RTP_START);
+
+      sessionPtr->updatePauseStatus(false);
       return;
     }
-    logger->severe("Dongvin, failed to get weak StreamHandler ptr!");
-    respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, method);
+    inSession = true;
+  }// end of else for initial play
+}
+
+void RtspHandler::handlePause(
+  const RtspRequest& /*request*/, Buffer& inputBuffer,
+  const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& /*ptrForStreamHandler*/
+) {
+  // dongvin, if pause req come at puase state, just return 200 OK response.
+  if (sessionPtr->getPauseStatus()) {
+    respondPause(inputBuffer);
     return;
   }
-  logger->severe("Dongvin, failed to get weak session ptr!");
-  respondError(inputBuffer, C::INTERNAL_SERVER_ERROR, method);
-}// end of handleRtspRequest();
+  sessionPtr->updatePauseStatus(true);
+  respondPause(inputBuffer);
+}
 
-bool RtspHandler::hasSessionId(const std::vector<std::string>& strings) {
-  std::string _sessionId = findSessionId(strings);
-  logger->info("Dongvin, session in rtsp request " + _sessionId);
-  return (!_sessionId.empty() && _sessionId == sessionId);
+void RtspHandler::handleTeardown(
+  const RtspRequest& /*request*/, Buffer& inputBuffer,
+  const std::shared_ptr<Session>& /*sessionPtr*/, const std::shared_ptr<StreamHandler>& /*ptrForStreamHandler*/
+) {
+  respondTeardown(inputBuffer);
+  inSession = false;
+  wrongSessionIdRequestCnt = 0;
 }
 
-void RtspHandler::respondOptions(Buffer &buffer) {
-  std::string rsp;
+void RtspHandler::handleSetParameter(
+  const RtspRequest& request, Buffer& inputBuffer,
+  const std::shared_ptr<Session>& sessionPtr, const std::shared_ptr<StreamHandler>& ptrForStreamHandler
+) {
+  const std::string method = "SET_PARAMETER";
+  // for instance, SwitchingInfo: next=1;tv=1234567;ta=45678900
+  // CameraInfo: cam=0;next=1;tv=1234567;ta=45678900
+  const auto [infoKey, info] = findSetParameterInfo(request);
+
+  // tvIdx : video's sample time index in client side
+  // taIdx : audio's sample time index in client side
+
+  int64_t tvIdx = C::UNSET;
+  int64_t taIdx = C::UNSET;
+  int nextVid = C::UNSET;
+  int cam = C::UNSET;
+  int targetBitrate = C::UNSET;
+  bool sampleLimitForPauseSwitching = false;
+  std::string_view pFrameControlAction;
+  std::string_view words = info;
+  while (!words.empty()) {
+    const size_t wordEnd = words.find(';');
+    const std::string_view w = Util::trimView(words.substr(0, wordEnd));
+    words.remove_prefix(wordEnd == std::string_view::npos ? words.size() : wordEnd + 1);
+
+    const size_t eq = w.find('=');
+    const std::string_view value = eq == std::string_view::npos ? std::string_view{} : w.substr(eq + 1);
+    if(w.rfind("tvIdx", 0) == 0) Util::parseNumber(value, tvIdx);
+    else if(w.rfind("taIdx", 0) == 0) Util::parseNumber(value, taIdx);
+    else if(w.rfind("next", 0) == 0) Util::parseNumber(value, nextVid);
+    else if(w.rfind("cam", 0) == 0) Util::parseNumber(value, cam);
+    else if(w.rfind("tBit", 0) == 0) Util::parseNumber(value, targetBitrate);
+    else if(w.rfind("limitSamples", 0) == 0) sampleLimitForPauseSwitching = Util::trimView(value) == "true";
+    else if(w.find("-p") != std::string_view::npos ) pFrameControlAction = w;
+  }
+  std::vector<int64_t> switchingInfo = {tvIdx, taIdx};
 
-  rsp = "RTSP/1.0 200 OK" + std::string{C::CRLF};
-  rsp += "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF};
+  logger->info2(
+    "Dongvin, id:"+sessionId+", switching request comes in!, " +
+        "cam: "+ std::to_string(cam)+"vid: "+std::to_string(nextVid)+", time: "
+        + "["+std::to_string(switchingInfo[0])+","+std::to_string(switchingInfo[1])+"] (us)"
+  );
 
-  std::string rtspMethods = "Public: ";
-  const auto loopCnt = C::RTSP_METHOD_VECTOR.size();
-  for (int i=0; i<loopCnt; i++) {
-    rtspMethods += C::RTSP_METHOD_VECTOR[i];
-    if (i < (loopCnt-1)) rtspMethods += ",";
+  bool isValid = false;
+  if (infoKey == C::CAM_CHANG_KEY) {
+    sessionPtr->updateIsInCamSwitching(true);
+    int maxCam = ptrForStreamHandler->getMaxCamNumber();
+    int maxVnum = ptrForStreamHandler->getMainVideoNumber();
+    isValid = cam < maxCam && nextVid < maxVnum;
+    if (!isValid) {
+      logger->info("Dongvin, invalid next id or video id for cam change!");
+      sessionPtr->updateIsInCamSwitching(false);
+      respondError(inputBuffer, C::BAD_REQUEST, method);
+      return;
+    }
+    // the switch reads the files which a parked session released.
+    if (const int unparkStatus = sessionPtr->unpark(); unparkStatus != C::OK) {
+      sessionPtr->updateIsInCamSwitching(false);
+      respondError(inputBuffer, unparkStatus, method);
+      return;
+    }
+    respondCameraChange(inputBuffer, cam);
+    sessionPtr->onCameraChange(cam, nextVid, switchingInfo);
+    Util::delayedExecutorAsyncByIoContext(
+        sessionPtr->getIoContext(),
+        C::UPDATE_CAM_SWITCHING_STATUS_DELAY_MILLIS,
+        [sessionPtr](){sessionPtr->updateIsInCamSwitching(false);}
+    );
+    return;
+  } else if (infoKey == C::P_FRAME_KEY) {
+    logger->info2(
+      "Dongvin, id:" + sessionId+", looking sample control request comes in! : " + std::string(pFrameControlAction)
+    );
+    bool pFrameTxMode = pFrameControlAction == C::SEND_P_FRAMES ? true : false;
+    sessionPtr->updatePFrameTxStatus(pFrameTxMode);
+    respondPFrameControl(inputBuffer, pFrameTxMode);
+    return;
+  } else {
+    logger->info("Dongvin, invalid set_parameter header!");
+    respondError(inputBuffer, C::BAD_REQUEST, method);
+    return;
   }
+}
+
+bool RtspHandler::hasSessionId(const RtspRequest& request) {
+  std::string_view _sessionId = findSessionId(request);
+  logger->info("Dongvin, session in rtsp request " + std::string(_sessionId));
+  return (!_sessionId.empty() && _sessionId == sessionId);
+}
 
-  rsp += rtspMethods + std::string{C::CRLF};
-  rsp += "Server: " + std::string{C::MY_NAME} + std::string{C::CRLF2};
+void RtspHandler::respondOptions(Buffer &buffer) {
+  // same for every response. joined once.
+  static const std::string rtspMethods = [](){
+    std::string methods;
+    const auto loopCnt = C::RTSP_METHOD_VECTOR.size();
+    for (int i=0; i<loopCnt; i++) {
+      methods += C::RTSP_METHOD_VECTOR[i];
+      if (i < (loopCnt-1)) methods += ",";
+    }
+    return methods;
+  }();
 
-  const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-  buffer.updateBuf(response);
+  RtspResponseWriter(buffer, C::OK, cSeq)
+    .header("Public", rtspMethods)
+    .header("Server", C::MY_NAME)
+    .finish();
 }
 
 void RtspHandler::respondDescribe(Buffer &buffer, const std::string& mediaInfo) {
-  std::string rsp = "RTSP/1.0 200 OK" + std::string{C::CRLF} +
-                "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF} +
-                "Content-Base: " + C::DUMMY_CONTENT_BASE +"/"+ std::string{C::CRLF} +
-                "Content-Length: " + std::to_string(mediaInfo.length()) + std::string{C::CRLF} +
-                "Content-Type: application/sdp" + std::string{C::CRLF} +
-                "Server: " +C::MY_NAME + std::string{C::CRLF2} +
-                mediaInfo; // don't append CRLF according to AVPT 6.1 implementation
-  const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-  buffer.updateBuf(response);
-  buffer.bodyLen = mediaInfo.length();
+  RtspResponseWriter(buffer, C::OK, cSeq)
+    .beginHeader("Content-Base").append(C::DUMMY_CONTENT_BASE).append("/").endHeader()
+    .header("Content-Length", static_cast<int64_t>(mediaInfo.length()))
+    .header("Content-Type", "application/sdp")
+    .header("Server", C::MY_NAME)
+    .finish(mediaInfo);
 }
 
 void RtspHandler::respondSetup(
@@ -482,15 +537,13 @@ void RtspHandler::respondSetup(
   int camDirectoryCnt
 ) {
   logger->info("Dongvin, setup stream id : " + std::to_string(trackId));
-  std::string rsp = "RTSP/1.0 200 OK" + std::string{C::CRLF} +
-                "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF} +
-                "Server: "+ std::string{C::MY_NAME} + std::string{C::CRLF} +
-                "Session: "+ sessionId + std::string{C::CRLF} +
-                "RefVideoSampleCnt: " + std::to_string(refVideoSampleCnt) + std::string{C::CRLF} +
-                "camDirectoryCnt: " + std::to_string(camDirectoryCnt) + std::string{C::CRLF} +
-                "Transport: " + transport+";ssrc="+ std::to_string(ssrc) + std::string{C::CRLF2};
-  const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-  buffer.updateBuf(response);
+  RtspResponseWriter(buffer, C::OK, cSeq)
+    .header("Server", C::MY_NAME)
+    .header("Session", sessionId)
+    .header("RefVideoSampleCnt", refVideoSampleCnt)
+    .header("camDirectoryCnt", camDirectoryCnt)
+    .beginHeader("Transport").append(transport).append(";ssrc=").append(ssrc).endHeader()
+    .finish();
 }
 
 void RtspHandler::respondSetupForHybrid(
@@ -498,13 +551,11 @@ void RtspHandler::respondSetupForHybrid(
   std::string sessionId,
   std::string hybridMode
 ) {
-  std::string rsp = "RTSP/1.0 200 OK" + std::string{C::CRLF} +
-                "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF} +
-                "Server: "+ std::string{C::MY_NAME} + std::string{C::CRLF} +
-                "Session: "+ sessionId + std::string{C::CRLF} +
-                "HybridMode: "+ hybridMode + std::string{C::CRLF2};
-  const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-  buffer.updateBuf(response);
+  RtspResponseWriter(buffer, C::OK, cSeq)
+    .header("Server", C::MY_NAME)
+    .header("Session", sessionId)
+    .header("HybridMode", hybridMode)
+    .finish();
 }
 
 void RtspHandler::respondPlay(
@@ -537,30 +588,28 @@ void RtspHandler::respondPlay(
     }
   }
 
-  std::string rsp;
   if (initResult) {
-    rsp = "RTSP/1.0 200 OK" + std::string{C::CRLF} +
-      "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF} +
-      "RTP-Info: " +
-
-      "url=" + C::DUMMY_CONTENT_BASE + "/trackID=0" + // front video
-      ";rtptime=" + std::to_string(rtpTime[0]) +
-      ";lsnum=" + std::to_string(lastVideoSampleNo) +
-
-      ",url=" + C::DUMMY_CONTENT_BASE + "/trackID=1" + // audio
-      ";rtptime=" + std::to_string(rtpTime[1]) +
-      ";lsnum=" + std::to_string(lastAudioSampleNo) +
-
-      ",url=" + C::DUMMY_CONTENT_BASE + "/trackID=2" + // member videos(ex : rear video)
-      ";rtptime=" + std::to_string(rtpTime[0]) +
-      ";lsnum=" + std::to_string(lastVideoSampleNo) + std::string{C::CRLF} +
-
-      "Server: " + std::string{C::MY_NAME} + std::string{C::CRLF} +
-      "Session: " + sessionId + std::string{C::CRLF} +
-      "SupportingBitrate: " + supportingBitrateType + std::string{C::CRLF} +
-      "CamDirectoryCnt: " + std::to_string(numberOfCamDirectories) + std::string{C::CRLF2};
-    const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-    buffer.updateBuf(response);
+    RtspResponseWriter(buffer, C::OK, cSeq)
+      .beginHeader("RTP-Info")
+
+      .append("url=").append(C::DUMMY_CONTENT_BASE).append("/trackID=0") // front video
+      .append(";rtptime=").append(rtpTime[0])
+      .append(";lsnum=").append(lastVideoSampleNo)
+
+      .append(",url=").append(C::DUMMY_CONTENT_BASE).append("/trackID=1") // audio
+      .append(";rtptime=").append(rtpTime[1])
+      .append(";lsnum=").append(lastAudioSampleNo)
+
+      .append(",url=").append(C::DUMMY_CONTENT_BASE).append("/trackID=2") // member videos(ex : rear video)
+      .append(";rtptime=").append(rtpTime[0])
+      .append(";lsnum=").append(lastVideoSampleNo)
+      .endHeader()
+
+      .header("Server", C::MY_NAME)
+      .header("Session", sessionId)
+      .header("SupportingBitrate", supportingBitrateType)
+      .header("CamDirectoryCnt", numberOfCamDirectories)
+      .finish();
   } else {
     logger->severe("Dongvin, Failed to init Rtp-Info header for PLAY request");
     respondError(buffer, C::INTERNAL_SERVER_ERROR, "PLAY");
@@ -568,292 +617,209 @@ void RtspHandler::respondPlay(
 }
 
 void RtspHandler::respondPlayAfterPause(Buffer& buffer) {
-  std::string rsp = "RTSP/1.0 200 OK"+std::string{C::CRLF} +
-            "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF} +
-            "Server: "+ std::string{C::MY_NAME} + std::string{C::CRLF}+
-            "Session: "+ sessionId + std::string{C::CRLF2};
-  const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-  buffer.updateBuf(response);
+  RtspResponseWriter(buffer, C::OK, cSeq)
+    .header("Server", C::MY_NAME)
+    .header("Session", sessionId)
+    .finish();
 }
 
 void RtspHandler::respondSwitching(Buffer& buffer) {
-  std::string rsp = "RTSP/1.0 200 OK"+std::string{C::CRLF}+
-                "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF} +
-                "Session: "+ sessionId + std::string{C::CRLF} +
-                "Server: "+ std::string{C::MY_NAME} + std::string{C::CRLF2};
-  const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-  buffer.updateBuf(response);
+  RtspResponseWriter(buffer, C::OK, cSeq)
+    .header("Session", sessionId)
+    .header("Server", C::MY_NAME)
+    .finish();
 }
 
 void RtspHandler::respondCameraChange(Buffer& buffer, int targetCamId) {
-  std::string rsp = "RTSP/1.0 200 OK"+std::string{C::CRLF}+
-                "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF} +
-                "Session: "+ sessionId + std::string{C::CRLF} +
-                C::CAM_CHANG_KEY + ": " + std::to_string(targetCamId) + std::string{C::CRLF} +
-                "Server: "+ std::string{C::MY_NAME} + std::string{C::CRLF2};
-  const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-  buffer.updateBuf(response);
+  RtspResponseWriter(buffer, C::OK, cSeq)
+    .header("Session", sessionId)
+    .header(C::CAM_CHANG_KEY, targetCamId)
+    .header("Server", C::MY_NAME)
+    .finish();
 }
 
 void RtspHandler::respondPFrameControl(Buffer& buffer, bool needToTxPFrames){
-  std::string rsp = "RTSP/1.0 200 OK"+std::string{C::CRLF}+
-                "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF} +
-                "Server: "+ std::string{C::MY_NAME} + std::string{C::CRLF} +
-                C::P_FRAME_KEY + ": " + std::to_string(needToTxPFrames) + std::string{C::CRLF2};
-  const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-  buffer.updateBuf(response);
+  RtspResponseWriter(buffer, C::OK, cSeq)
+    .header("Server", C::MY_NAME)
+    .header(C::P_FRAME_KEY, static_cast<int64_t>(needToTxPFrames))
+    .finish();
 }
 
 void RtspHandler::respondTeardown(Buffer& buffer) {
-  std::string rsp = "RTSP/1.0 200 OK" + std::string{C::CRLF} +
-            "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF} +
-            "Server: "+ std::string{C::MY_NAME} + std::string{C::CRLF} +
-            "Teardown: true" + std::string{C::CRLF2};
-  const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-  buffer.updateBuf(response);
+  RtspResponseWriter(buffer, C::OK, cSeq)
+    .header("Server", C::MY_NAME)
+    .header("Teardown", "true")
+    .setFlag(RtspResponseFlag::TEARDOWN)
+    .finish();
 }
 
 void RtspHandler::respondError(Buffer& buffer, int error, const std::string& rtspMethod) {
-  std::string rsp = "RTSP/1.0 " + std::to_string(error) + " " + C::RTSP_STATUS_CODES_MAP.at(error) + std::string{C::CRLF} +
-                "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF} +
-                "Server: " + std::string{C::MY_NAME} + std::string{C::CRLF} +
-                "Error: " + std::string{C::MY_NAME} + std::string{C::CRLF2};
   logger->warning(
     "Dongvin, session id:"+ sessionId +
     ", send error (" + std::to_string(error) + ") response for " + rtspMethod
     );
-  const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-  buffer.updateBuf(response);
+  RtspResponseWriter(buffer, error, cSeq)
+    .header("Server", C::MY_NAME)
+    .header("Error", C::MY_NAME)
+    .setFlag(RtspResponseFlag::ERROR)
+    .finish();
 }
 
 void RtspHandler::respondPause(Buffer &buffer) {
-  std::string rsp = "RTSP/1.0 200 OK" + std::string{C::CRLF} +
-            "CSeq: " + std::to_string(cSeq) + std::string{C::CRLF} +
-            "Server: "+ std::string{C::MY_NAME} + std::string{C::CRLF2};
-  const std::vector<unsigned char> response(rsp.begin(), rsp.end());
-  buffer.updateBuf(response);
+  RtspResponseWriter(buffer, C::OK, cSeq)
+    .header("Server", C::MY_NAME)
+    .finish();
 }
 
-std::string RtspHandler::findUserName(const std::vector<std::string>& strings) {
-  for (const std::string& elem : strings) {
-    if (elem.find("User-Agent") != std::string::npos) {
-      return Util::trim( Util::splitToVecBySingleChar(elem, ':')[1] );
-    }
-  }
-  return C::EMPTY_STRING;
+std::string RtspHandler::findUserName(const RtspRequest& request) {
+  return std::string(request.getHeader("User-Agent"));
 }
 
-int RtspHandler::findCSeq(const std::vector<std::string>& strings) {
-  for (const std::string& elem : strings) {
-    if (elem.find("CSeq") != std::string::npos) {
-      return std::stoi(
-        Util::trim( Util::splitToVecBySingleChar(elem, ':')[1] )
-      );
-    }
+int RtspHandler::findCSeq(const RtspRequest& request) {
+  int _cSeq = C::INVALID;
+  if (!Util::parseNumber(request.getHeader("CSeq"), _cSeq)) {
+    return C::INVALID;
   }
-  return C::INVALID;
+  return _cSeq;
 }
 
-std::string RtspHandler::findContents(const std::string& line0) {
-  const std::string address = Util::splitToVecBySingleChar(line0, ' ')[1];
-  const std::vector<std::string> words = Util::splitToVecBySingleChar(address, ':');
-  if (words.size() != C::URL_SPLIT_BY_SEMI_COLON_LENGTH) {
+std::string RtspHandler::findContents(std::string_view url) {
+  // e.g. rtsp://192.168.0.2:8554/title
+  const size_t firstColon = url.find(':');
+  const size_t lastColon = url.rfind(':');
+  if (
+    firstColon == std::string_view::npos || lastColon == firstColon
+    || url.find(':', firstColon + 1) != lastColon
+  ) {
     logger->severe("Invalid Title!");
     return C::EMPTY_STRING;
   }
-  return Util::trim(
-    Util::splitToVecBySingleChar(words[2], '/')[1]
-  );
+  std::string_view path = url.substr(lastColon + 1);
+  const size_t titleStart = path.find('/');
+  if (titleStart == std::string_view::npos) {
+    logger->severe("Invalid Title!");
+    return C::EMPTY_STRING;
+  }
+  path.remove_prefix(titleStart + 1);
+  return std::string(Util::trimView(path.substr(0, path.find('/'))));
 }
 
 std::string RtspHandler::getMediaInfo(const std::string& fullCid) {
   if (auto handlerPtr = streamHandlerPtr.lock()) {
-
-    const std::vector<int64_t> unitCnt = handlerPtr->getUnitFrameCount();
-    const std::vector<int64_t> gop = handlerPtr->getGop();
-
-    std::string mediaInfo = handlerPtr->getMediaInfo();
-    std::vector<std::string> lines = Util::splitToVecByString(mediaInfo, C::CRLF);
-
-    for (auto i = 0; i < lines.size(); ++i) {
-      std::string line = lines[i];
-      if (line == C::EMPTY_STRING) continue;
-
-      if (line.rfind("c=", 0) == 0) {
-        lines[i] = "c=IN IP4 0.0.0.0"; // don't need to know ip addr of client
-      } else if (line.rfind("a=control:", 0) == 0){
-        int trackId = std::stoi(Util::splitToVecBySingleChar(line, '=')[2]);
-        std::string track = "/trackID="+std::to_string(trackId);
-        lines[i] = "a=control:"+std::string{C::DUMMY_CONTENT_BASE}+track;
-        if(trackId <= C::AUDIO_ID){
-          handlerPtr->setStreamUrl(trackId, fullCid+track);
-        }
-      } else if (line.rfind("AS", 0) == 0){ // application specific for bandwidth.
-        lines[i] = C::EMPTY_STRING;
-      } else if (line.rfind("a=tool:", 0) == 0) {
-        lines[i] = C::EMPTY_STRING;
-      } else if (line.rfind("a=fmtp:", 0) == 0) {
-        if(Util::trim( Util::splitToVecBySingleChar(line, ':')[1] ).rfind("97", 0) == 0){ // audio
-          // refer to Table 9 (streamType Values) in ISO/IEC 14496-1 (coding of audio-visual objects)
-          lines[i] +=";streamType=5";
-          lines[i] += ";ucnt="+std::to_string(unitCnt[1]);
-        } else if (Util::trim( Util::splitToVecBySingleChar(line, ':')[1] ).rfind("96", 0) == 0){ // video
-          // refer to Table 9 (streamType Values) in ISO/IEC 14496-1 (coding of audio-visual objects)
-          lines[i] +=";streamType=4";
-          lines[i] += ";dGop="+std::to_string(gop[0]);
-          lines[i] += ";ucnt="+std::to_string(unitCnt[0]);
-        }
-      } else if (line.rfind("b=AS:", 0) == 0) {
-        // dongvin : 최초 재생 시 사용하게 될 bitrate를 기록해 둔다.
-        int kbps = std::stoi(Util::splitToVecBySingleChar(line, ':')[1] );
-        if (auto sessionPtr = parentSessionPtr.lock()) {
-          sessionPtr->add_kbpsBitrateValue(kbps);
-        }
-      }
-    }//for
-
-    std::string result = C::EMPTY_STRING;
-    for (const std::string& line : lines) {
-      if (line == C::EMPTY_STRING) {
-        continue;
-      }
-      result += (line + std::string{C::CRLF});
+    // rendered once when the content was loaded. only the stream urls depend on the request.
+    const std::shared_ptr<const PreRenderedSdp> sdpPtr = handlerPtr->getPreRenderedSdp();
+    for (const auto& [trackId, urlSuffix] : sdpPtr->trackUrlSuffixes) {
+      handlerPtr->setStreamUrl(trackId, fullCid + urlSuffix);
     }
-
-    return result;
+    if (auto sessionPtr = parentSessionPtr.lock()) {
+      sessionPtr->add_kbpsBitrateValue(sdpPtr->kbpsBitrate);
+    }
+    return sdpPtr->sdp;
   }
   logger->severe("Dongvin, failed to get StreamHandler weak ptr lock!");
   return C::EMPTY_STRING;
 }
 
-int RtspHandler::findTrackId(const std::string& line0) {
-  const std::string addr = Util::splitToVecBySingleChar(line0, ' ')[1];
-  return std::stoi( Util::splitToVecBySingleChar(addr, '=')[1] );
+int RtspHandler::findTrackId(std::string_view url) {
+  const size_t eq = url.find('=');
+  int trackId = C::INVALID;
+  if (eq == std::string_view::npos || !Util::parseNumber(url.substr(eq + 1), trackId)) {
+    return C::INVALID;
+  }
+  return trackId;
 }
 
-std::string RtspHandler::findTransport(const std::vector<std::string>& strings) {
+std::string_view RtspHandler::findTransport(const RtspRequest& request) {
   // required
   // refer to https://www.rfc-editor.org/rfc/rfc2326.html#section-12.39
-  for (const std::string& elem : strings) {
-    if ( elem.find("Transport:") != std::string::npos) {
-      return Util::splitToVecBySingleChar(elem, ' ')[1];
-    }
-  }
-  return C::EMPTY_STRING;
+  return request.getHeader("Transport");
 }
 
-std::string RtspHandler::findHybridMode(const std::vector<std::string>& strings) {
-  for (const std::string& elem : strings) {
-    if ( elem.find("HybridMode") != std::string::npos) {
-      std::string mode = Util::splitToVecBySingleChar(elem, ' ')[1];
-      if (C::HYBRID_MODE_SET.find(mode) != C::HYBRID_MODE_SET.end()) {
-        return mode;
-      } else {
-        return C::EMPTY_STRING;
-      }
-    }
+std::string_view RtspHandler::findHybridMode(const RtspRequest& request) {
+  std::string_view mode = request.getHeader("HybridMode");
+  if (!mode.empty() && C::HYBRID_MODE_SET.find(std::string(mode)) != C::HYBRID_MODE_SET.end()) {
+    return mode;
   }
-  return C::EMPTY_STRING;
+  return {};
 }
 
-std::string RtspHandler::findNotTx(const std::vector<std::string>& strings) {
-  for (const std::string& elem : strings) {
-    if ( elem.find("NotTx") != std::string::npos) {
-      return Util::splitToVecBySingleChar(elem, ' ')[1];
-    }
-  }
-  return C::EMPTY_STRING;
+std::string_view RtspHandler::findNotTx(const RtspRequest& request) {
+  return request.getHeader("NotTx");
 }
 
-std::vector<int> RtspHandler::findChannels(const std::string& transport) {
-  std::string range = Util::splitToVecBySingleChar(transport, '=')[1];
-  std::vector<std::string> channels = Util::splitToVecBySingleChar(range, '-');
-  std::vector<int> channelVec;
-  channelVec.push_back(std::stoi(channels[0]));
-  channelVec.push_back(std::stoi(channels[1]));
-  return channelVec;
+std::vector<int> RtspHandler::findChannels(std::string_view transport) {
+  // e.g. RTP/AVP/TCP;unicast;interleaved=0-1
+  std::string_view range = Util::findParamValue(transport, "interleaved");
+  if (range.empty()) {
+    const size_t eq = transport.find('=');
+    if (eq == std::string_view::npos) return {};
+    range = transport.substr(eq + 1);
+  }
+  const size_t dash = range.find('-');
+  int rtpChannel = 0;
+  int rtcpChannel = 0;
+  if (
+    dash == std::string_view::npos
+    || !Util::parseNumber(range.substr(0, dash), rtpChannel)
+    || !Util::parseNumber(range.substr(dash + 1), rtcpChannel)
+  ) {
+    return {};
+  }
+  return {rtpChannel, rtcpChannel};
 }
 
-std::string RtspHandler::findSessionId(const std::vector<std::string>& strings) {
-  for (const std::string& elem : strings) {
-    if (elem.find("Session:") != std::string::npos) {
-      return Util::trim( Util::splitToVecBySingleChar(elem, ':')[1] );
-    }
-  }
-  return C::EMPTY_STRING;
+std::string_view RtspHandler::findSessionId(const RtspRequest& request) {
+  return request.getHeader("Session");
 }
 
-std::vector<float> RtspHandler::findNormalPlayTime(const std::vector<std::string>& strings) {
+std::vector<float> RtspHandler::findNormalPlayTime(const RtspRequest& request) {
   // optional.
   // refer to https://www.rfc-editor.org/rfc/rfc2326.html#section-3.6 chapter
-  for (const std::string& line : strings) {
-    if (line.find("npt") != std::string::npos) {
-      const std::vector<std::string> rangePart = Util::splitToVecBySingleChar(line, '=');
-      const std::vector<std::string> range = Util::splitToVecBySingleChar(rangePart[1], '-');
-      std::vector<float> nptVector;
-      nptVector.push_back(std::stof(range[0]));
-      nptVector.push_back(range.size() == 2 ? std::stof(range[1]) : -1);
-      return nptVector;
+  const std::string_view range = Util::findParamValue(request.getHeader("Range"), "npt");
+  if (range.empty()) {
+    return {};
+  }
+  const size_t dash = range.find('-');
+  float startSec = 0;
+  if (!Util::parseFloat(range.substr(0, dash), startSec)) {
+    return {};
+  }
+  float endSec = -1;
+  if (dash != std::string_view::npos && !Util::trimView(range.substr(dash + 1)).empty()) {
+    if (!Util::parseFloat(range.substr(dash + 1), endSec)) {
+      return {};
     }
   }
-  return {};
+  return {startSec, endSec};
 }
 
-std::string RtspHandler::findDeviceModelName(const std::vector<std::string>& strings) {
-  for (const std::string& elem : strings) {
-    if ( elem.find("ModelNo") != std::string::npos) {
-      return Util::splitToVecBySingleChar(elem, ' ')[1];
-    }
-  }
-  return C::EMPTY_STRING;
+std::string_view RtspHandler::findDeviceModelName(const RtspRequest& request) {
+  return request.getHeader("ModelNo");
 }
 
-std::string RtspHandler::findManufacturer(const std::vector<std::string>& strings) {
-  for (const std::string& elem : strings) {
-    if ( elem.find("Manufacturer") != std::string::npos) {
-      return Util::splitToVecBySingleChar(elem, ' ')[1];
-    }
-  }
-  return C::EMPTY_STRING;
+std::string_view RtspHandler::findManufacturer(const RtspRequest& request) {
+  return request.getHeader("Manufacturer");
 }
 
-bool RtspHandler::isLookingSampleControInUse(const std::vector<std::string>& strings){
-  for (const std::string& elem : strings) {
-    if ( elem.find(C::USE_P_FRAME_CONTROL) != std::string::npos) {
-      if (Util::splitToVecBySingleChar(elem, ' ')[1] == "true") {
-        return true;
-      }
-    }
-  }
-  return false;
+bool RtspHandler::isLookingSampleControInUse(const RtspRequest& request){
+  return request.getHeader(C::USE_P_FRAME_CONTROL) == "true";
 }
 
 // for play req right after pause
 int RtspHandler::findLatestReceivedSampleIdx(
-  const std::vector<std::string>& strings, const std::string& filter
+  const RtspRequest& request, std::string_view filter
 ) {
   // PLAY req header example
   // PlayInfo: videoIndex=144;videoRtpIndex=8;audioIndex=228;
-  for (const std::string& headerLine: strings) {
-    if (headerLine.rfind("PlayInfo", 0) == 0) {
-      std::string HeaderValue = Util::splitToVecByString(headerLine, " ")[1];
-      for (const std::string& value: Util::splitToVecBySingleChar(headerLine, ';')) {
-        if (value.find(filter) != std::string::npos) {
-          return std::stoi(Util::splitToVecBySingleChar(value, '=')[1]);
-        }
-      }//inner for
-    }
-  }//outer for
-  return C::INVALID;
+  int sampleIdx = C::INVALID;
+  if (!Util::parseNumber(Util::findParamValue(request.getHeader("PlayInfo"), filter), sampleIdx)) {
+    return C::INVALID;
+  }
+  return sampleIdx;
 }
 
-bool RtspHandler::isSeekRequest(const std::vector<std::string>& strings) {
-  for (const std::string& elem : strings) {
-    if ( elem.find("SeekInfo") != std::string::npos) {
-      return true;
-    }
-  }
-  return false;
+bool RtspHandler::isSeekRequest(const RtspRequest& request) {
+  return request.hasHeader("SeekInfo");
 }
 
 bool RtspHandler::isValidPlayTime(const std::vector<float>& ntpSec) {
@@ -902,22 +868,35 @@ std::string RtspHandler::getSupportingBitrateTypes(std::vector<int> bitrateTypes
   }
 }
 
-bool RtspHandler::isContainingPlayInfoHeader(const std::vector<std::string>& strings) {
-  for (const std::string& elem : strings) {
-    if ( elem.find("PlayInfo") != std::string::npos) {
-      return true;
-    }
-  }
-  return false;
+bool RtspHandler::isContainingPlayInfoHeader(const RtspRequest& request) {
+  return request.hasHeader("PlayInfo");
+}
+
+bool RtspHandler::isThereMonitoringInfoHeader(const RtspRequest& request) {
+  return request.hasHeader("MonitoringInfo");
 }
 
-bool RtspHandler::isThereMonitoringInfoHeader(const std::vector<std::string>& strings) {
-  for (const std::string& elem : strings) {
-    if ( elem.find("MonitoringInfo") != std::string::npos) {
-      return true;
+std::pair<std::string_view, std::string_view> RtspHandler::findSetParameterInfo(const RtspRequest& request) {
+  // the info comes as a header, or as a "name: value" line in the body.
+  for (const std::string_view infoKey : {std::string_view(C::CAM_CHANG_KEY), std::string_view(C::P_FRAME_KEY)}) {
+    if (request.hasHeader(infoKey)) {
+      return {infoKey, request.getHeader(infoKey)};
     }
   }
-  return false;
+  std::string_view body = request.body;
+  while (!body.empty()) {
+    const size_t lineEnd = body.find('\n');
+    const std::string_view line = Util::trimView(body.substr(0, lineEnd));
+    body.remove_prefix(lineEnd == std::string_view::npos ? body.size() : lineEnd + 1);
+
+    const size_t colon = line.find(':');
+    if (colon == std::string_view::npos) continue;
+    const std::string_view name = Util::trimView(line.substr(0, colon));
+    if (name == C::CAM_CHANG_KEY || name == C::P_FRAME_KEY) {
+      return {name, Util::trimView(line.substr(colon + 1))};
+    }
+  }
+  return {};
 }
 
 void RtspHandler::parseHybridVideoSampleMetaDataForDandS(const std::string& notTxIdListStr) {
@@ -967,4 +946,4 @@ Map : hybridMeta<camId, val>
       }//for
     } else logger->severe("Dongvin, RtspHandler: failed to get weak StreamHandlerPtr!");
   } else logger->severe("Dongvin, RtspHandler: failed to get weak SessionPtr!");
-}
\ No newline at end of file
+}
\ No newline at end of file
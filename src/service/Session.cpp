@@ -6,11 +6,15 @@
 
 #include "../../constants/Util.h"
 #include "../../include/PeriodicTask.h"
+#include "../../include/LatencyHistogram.h"
+#include "../../include/RtspResponseWriter.h"
+#include "../../include/TimerWheel.h"
 #include "../constants/C.h"
 
 Session::Session(
   boost::asio::io_context & inputIoContext,
   std::shared_ptr<boost::asio::io_context> inputWorkerIoContextPtr,
+  MediaClock& inputMediaClock,
   std::shared_ptr<boost::asio::ip::tcp::socket> inputSocketPtr,
   std::string inputSessionId,
   Server & inputServer,
@@ -21,6 +25,7 @@ Session::Session(
   : logger(Logger::getLogger(C::SESSION)),
     io_context(inputIoContext),
     workerIoContextPtr(inputWorkerIoContextPtr),
+    mediaClock(inputMediaClock),
     strand(boost::asio::make_strand(*inputWorkerIoContextPtr)),
     socketPtr(std::move(inputSocketPtr)),
     sessionId(inputSessionId),
@@ -39,9 +44,12 @@ Session::Session(
 Session::~Session(){
   // cleanup and release resources one more time before object destruction.
   try {
+    TimerWheel::getShared().cancel(teardownTimerId.exchange(TimerWheel::INVALID_TIMER_ID));
+    TimerWheel::getShared().cancel(parkTimerId.exchange(TimerWheel::INVALID_TIMER_ID));
+    TimerWheel::getShared().cancel(parkedLivenessTimerId.exchange(TimerWheel::INVALID_TIMER_ID));
     bitrateRecodeTask.stop();
-    for (const auto& taskPtr : videoReadingTaskVec) taskPtr->stop();
-    for (const auto& taskPtr : audioReadingTaskVec) taskPtr->stop();
+    mediaClock.removeTrack(videoReadingTrackId.exchange(MediaClock::INVALID_TRACK_ID));
+    mediaClock.removeTrack(audioReadingTrackId.exchange(MediaClock::INVALID_TRACK_ID));
     if (socketPtr->is_open()){
       socketPtr->close();
     }
@@ -72,22 +80,28 @@ void Session::start() {
   logger->info2("session id : " + sessionId + " starts.");
   sessionInitTimeSecUtc = sntpRefTimeProvider.getRefTimeSecForCurrentTask();
 
-  asyncReceive();
-
-  // allocate rtp tx only thread
-  std::thread([&](){
+  // allocate tx only thread. the only writer of the socket.
+  // holds the session, since it may sleep on txWakeCv until the teardown.
+  std::thread([this, self = shared_from_this()](){
     while (true){
       if (rtpQueuePtr == nullptr || isToreDown){
         break;
       }
-      if (rtpQueuePtr->empty()) {
-        // to prevent CPU overuse.
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        continue;
+      // holds no rtp packet here. the strand may drop the queued ones for parking.
+      if (const uint64_t requestId = parkRequestId.load(); requestId != txAckedParkRequestId) {
+        txAckedParkRequestId = requestId;
+        boost::asio::post(strand, [self, requestId](){ self->finishPark(requestId); });
       }
-      if (!isPaused){
-        transmitRtp();
+      // priority lane first. rtsp responses must not wait behind queued rtp.
+      if (pendingRtspResCnt.load(std::memory_order_acquire) > 0) {
+        transmitRtspRes();
+      }
+      if (isPaused || rtpQueuePtr->empty()) {
+        // no polling. a paused or idle session costs no CPU.
+        waitForTxWork();
+        continue;
       }
+      transmitRtp();
     }
   }).detach();
 
@@ -105,12 +119,14 @@ void Session::start() {
         > C::CLIENT_CONNECTION_LOSS_THRESHOLD_DURATION_MS
     ){
       logger->severe("Dongvin, client connection was lost. shutdown session. id : " + sessionId);
-      Util::delayedExecutorAsyncByThread(C::TEARDOWN_DELAY_MS, [this](){onTeardown();});
+      scheduleTeardown();
       return;
     }
 
-    int32_t sentBit = sentBitsSize;
-    sentBitsSize = 0;
+    const uint64_t sentBitsSnapshot = sentBitsTotal.load(std::memory_order_relaxed);
+    int32_t sentBit = static_cast<int32_t>(sentBitsSnapshot - lastSentBitsTotal);
+    lastSentBitsTotal = sentBitsSnapshot;
+    txBitrateBps.store(static_cast<int64_t>(sentBit) * 1000 / C::TX_BITRATE_SAMPLING_PERIOD_MS, std::memory_order_relaxed);
     int64_t recordTimeUtcSec = sntpRefTimeProvider.getRefTimeSecForCurrentTask();
     if (utcTimeSecBitSizeMap.find(recordTimeUtcSec) != utcTimeSecBitSizeMap.end()) {
       int32_t prev = utcTimeSecBitSizeMap[recordTimeUtcSec];
@@ -119,11 +135,24 @@ void Session::start() {
     } else {
       utcTimeSecBitSizeMap.insert({recordTimeUtcSec, sentBit});
     }
+
+    if (C::USE_SERVER_SIDE_ABR && !isPaused && mbpsPossibleTypeList.size() > 1) {
+      adaptBitrate(sentBit);
+    }
   };
   bitrateRecodeTask.setTask(txBitrateTask);
   const std::chrono::milliseconds bitrateInterval(C::TX_BITRATE_SAMPLING_PERIOD_MS);
   bitrateRecodeTask.setInterval(bitrateInterval);
-  bitrateRecodeTask.start();
+  if (C::USE_SESSION_PARKING) {
+    // nothing to play until the first PLAY.
+    isParked = true;
+    scheduleParkedLivenessCheck();
+  } else {
+    bitrateRecodeTask.start();
+  }
+
+  // the last. requests may be handled on the strand before this function returns.
+  asyncReceive();
 }
 
 boost::asio::io_context& Session::getIoContext(){
@@ -180,6 +209,128 @@ bool Session::getPauseStatus() {
 
 void Session::updatePauseStatus(bool inputPausedStatus) {
   isPaused = inputPausedStatus;
+  if (isPaused) {
+    schedulePark();
+  } else {
+    TimerWheel::getShared().cancel(parkTimerId.exchange(TimerWheel::INVALID_TIMER_ID));
+    // a park which is waiting for the tx thread is cancelled.
+    parkRequestId.fetch_add(1);
+    // frames read before the pause go out late by the pause. they are not timed.
+    if (videoFrameIntervalUs != C::INVALID_OFFSET) anchorFrameDeadlines(videoFrameIntervalUs);
+    wakeTxThread();
+  }
+}
+
+bool Session::getParkStatus() {
+  return isParked;
+}
+
+bool Session::getPlayRestartStatus() {
+  return needPlayRestart;
+}
+
+int Session::unpark() {
+  if (!isParked) return C::OK;
+  // the samples metas of the session are of the parked revision. the files must be of the same one.
+  // 0 for the park of a new session, which holds no content yet.
+  if (parkedContentRevision != 0 && contentsStorage.getContentRevision(contentTitle) != parkedContentRevision) {
+    logger->severe(
+      "Dongvin, content was replaced or removed while parked. content : " + contentTitle + ", session id : " + sessionId
+    );
+    return C::NOT_FOUND;
+  }
+  if (needReopenFileStreams && !rtpHandlerPtr->reopenAllFileStreams()) {
+    logger->severe("Dongvin, failed to reopen file streams of parked session. session id : " + sessionId);
+    return C::INTERNAL_SERVER_ERROR;
+  }
+  needReopenFileStreams = false;
+  TimerWheel::getShared().cancel(parkedLivenessTimerId.exchange(TimerWheel::INVALID_TIMER_ID));
+  isParked = false;
+  bitrateRecodeTask.start();
+  logger->info2("Dongvin, unparked session. session id : " + sessionId);
+  return C::OK;
+}
+
+void Session::schedulePark() {
+  if (!C::USE_SESSION_PARKING) return;
+  TimerWheel::getShared().cancel(parkTimerId.exchange(TimerWheel::INVALID_TIMER_ID));
+  // a short pause stays hot. the timer wheel thread hands the park over to the strand.
+  parkTimerId = TimerWheel::getShared().schedule(C::SESSION_PARK_DELAY_MS, [weakSelf = weak_from_this()](){
+    if (auto self = weakSelf.lock()) {
+      boost::asio::post(self->strand, [self](){ self->park(); });
+    }
+  });
+}
+
+void Session::park() {
+  if (isParked || isToreDown || !isPaused) return;
+  // the tx thread may still be writing a packet which it popped before the pause.
+  parkRequestId.fetch_add(1);
+  wakeTxThread();
+}
+
+void Session::finishPark(uint64_t requestId) {
+  // resumed, or paused again, after the request.
+  if (requestId != parkRequestId.load() || isParked || isToreDown || !isPaused) return;
+  stopCurrentMediaReadingTasks(true);
+  bitrateRecodeTask.stop();
+
+  // the tx thread sends nothing while paused. samples which were not sent are read again on resume.
+  int videoResumeSampleNo = C::INVALID;
+  int audioResumeSampleNo = C::INVALID;
+  RtpPacketInfo* rtpPacketInfoPtr = nullptr;
+  while (rtpQueuePtr->pop(rtpPacketInfoPtr)) {
+    queuedRtpCnt.fetch_sub(1, std::memory_order_relaxed);
+    droppedRtpCnt.fetch_add(1, std::memory_order_relaxed);
+    if (rtpPacketInfoPtr == nullptr) continue;
+    int& resumeSampleNo = rtpPacketInfoPtr->flag == C::VIDEO_ID ? videoResumeSampleNo : audioResumeSampleNo;
+    if (resumeSampleNo == C::INVALID) resumeSampleNo = rtpPacketInfoPtr->sampleNo;
+  }
+  if (videoResumeSampleNo != C::INVALID) streamHandlerPtr->updateCurSampleNo(C::VIDEO_ID, videoResumeSampleNo);
+  if (audioResumeSampleNo != C::INVALID) streamHandlerPtr->updateCurSampleNo(C::AUDIO_ID, audioResumeSampleNo);
+  std::queue<std::shared_ptr<RtpPacketInfo>>().swap(rtpMemoryQueue);
+  fastStartBurstEndSampleNo.store(C::INVALID, std::memory_order_relaxed);
+  txBitrateBps.store(0, std::memory_order_relaxed);
+  needPlayRestart = true;
+
+  if (rtpHandlerPtr != nullptr) needReopenFileStreams = rtpHandlerPtr->closeAllFileStreams();
+  allocatedBytesForSample.store(0);
+  parkedContentRevision = contentsStorage.getContentRevision(contentTitle);
+  streamHandlerPtr->resetReadAheadWindows();
+  {
+    std::lock_guard<std::mutex> guard(rtspTxLock);
+    std::vector<std::vector<unsigned char>>().swap(rtspTxFreeBufs);
+  }
+  rtspBuffer.shrink_to_fit();
+  std::vector<unsigned char>().swap(rtspResponseBuffer.buf);
+
+  isParked = true;
+  scheduleParkedLivenessCheck();
+  logger->info2(
+    "Dongvin, parked session. session id : " + sessionId + ", video, audio resume sample no : "
+    + std::to_string(videoResumeSampleNo) + "," + std::to_string(audioResumeSampleNo)
+  );
+}
+
+void Session::scheduleParkedLivenessCheck() {
+  parkedLivenessTimerId = TimerWheel::getShared().schedule(
+    C::CLIENT_CONNECTION_LOSS_THRESHOLD_DURATION_MS,
+    [weakSelf = weak_from_this()](){
+      if (auto self = weakSelf.lock()) {
+        boost::asio::post(self->strand, [self](){ self->checkParkedLiveness(); });
+      }
+    }
+  );
+}
+
+void Session::checkParkedLiveness() {
+  if (!isParked || isToreDown) return;
+  if (Util::getCurrentTimeMillis() - latestOptionsReqTimeMillis > C::CLIENT_CONNECTION_LOSS_THRESHOLD_DURATION_MS) {
+    logger->severe("Dongvin, client connection of parked session was lost. shutdown session. id : " + sessionId);
+    scheduleTeardown();
+    return;
+  }
+  scheduleParkedLivenessCheck();
 }
 
 std::string Session::getContentTitle() {
@@ -199,9 +350,9 @@ void Session::updatePlayTimeDurationMillis(int64_t inputPlayTimeDurationMillis)
 }
 
 void Session::stopCurrentMediaReadingTasks(bool needToStopAudioReadingTask) {
-  for (const auto& videoReadingTaskPtr : videoReadingTaskVec) videoReadingTaskPtr->stop();
+  mediaClock.removeTrack(videoReadingTrackId.exchange(MediaClock::INVALID_TRACK_ID));
   if (needToStopAudioReadingTask) {
-    for (const auto& audioReadingTaskPtr : audioReadingTaskVec) audioReadingTaskPtr->stop();
+    mediaClock.removeTrack(audioReadingTrackId.exchange(MediaClock::INVALID_TRACK_ID));
   }
 }
 
@@ -229,25 +380,54 @@ void Session::addRxBitrate(RxBitrate &record) {
 }
 
 std::vector<int> Session::get_mbpsTypeList() {
-  return {};
+  return mbpsPossibleTypeList;
 }
 
 void Session::set_mbpsTypeList(std::vector<int> input_mbpsTypeList) {
+  // onCid() is called on every OPTIONS. keep the current decision for the same content.
+  if (input_mbpsTypeList == mbpsPossibleTypeList) return;
+  mbpsPossibleTypeList = std::move(input_mbpsTypeList);
+  abrController.reset(static_cast<int>(mbpsPossibleTypeList.size()));
+}
+
+void Session::adaptBitrate(int64_t sentBitsInPeriod) {
+  if (fastStartBurstEndSampleNo.load(std::memory_order_relaxed) != C::INVALID) return;
+  const int64_t nowMillis = Util::getCurrentTimeMillis();
+  const int64_t txBps = sentBitsInPeriod * 1000 / C::TX_BITRATE_SAMPLING_PERIOD_MS;
+  int64_t rxBps = C::INVALID;
+  if (!rxBitrateRecord.empty() && nowMillis - rxBitrateRecord.back().getUtcTimeMillis() <= C::ABR_RX_BITRATE_STALE_MS) {
+    rxBps = rxBitrateRecord.back().getBitrate();
+  }
+
+  // from the applied variant. a switch which failed or was dropped is asked again after the hold time.
+  const int prevVariantIdx = streamHandlerPtr->getBitrateVariantIdx();
+  // a requested switch waits for a key frame. decided again once it is applied or dropped.
+  if (streamHandlerPtr->getPendingBitrateVariantIdx() != prevVariantIdx) return;
+  const int nextVariantIdx = abrController.decide(
+    prevVariantIdx, txBps, rxBps, allocatedBytesForSample.load(std::memory_order_relaxed), nowMillis
+  );
+  if (nextVariantIdx == prevVariantIdx) return;
+
+  logger->info3(
+    "Dongvin, session id : " + sessionId + ", bitrate " + std::to_string(mbpsPossibleTypeList[prevVariantIdx])
+    + "mbps -> " + std::to_string(mbpsPossibleTypeList[nextVariantIdx]) + "mbps. tx/rx bps : "
+    + std::to_string(txBps) + "/" + std::to_string(rxBps)
+    + ", backlog bytes : " + std::to_string(allocatedBytesForSample.load(std::memory_order_relaxed))
+  );
+  streamHandlerPtr->requestBitrateVariant(nextVariantIdx);
 }
 
 int Session::getNumberOfCamDirectories() {
-  std::string contentTitle = getContentTitle();
-  if(contentsStorage.getContentFileMetaMap().count(contentTitle)) {
-    return contentsStorage.getContentFileMetaMap().at(contentTitle).getNumberOfCamDirectories();
+  if (auto contentFileMetaPtr = streamHandlerPtr->getContentFileMetaPtr()) {
+    return contentFileMetaPtr->getNumberOfCamDirectories();
   }
   logger->severe("Dongvin, failed to find content in ContentsStorage! :: getNumberOfCamDirectories()");
   return C::INVALID;
 }
 
 int Session::getRefVideoSampleCnt() {
-  std::string contentTitle = getContentTitle();
-  if (contentsStorage.getContentFileMetaMap().find(contentTitle) != contentsStorage.getContentFileMetaMap().end()) {
-    return contentsStorage.getContentFileMetaMap().at(contentTitle).getRefVideoSampleCnt();
+  if (auto contentFileMetaPtr = streamHandlerPtr->getContentFileMetaPtr()) {
+    return contentFileMetaPtr->getRefVideoSampleCnt();
   } else {
     logger->severe("Dongvin, failed to find content in ContentsStorage! :: getRefVideoSampleCnt()");
     return C::INVALID;
@@ -274,19 +454,14 @@ void Session::shutdownSession() {
   parentServer.afterTerminatingSession(sessionId);
 }
 
-void Session::handleRtspRequest(Buffer& buf) {
-  if (buf.buf.empty()) {
-    std::cerr << "Empty or invalid buffer received!\n";
-    return;
-  }
-
+void Session::handleRtspRequest(const RtspRequest& request, Buffer& buf) {
   if (!rtspHandlerPtr) {
     std::cerr << "rtspHandlerPtr is null!\n";
     return;
   }
 
   try {
-    rtspHandlerPtr->run(buf);
+    rtspHandlerPtr->run(request, buf);
   } catch (const std::exception& ex) {
     std::cerr << "Exception in handleRtspRequest: " << ex.what() << "\n";
   } catch (...) {
@@ -297,8 +472,10 @@ void Session::handleRtspRequest(Buffer& buf) {
 
 bool Session::onCid(std::string inputCid) {
   logger->warning("Dongvin, requested content : " + inputCid + ", session id : " + sessionId);
-  ContentFileMeta& fileReader = contentsStorage.getCid(inputCid);
-  return streamHandlerPtr->setReaderAndContentTitle(fileReader, inputCid);
+  // may load the content meta on the first request.
+  if (!streamHandlerPtr->setReaderAndContentTitle(contentsStorage.getCid(inputCid), inputCid)) return false;
+  set_mbpsTypeList(streamHandlerPtr->getContentFileMetaPtr()->getMbpsTypeList());
+  return true;
 }
 
 
@@ -327,6 +504,9 @@ void Session::onCameraChange(
     logger->severe("Dongvin, invalid switching time info!");
     return;
   }
+  // the next sample is found with the files. a parked session is still paused, so it parks again later.
+  if (unpark() != C::OK) return;
+
   // stop sending rtp and restart with the new position of rtp
   streamHandlerPtr->setCamId(nextCam);
   int taIdx = static_cast<int>(switchingTimeInfo[1]);
@@ -334,13 +514,131 @@ void Session::onCameraChange(
 
   stopCurrentMediaReadingTasks(needToStopAudio);
   streamHandlerPtr->findNextSampleForSwitching(nextId, switchingTimeInfo);
+  if (needPlayRestart) {
+    // the reading tracks start on resume.
+    schedulePark();
+    return;
+  }
   startPlayForCamSwitching();
 }
 
+void Session::schedulePlayStart(Buffer& playResponseBuffer, int delayMs) {
+  playRequestTimeNs = Util::getElapsedTimeNanoSec();
+  if (!C::USE_FAST_START) {
+    Util::delayedExecutorAsyncByIoContext(io_context, delayMs, [self = shared_from_this()](){ self->onPlayStart(); });
+    return;
+  }
+  // the client is ready for rtp once it got the response. no need to guess with a fixed delay.
+  // weak, since the response is kept in the tx lane of this session.
+  playResponseBuffer.afterTx = [weakSelf = weak_from_this()](){
+    if (auto self = weakSelf.lock()) {
+      boost::asio::post(self->strand, [self](){ self->onPlayStart(); });
+    }
+  };
+}
+
+void Session::readFastStartBurst(int64_t videoIntervalUs, int64_t audioIntervalUs) {
+  // the first gop at most. the rest goes at the real time, so the client buffer stays at the target.
+  int64_t videoBurstCnt = C::FAST_START_BUFFER_TARGET_MS * 1000 / videoIntervalUs;
+  if (const std::vector<int64_t> gop = streamHandlerPtr->getGop(); !gop.empty() && gop[0] > 0) {
+    videoBurstCnt = std::min(videoBurstCnt, gop[0]);
+  }
+  const int64_t audioBurstCnt = videoBurstCnt * videoIntervalUs / audioIntervalUs;
+
+  // in presentation time order, so that both tracks of the same period arrive together.
+  int64_t videoReadCnt = 0;
+  int64_t audioReadCnt = 0;
+  while (
+    !isPaused && !isToreDown && isNewSampleAllocatable()
+    && (videoReadCnt < videoBurstCnt || audioReadCnt < audioBurstCnt)
+  ) {
+    if (
+      videoReadCnt < videoBurstCnt
+      && (audioReadCnt >= audioBurstCnt || videoReadCnt * videoIntervalUs <= audioReadCnt * audioIntervalUs)
+    ) {
+      streamHandlerPtr->getNextVideoSample();
+      ++videoReadCnt;
+    } else {
+      streamHandlerPtr->getNextAudioSample();
+      ++audioReadCnt;
+    }
+  }
+  if (videoReadCnt > 0) {
+    fastStartBurstEndSampleNo.store(streamHandlerPtr->getCurSampleNo(C::VIDEO_ID) - 1, std::memory_order_relaxed);
+  }
+  logger->info2(
+    "Dongvin, fast start burst. video, audio sample cnt : "
+    + std::to_string(videoReadCnt) + "," + std::to_string(audioReadCnt)
+  );
+}
+
+void Session::recordTimeToFirstFrame() {
+  // called by the tx thread only.
+  const int64_t requestTimeNs = playRequestTimeNs.exchange(C::INVALID_OFFSET);
+  if (requestTimeNs == C::INVALID_OFFSET) return;
+  const int64_t timeToFirstFrameUs = (Util::getElapsedTimeNanoSec() - requestTimeNs) / 1000;
+  int64_t unset = C::INVALID_OFFSET;
+  initialTimeToFirstFrameUs.compare_exchange_strong(unset, timeToFirstFrameUs);
+  logger->info2(
+    "Dongvin, time to first frame : " + std::to_string(timeToFirstFrameUs / 1000) + "ms. session id : " + sessionId
+  );
+}
+
+void Session::anchorFrameDeadlines(int64_t videoIntervalUs) {
+  const int curVideoSampleNo = streamHandlerPtr->getCurSampleNo(C::VIDEO_ID);
+  if (videoIntervalUs <= 0 || curVideoSampleNo == C::INVALID) return;
+  // the first reading tick is one interval later.
+  frameDeadlineAnchorNs = Util::getElapsedTimeNanoSec();
+  frameDeadlineAnchorSampleNo = curVideoSampleNo;
+  videoFrameIntervalUs = videoIntervalUs;
+  frameDeadlineEpoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Session::slipFrameDeadlines() {
+  if (frameDeadlineAnchorNs == C::INVALID_OFFSET) return;
+  frameDeadlineAnchorNs += videoFrameIntervalUs * 1000;
+}
+
+void Session::trackFrameDelivery(const RtpPacketInfo& rtpPacketInfo, int64_t writeEndTimeNs) {
+  if (
+    const int burstEndSampleNo = fastStartBurstEndSampleNo.load(std::memory_order_relaxed);
+    burstEndSampleNo != C::INVALID && rtpPacketInfo.sampleNo >= burstEndSampleNo
+  ) {
+    fastStartBurstEndSampleNo.store(C::INVALID, std::memory_order_relaxed);
+  }
+  // front and rear packets of a frame are enqueued back to back.
+  if (rtpPacketInfo.sampleNo != txFrameSampleNo || rtpPacketInfo.deadlineEpoch != txFrameDeadlineEpoch) {
+    finishFrameDelivery();
+    txFrameSampleNo = rtpPacketInfo.sampleNo;
+    txFrameDeadlineNs = rtpPacketInfo.deadlineNs;
+    txFrameDeadlineEpoch = rtpPacketInfo.deadlineEpoch;
+  }
+  txFrameWriteEndTimeNs = writeEndTimeNs;
+}
+
+void Session::finishFrameDelivery() {
+  if (
+    txFrameDeadlineNs == C::INVALID_OFFSET
+    || txFrameDeadlineEpoch != frameDeadlineEpoch.load(std::memory_order_relaxed)
+  ) {
+    return;
+  }
+  // early frames are recorded as 0.
+  const int64_t latenessUs = (txFrameWriteEndTimeNs - txFrameDeadlineNs) / 1000;
+  frameLatenessHistogram.record(latenessUs);
+  HotPathMetrics::getShared().frameLatenessUs.record(latenessUs);
+  deliveredFrameCnt.store(deliveredFrameCnt.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  if (latenessUs <= C::FRAME_ON_TIME_THRESHOLD_US) {
+    onTimeFrameCnt.store(onTimeFrameCnt.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+}
+
 void Session::onPlayStart(){
+  needPlayRestart = false;
   // need to adjust sample reading and tx interval. if didn't, video stuttering occurs.
-  int64_t videoInterval = streamHandlerPtr->getUnitFrameTimeUs(C::VIDEO_ID)/1000;
-  int64_t audioInterval = streamHandlerPtr->getUnitFrameTimeUs(C::AUDIO_ID)/1000;
+  // kept in us. 33333us, not 33ms, for 30 fps.
+  int64_t videoInterval = streamHandlerPtr->getUnitFrameTimeUs(C::VIDEO_ID);
+  int64_t audioInterval = streamHandlerPtr->getUnitFrameTimeUs(C::AUDIO_ID);
 
   if (videoInterval == C::INVALID || audioInterval == C::INVALID) {
     logger->severe(
@@ -350,36 +648,49 @@ void Session::onPlayStart(){
     return;
   }
 
-  std::chrono::milliseconds vInterval(videoInterval);
-  auto videoSampleReadingTask = [&](){
+  if (C::USE_FAST_START) {
+    readFastStartBurst(videoInterval, audioInterval);
+  }
+  // after the burst, so that the first deadline is the first reading tick. the burst frames stay untimed.
+  anchorFrameDeadlines(videoInterval);
+
+  // one timer of the worker runs the tracks of every session. late samples are read right away.
+  auto videoSampleReadingTask = [this](){
     if (!isPaused && !isToreDown && isNewSampleAllocatable()){
       streamHandlerPtr->getNextVideoSample();
+    } else if (!isPaused && !isToreDown) {
+      // the client buffer is full. this sample goes out later than its time.
+      lateSampleCnt.fetch_add(1, std::memory_order_relaxed);
+      slipFrameDeadlines();
     }
   };
-  auto videoTaskPtr = std::make_shared<PeriodicTask>(*workerIoContextPtr, strand, vInterval, videoSampleReadingTask);
-  videoReadingTaskVec.emplace_back(std::move(videoTaskPtr));
+  // a track of an earlier PLAY or seek must not keep reading along with the new one.
+  mediaClock.removeTrack(videoReadingTrackId.exchange(MediaClock::INVALID_TRACK_ID));
+  videoReadingTrackId = mediaClock.addTrack(
+    strand, std::chrono::microseconds(videoInterval), weak_from_this(), videoSampleReadingTask
+  );
 
-  std::chrono::milliseconds aInterval(audioInterval);
-  auto audioSampleReadingTask = [&](){
+  auto audioSampleReadingTask = [this](){
     if (!isPaused && !isToreDown && isNewSampleAllocatable()){
       streamHandlerPtr->getNextAudioSample();
+    } else if (!isPaused && !isToreDown) {
+      lateSampleCnt.fetch_add(1, std::memory_order_relaxed);
     }
     deleteDanglingRtps();
   };
-  auto audioTaskPtr = std::make_shared<PeriodicTask>(*workerIoContextPtr, strand, aInterval, audioSampleReadingTask);
-  audioReadingTaskVec.emplace_back(std::move(audioTaskPtr));
+  mediaClock.removeTrack(audioReadingTrackId.exchange(MediaClock::INVALID_TRACK_ID));
+  audioReadingTrackId = mediaClock.addTrack(
+    strand, std::chrono::microseconds(audioInterval), weak_from_this(), audioSampleReadingTask
+  );
 
-  if (!videoReadingTaskVec.empty() && !audioReadingTaskVec.empty()){
-    videoReadingTaskVec.back()->start();
-    audioReadingTaskVec.back()->start();
-  } else {
-    throw std::runtime_error("Dongvin, failed to start media reading timer tasks : " + sessionId);
+  if (videoReadingTrackId == MediaClock::INVALID_TRACK_ID || audioReadingTrackId == MediaClock::INVALID_TRACK_ID){
+    throw std::runtime_error("Dongvin, failed to start media reading tracks : " + sessionId);
   }
 }
 
 void Session::startPlayForCamSwitching() {
   logger->info("Dongvin, start cam switching!");
-  int64_t videoInterval = streamHandlerPtr->getUnitFrameTimeUs(C::VIDEO_ID)/1000;
+  int64_t videoInterval = streamHandlerPtr->getUnitFrameTimeUs(C::VIDEO_ID);
 
   // fast transport video frames.
   for (int i = 0; i < C::FAST_TX_FACTOR_FOR_CAM_SWITCHING; ++i){
@@ -388,27 +699,46 @@ void Session::startPlayForCamSwitching() {
     }
   }
   logger->info2("Dongvin, fast transported video samples. cnt : " + std::to_string(C::FAST_TX_FACTOR_FOR_CAM_SWITCHING));
+  // after the fast tx, like the fast start burst. the fast transported frames stay untimed.
+  anchorFrameDeadlines(videoInterval);
 
   // start normal video tx task.
-  std::chrono::milliseconds vInterval(videoInterval);
-  auto videoSampleReadingTask = [&](){
+  auto videoSampleReadingTask = [this](){
     if (!isPaused && !isToreDown && isNewSampleAllocatable()){
       streamHandlerPtr->getNextVideoSample();
+    } else if (!isPaused && !isToreDown) {
+      // the client buffer is full. this sample goes out later than its time.
+      lateSampleCnt.fetch_add(1, std::memory_order_relaxed);
+      slipFrameDeadlines();
     }
   };
-  auto videoTaskPtr = std::make_shared<PeriodicTask>(*workerIoContextPtr, strand, vInterval, videoSampleReadingTask);
-  videoReadingTaskVec.emplace_back(std::move(videoTaskPtr));
-  logger->info2("Dongvin, video reading task for cam switching started!");
-  if (!videoReadingTaskVec.empty()){
-    videoReadingTaskVec.back()->start();
-  } else {
-    throw std::runtime_error("Dongvin, failed to start video reading timer task for cam switching : " + sessionId);
+  mediaClock.removeTrack(videoReadingTrackId.exchange(MediaClock::INVALID_TRACK_ID));
+  videoReadingTrackId = mediaClock.addTrack(
+    strand, std::chrono::microseconds(videoInterval), weak_from_this(), videoSampleReadingTask
+  );
+  if (videoReadingTrackId == MediaClock::INVALID_TRACK_ID){
+    throw std::runtime_error("Dongvin, failed to start video reading track for cam switching : " + sessionId);
   }
+  logger->info2("Dongvin, video reading task for cam switching started!");
+}
+
+void Session::scheduleTeardown() {
+  // once. connection loss is detected every second until the teardown.
+  if (isTeardownScheduled.exchange(true)) return;
+  // the timer wheel thread only hands the teardown over to the strand.
+  teardownTimerId = TimerWheel::getShared().schedule(C::TEARDOWN_DELAY_MS, [weakSelf = weak_from_this()](){
+    if (auto self = weakSelf.lock()) {
+      boost::asio::post(self->strand, [self](){ self->onTeardown(); });
+    }
+  });
 }
 
 void Session::onTeardown() {
   allocatedBytesForSample.store(0);
   isToreDown = true;
+  wakeTxThread();
+  TimerWheel::getShared().cancel(parkTimerId.exchange(TimerWheel::INVALID_TIMER_ID));
+  TimerWheel::getShared().cancel(parkedLivenessTimerId.exchange(TimerWheel::INVALID_TIMER_ID));
   logger->severe("Dongvin, teardown current session. session id : " + sessionId);
   sessionDestroyTimeSecUtc = sntpRefTimeProvider.getRefTimeSecForCurrentTask();
   stopAllPeriodicTasks();
@@ -482,6 +812,16 @@ void Session::recordBitrateTestResult() {
   testInfos << "ContentsAvgFullStreamingBitrateMbps=" << get_mbpsCurBitrate() << "\n";
   testInfos << "ServerRealAvgTxBitrateMbps=" << avgTxMbps << "\n";
   testInfos << "ClientRealAvgRxBitrateMbps=" << avgRxMbps << "\n";
+  testInfos << "InitialTimeToFirstFrameMs=" << initialTimeToFirstFrameUs / 1000 << "\n";
+  // server side counterpart of 'Over 33 ms Cnt' of the client. frames late on the server, not on the network.
+  const uint64_t frameCnt = deliveredFrameCnt.load(std::memory_order_relaxed);
+  testInfos << "ServerDeliveredFrameCnt=" << frameCnt << "\n";
+  testInfos << "ServerOnTimeFrameRatio=" << (
+    frameCnt == 0 ? 0.0f : static_cast<float>(onTimeFrameCnt.load(std::memory_order_relaxed)) / frameCnt
+  ) << "\n";
+  const LatencyHistogram::Snapshot frameLatenessSnapshot = frameLatenessHistogram.getSnapshot();
+  testInfos << "ServerFrameLatenessP99Ms=" << frameLatenessSnapshot.getValueAtQuantile(0.99) / 1000 << "\n";
+  testInfos << "ServerFrameLatenessMaxMs=" << frameLatenessSnapshot.maxUs / 1000 << "\n";
   testInfos << "DeviceModel=" << deviceModelNo << "\n";
   testInfos << "Manufacturer=" << manufacturer << "\n";
   testInfos << "SessionId=" << sessionId << "\n";
@@ -551,9 +891,8 @@ void Session::stopAllPeriodicTasks() {
   try {
     bitrateRecodeTask.stop();
 
-    // stop the sample reading tasks first.
-    for (const auto& taskPtr : videoReadingTaskVec) taskPtr->stop();
-    for (const auto& taskPtr : audioReadingTaskVec) taskPtr->stop();
+    // stop the sample reading tracks first.
+    stopCurrentMediaReadingTasks(true);
 
     // discard all rtp packets in the queue.
     // this makes all std::shared_ptrs of Sample to be deleted from memory.
@@ -579,15 +918,66 @@ void Session::closeSocket() {
   }
 }
 
-void Session::transmitRtspRes(std::unique_ptr<Buffer> bufPtr) {
-  boost::system::error_code ignored_error;
-  boost::asio::write(*socketPtr, boost::asio::buffer(bufPtr->buf), ignored_error);
-  sentBitsSize += (bufPtr->len * 8);
+void Session::enqueueRtspRes(Buffer& buf) {
+  {
+    std::lock_guard<std::mutex> guard(rtspTxLock);
+    // hand the response over to the tx thread, and give the buffer a sent one back.
+    std::vector<unsigned char> recycledBuf;
+    if (!rtspTxFreeBufs.empty()) {
+      recycledBuf = std::move(rtspTxFreeBufs.back());
+      rtspTxFreeBufs.pop_back();
+      recycledBuf.clear();
+    }
+    buf.buf.resize(buf.len);
+    rtspTxLane.push_back(RtspTxItem{std::move(buf.buf), std::move(buf.afterTx)});
+    buf.buf = std::move(recycledBuf);
+    buf.afterTx = nullptr;
+    buf.len = 0;
+    pendingRtspResCnt.fetch_add(1, std::memory_order_release);
+  }
+  wakeTxThread();
+}
+
+void Session::transmitRtspRes() {
+  // called by the tx thread only.
+  while (true) {
+    std::vector<unsigned char> response;
+    std::function<void()> afterTx;
+    {
+      std::lock_guard<std::mutex> guard(rtspTxLock);
+      if (rtspTxLane.empty()) return;
+      response = std::move(rtspTxLane.front().response);
+      afterTx = std::move(rtspTxLane.front().afterTx);
+      rtspTxLane.pop_front();
+    }
+    pendingRtspResCnt.fetch_sub(1, std::memory_order_acq_rel);
+
+    boost::system::error_code ignored_error;
+    const int64_t writeStartTimeNs = Util::getElapsedTimeNanoSec();
+    boost::asio::write(*socketPtr, boost::asio::buffer(response), ignored_error);
+    HotPathMetrics::getShared().socketWriteUs.record((Util::getElapsedTimeNanoSec() - writeStartTimeNs) / 1000);
+    sentBitsTotal.store(
+      sentBitsTotal.load(std::memory_order_relaxed) + response.size() * 8, std::memory_order_relaxed
+    );
+    if (afterTx) afterTx();
+
+    std::lock_guard<std::mutex> guard(rtspTxLock);
+    if (rtspTxFreeBufs.size() < C::RTSP_TX_FREE_BUF_CNT) rtspTxFreeBufs.push_back(std::move(response));
+  }
 }
 
 void Session::enqueueRtpInfo(RtpPacketInfo* rtpPacketInfoPtr) {
+  rtpPacketInfoPtr->enqueueTimeNs = Util::getElapsedTimeNanoSec();
+  rtpPacketInfoPtr->deadlineNs = C::INVALID_OFFSET;
+  rtpPacketInfoPtr->deadlineEpoch = frameDeadlineEpoch.load(std::memory_order_relaxed);
+  if (rtpPacketInfoPtr->flag == C::VIDEO_ID && frameDeadlineAnchorNs != C::INVALID_OFFSET) {
+    rtpPacketInfoPtr->deadlineNs = frameDeadlineAnchorNs
+      + (rtpPacketInfoPtr->sampleNo - frameDeadlineAnchorSampleNo + 1) * videoFrameIntervalUs * 1000;
+  }
   // repeat until success
   while (!rtpQueuePtr->push(rtpPacketInfoPtr)) {}
+  queuedRtpCnt.fetch_add(1, std::memory_order_relaxed);
+  wakeTxThread();
 }
 
 void Session::enqueueRtpForMemoryMgmt(std::shared_ptr<RtpPacketInfo> rtpPacketPtr) {
@@ -603,6 +993,10 @@ void Session::updateReadLastAudioSample(){
   if(readingEndSampleStatusVec.size() == 2) readingEndSampleStatusVec[1] = true;
 }
 
+void Session::addPrewarmedBytes(int64_t byteDelta) {
+  prewarmedBytes.fetch_add(byteDelta, std::memory_order_relaxed);
+}
+
 bool Session::isNewSampleAllocatable() {
   if (allocatedBytesForSample.load(std::memory_order_relaxed) < C::MAX_CLIENT_BUFFER_SIZE) {
     return true;
@@ -615,21 +1009,51 @@ void Session::clearRtpQueue() {
   // it's because, clear() util needs a locking mechanism but boost lock free has no locking mechanism.
   auto new_queue = std::make_unique<boost::lockfree::queue<RtpPacketInfo*>>(C::RTP_TX_QUEUE_SIZE);
   rtpQueuePtr.swap(new_queue);  // old queue is discarded
+  droppedRtpCnt.fetch_add(queuedRtpCnt.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
 }
 
 void Session::updateOptionsReqTimeMillis(const int64_t inputOptionsReqTimeMillis){
   latestOptionsReqTimeMillis = inputOptionsReqTimeMillis;
 }
 
+SessionMetrics Session::getMetrics() const {
+  SessionMetrics metrics;
+  metrics.txBitrateBps = txBitrateBps.load(std::memory_order_relaxed);
+  metrics.queuedRtpCnt = std::max<int64_t>(queuedRtpCnt.load(std::memory_order_relaxed), 0);
+  metrics.allocatedBytesForSample = allocatedBytesForSample.load(std::memory_order_relaxed);
+  metrics.prewarmedBytes = prewarmedBytes.load(std::memory_order_relaxed);
+  metrics.sentRtpCnt = sentRtpCnt.load(std::memory_order_relaxed);
+  metrics.readVideoSampleCnt = readSampleCnts[C::VIDEO_ID].load(std::memory_order_relaxed);
+  metrics.readAudioSampleCnt = readSampleCnts[C::AUDIO_ID].load(std::memory_order_relaxed);
+  metrics.lateSampleCnt = lateSampleCnt.load(std::memory_order_relaxed);
+  metrics.droppedRtpCnt = droppedRtpCnt.load(std::memory_order_relaxed);
+  metrics.deliveredFrameCnt = deliveredFrameCnt.load(std::memory_order_relaxed);
+  metrics.onTimeFrameCnt = onTimeFrameCnt.load(std::memory_order_relaxed);
+  const LatencyHistogram::Snapshot frameLatenessSnapshot = frameLatenessHistogram.getSnapshot();
+  metrics.frameLatenessP99Us = frameLatenessSnapshot.getValueAtQuantile(0.99);
+  metrics.frameLatenessMaxUs = frameLatenessSnapshot.maxUs;
+  metrics.isPaused = isPaused;
+  metrics.isParked = isParked;
+  return metrics;
+}
+
+void Session::countReadSample(int mediaType) {
+  if (mediaType == C::VIDEO_ID || mediaType == C::AUDIO_ID) {
+    readSampleCnts[mediaType].fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
 void Session::transmitRtp() {
   if (rtpQueuePtr->empty()) {
     return;
   }
   RtpPacketInfo* rtpPacketInfoPtr = nullptr;
   if (rtpQueuePtr->pop(rtpPacketInfoPtr) && rtpPacketInfoPtr) {
+    queuedRtpCnt.fetch_sub(1, std::memory_order_relaxed);
     boost::system::error_code ignored_error;
     // send only valid rtps
     if (rtpPacketInfoPtr->length != C::INVALID){
+      const int64_t writeStartTimeNs = Util::getElapsedTimeNanoSec();
       if (rtpPacketInfoPtr->flag == C::VIDEO_ID) {
         // tx video rtp
         boost::asio::write(
@@ -642,6 +1066,9 @@ void Session::transmitRtp() {
         );
         rtpPacketInfoPtr->samplePtr->refCount -= 1;
         allocatedBytesForSample.fetch_sub(rtpPacketInfoPtr->length);
+        if (playRequestTimeNs.load(std::memory_order_relaxed) != C::INVALID_OFFSET) {
+          recordTimeToFirstFrame();
+        }
       } else {
         // tx audio rtp
         boost::asio::write(
@@ -652,11 +1079,42 @@ void Session::transmitRtp() {
         rtpPacketInfoPtr->samplePtr->refCount -= 1;
         allocatedBytesForSample.fetch_sub(rtpPacketInfoPtr->length);
       }
-      sentBitsSize += static_cast<int>(rtpPacketInfoPtr->length * 8);
+      const int64_t writeEndTimeNs = Util::getElapsedTimeNanoSec();
+      HotPathMetrics& hotPathMetrics = HotPathMetrics::getShared();
+      hotPathMetrics.socketWriteUs.record((writeEndTimeNs - writeStartTimeNs) / 1000);
+      hotPathMetrics.rtpQueueDwellUs.record((writeEndTimeNs - rtpPacketInfoPtr->enqueueTimeNs) / 1000);
+      sentBitsTotal.store(
+        sentBitsTotal.load(std::memory_order_relaxed) + rtpPacketInfoPtr->length * 8, std::memory_order_relaxed
+      );
+      sentRtpCnt.store(sentRtpCnt.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      if (rtpPacketInfoPtr->flag == C::VIDEO_ID) trackFrameDelivery(*rtpPacketInfoPtr, writeEndTimeNs);
     }// end of length check if
   }
 }
 
+void Session::waitForTxWork() {
+  // called by the tx thread only.
+  std::unique_lock<std::mutex> guard(txWakeLock);
+  isTxThreadWaiting.store(true);
+  // pairs with the fence in wakeTxThread(). either the producer sees the flag, or this sees the new work.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  txWakeCv.wait(guard, [this](){
+    return isToreDown
+      || pendingRtspResCnt.load(std::memory_order_acquire) > 0
+      || parkRequestId.load() != txAckedParkRequestId
+      || (!isPaused && !rtpQueuePtr->empty());
+  });
+  isTxThreadWaiting.store(false);
+}
+
+void Session::wakeTxThread() {
+  // producers pay for the lock only while the tx thread sleeps.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!isTxThreadWaiting.load()) return;
+  std::lock_guard<std::mutex> guard(txWakeLock);
+  txWakeCv.notify_one();
+}
+
 void Session::asyncReceive() {
   if (isRecordSaved) {
     logger->severe("Dongvin, session already shutdown.");
@@ -668,14 +1126,22 @@ void Session::asyncReceive() {
   }
 
   auto self = shared_from_this();
-  auto buf = std::make_shared<std::vector<unsigned char>>(C::RTSP_MSG_BUFFER_SIZE);  // shared buffer
-  socketPtr->async_read_some(
-    boost::asio::buffer(*buf),
+  // waits for readability with no buffer. an idle connection holds no receive buffer.
+  socketPtr->async_wait(
+    boost::asio::ip::tcp::socket::wait_read,
     boost::asio::bind_executor(
       strand,
       // this lambda will be passed to io_context.
       // to safely reference the Session object in lambda, self ptr is made and captured in this lambda.
-    [this, self, buf](const boost::system::error_code& error, std::size_t bytesRead) {
+    [this, self](const boost::system::error_code& waitError) {
+      // one receive buffer per worker thread. the bytes are appended to rtspBuffer right away.
+      thread_local std::vector<unsigned char> receiveBuf(C::RTSP_MSG_BUFFER_SIZE);
+      boost::system::error_code error = waitError;
+      std::size_t bytesRead = 0;
+      if (!error) {
+        // readable. returns the data, or eof, without blocking.
+        bytesRead = socketPtr->read_some(boost::asio::buffer(receiveBuf), error);
+      }
       if (error) {
         if (error == boost::asio::error::eof) {
           logger->warning("Dongvin, connection closed by peer. session id : " + sessionId);
@@ -685,37 +1151,62 @@ void Session::asyncReceive() {
         return;
       }
       // append new data to the RTSP buffer. rtspBuffer is initialized at Session.h as a member of Session class.
-      rtspBuffer.append(reinterpret_cast<char*>(buf->data()), bytesRead);
-      // parse and extract one requests and process it
-      while (true) {
-        size_t pos = rtspBuffer.find(C::CRLF2);  // look for full RTSP request
-        if (pos == std::string::npos) break;  // no complete request yet
-        std::string request = rtspBuffer.substr(0, pos + 4);
-        rtspBuffer.erase(0, pos + 4);  // Remove processed request
-        auto bufferPtr = std::make_unique<Buffer>(
-          std::vector<unsigned char>(request.begin(), request.end()), 0, request.size()
-        );
-        handleRtspRequest(*bufferPtr);
-
-        bool isTearRes = false;
-        bool isErrorRes = false;
-        std::string res = bufferPtr->getString();
-        logger->warning("Dongvin, " + sessionId + ", rtsp response: ");
-        for (auto& resLine : Util::splitToVecByStringForRtspMsg(res, C::CRLF)) {
-          logger->info(resLine);
-          if (resLine.find("Teardown:") != std::string::npos) isTearRes = true;
-          if (resLine.find("Error:") != std::string::npos) isErrorRes = true;
-        }
-        std::cout << "\n";
-        transmitRtspRes(std::move(bufferPtr));
-        if (isTearRes || isErrorRes) {
-          Util::delayedExecutorAsyncByThread(C::TEARDOWN_DELAY_MS, [this](){onTeardown();});
-          return; // stop receiving rtsp req after shutting down session
-        }
-      }
-      // post next asyncReceive() on strand to avoid deep recursion
-      boost::asio::post(strand, [self](){ self->asyncReceive(); });
+      rtspBuffer.append(reinterpret_cast<char*>(receiveBuf.data()), bytesRead);
+      processRtspBuffer();
     }// end of lambda which will be passed to io_context.
 
-  ));// end of bind_executor() and async_read_some()
-}
\ No newline at end of file
+  ));// end of bind_executor() and async_wait()
+}
+
+void Session::processRtspBuffer() {
+  // called on the strand only.
+  if (isRecordSaved) return;
+  auto self = shared_from_this();
+  // parse pipelined requests in place. the parsed request points into rtspBuffer,
+  // so the consumed bytes are erased once, after the loop.
+  size_t parsedLen = 0;
+  while (true) {
+    RtspRequest request;
+    size_t consumedLen = 0;
+    const RtspParseResult parseResult = RtspRequestParser::parse(
+      std::string_view(rtspBuffer).substr(parsedLen), request, consumedLen
+    );
+    if (parseResult == RtspParseResult::INCOMPLETE) break;  // no complete request yet
+    if (parseResult == RtspParseResult::BAD_REQUEST) {
+      logger->severe("Dongvin, malformed rtsp request is dropped. session id : " + sessionId);
+    }
+
+    if (
+      const std::string cid = rtspHandlerPtr->findRequestedContent(request);
+      !cid.empty() && contentsStorage.needsLoading(cid)
+    ) {
+      // the first request of a content. its meta is loaded off the strand, and this request is
+      // parsed again once it is ready. receiving stops until then, so the requests keep their order.
+      rtspBuffer.erase(0, parsedLen);
+      contentsStorage.loadContentAsync(cid, [this, self]() {
+        boost::asio::post(strand, [this, self]() { processRtspBuffer(); });
+      });
+      return;
+    }
+    parsedLen += consumedLen;
+
+    rtspResponseBuffer.buf.clear();
+    rtspResponseBuffer.len = 0;
+    handleRtspRequest(request, rtspResponseBuffer);
+    if (rtspResponseBuffer.buf.empty()) continue;
+
+    logger->warning("Dongvin, " + sessionId + ", rtsp response: ");
+    logger->info(rtspResponseBuffer.getString());
+    enqueueRtspRes(rtspResponseBuffer);
+    if (
+      RtspResponseWriter::hasFlag(rtspResponseBuffer, RtspResponseFlag::TEARDOWN)
+      || RtspResponseWriter::hasFlag(rtspResponseBuffer, RtspResponseFlag::ERROR)
+    ) {
+      scheduleTeardown();
+      return; // stop receiving rtsp req after shutting down session
+    }
+  }
+  rtspBuffer.erase(0, parsedLen);  // Remove processed requests
+  // post next asyncReceive() on strand to avoid deep recursion
+  boost::asio::post(strand, [self](){ self->asyncReceive(); });
+}
\ No newline at end of file
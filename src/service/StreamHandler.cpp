@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 
 #include "../include/StreamHandler.h"
@@ -29,6 +30,11 @@ void StreamHandler::updateCurSampleNo(int mediaType, int idx) {
   }
 }
 
+int StreamHandler::getCurSampleNo(int mediaType) {
+  if (sInfo.find(mediaType) == sInfo.end()) return C::INVALID;
+  return sInfo.at(mediaType).curSampleNo;
+}
+
 int StreamHandler::getCamId() {
   return camId;
 }
@@ -57,10 +63,19 @@ void StreamHandler::initUserRequestingPlaytime(std::vector<float> timeS) {
     info.endSampleNo = findSampleNumber(streamId, Util::secToUs(timeS[1]));
     info.curSampleNo = info.startSampleNo;
 
-    std::unique_ptr<Buffer> rtpPtr = get1stRtpOfRefSample(streamId, info.startSampleNo);
-    if (rtpPtr != nullptr){
+    // taken from the index built on content loading. the disk is read only if the index has no entry.
+    bool isRtpHeadFound = false;
+    if (SampleRtpHead rtpHead; contentFileMetaPtr->getFirstRtpHead(streamId, info.startSampleNo, rtpHead)) {
+      info.timestamp = rtpHead.timestamp;
+      info.refSeq0 = rtpHead.seq;
+      isRtpHeadFound = true;
+    } else if (std::unique_ptr<Buffer> rtpPtr = get1stRtpOfRefSample(streamId, info.startSampleNo); rtpPtr != nullptr) {
       info.timestamp = Util::findTimestamp(*rtpPtr);
       info.refSeq0 = Util::findSequenceNumber(*rtpPtr);
+      isRtpHeadFound = true;
+    }
+
+    if (isRtpHeadFound){
 
       // check --> removable.
       checkTimestamp(streamId, info);
@@ -83,10 +98,16 @@ void StreamHandler::initUserRequestingPlaytime(std::vector<float> timeS) {
   return false;
 }
 
-bool StreamHandler::setReaderAndContentTitle(ContentFileMeta& inputReader, std::string inputContentTitle) {
+bool StreamHandler::setReaderAndContentTitle(std::shared_ptr<ContentFileMeta> inputReaderPtr, std::string inputContentTitle) {
+  if (inputReaderPtr == nullptr) {
+    logger->severe("Dongvin, content meta is not loaded! : " + inputContentTitle);
+    return false;
+  }
   if (inputContentTitle != C::EMPTY_STRING) {
     contentTitle = inputContentTitle;
   }
+  contentFileMetaPtr = std::move(inputReaderPtr);
+  ContentFileMeta& inputReader = *contentFileMetaPtr;
   auto& videoMetaMap = inputReader.getConstVideoMeta();
   if (videoMetaMap.empty()){
     logger->severe("Dongvin, video meta init wrong!");
@@ -112,6 +133,10 @@ bool StreamHandler::setReaderAndContentTitle(ContentFileMeta& inputReader, std::
   return false;
 }
 
+std::shared_ptr<ContentFileMeta> StreamHandler::getContentFileMetaPtr() const {
+  return contentFileMetaPtr;
+}
+
 int StreamHandler::getLastVideoSampleNumber() {
   if (sInfo.find(C::VIDEO_ID) != sInfo.end()) {
     return sInfo.at(C::VIDEO_ID).maxSampleNo;
@@ -128,50 +153,22 @@ int StreamHandler::getLastAudioSampleNumber() {
   return C::INVALID;
 }
 
-std::vector<unsigned char> StreamHandler::getAccData() {
-  return contentsStorage.getCid(contentTitle).getAccDataCopy();
+std::shared_ptr<const std::vector<unsigned char>> StreamHandler::getAccData() {
+  return contentFileMetaPtr->getAccData();
 }
 
-std::vector<std::vector<unsigned char>> StreamHandler::getAllV0Images() {
-  return contentsStorage.getCid(contentTitle).getAllV0ImagesCopy();
+std::shared_ptr<const std::vector<std::vector<unsigned char>>> StreamHandler::getAllV0Images() {
+  return contentFileMetaPtr->getAllV0Images();
 }
 
 bool StreamHandler::setVideoAudioSampleMetaDataCache(const std::string& contentTitle) {
   try {
-    const auto& metaMap = contentsStorage.getContentFileMetaMap();
-    const auto& contentMeta = metaMap.at(contentTitle).getConstVideoMeta();
-
-    const auto cam0Iter = contentMeta.find(C::CAM_ID_LIST[0]);
-    const auto cam1Iter = contentMeta.find(C::CAM_ID_LIST[1]);
-    const auto cam2Inter = contentMeta.find(C::CAM_ID_LIST[2]);
-
-    if (cam0Iter != contentMeta.end()) {
-      const auto& frontVMeta
-        = cam0Iter->second.getConstVideoSampleInfoList().at(C::FRONT_VIDEO_VID);
-      const auto& rearVMeta
-        = cam0Iter->second.getConstVideoSampleInfoList().at(C::REAR_VIDEO_VID);
-      cachedCam0frontVSampleMetaListPtr = &frontVMeta;
-      cachedCam0rearVSampleMetaListPtr = &rearVMeta;
-    }
-    if (cam1Iter != contentMeta.end()) {
-      const auto& frontVMeta
-        = cam1Iter->second.getConstVideoSampleInfoList().at(C::FRONT_VIDEO_VID);
-      const auto& rearVMeta
-        = cam1Iter->second.getConstVideoSampleInfoList().at(C::REAR_VIDEO_VID);
-      cachedCam1frontVSampleMetaListPtr = &frontVMeta;
-      cachedCam1rearVSampleMetaListPtr = &rearVMeta;
-    }
-    if (cam2Inter != contentMeta.end()) {
-      const auto& frontVMeta
-        = cam2Inter->second.getConstVideoSampleInfoList().at(C::FRONT_VIDEO_VID);
-      const auto& rearVMeta
-        = cam2Inter->second.getConstVideoSampleInfoList().at(C::REAR_VIDEO_VID);
-      cachedCam2frontVSampleMetaListPtr = &frontVMeta;
-      cachedCam2rearVSampleMetaListPtr = &rearVMeta;
+    if (contentFileMetaPtr == nullptr) {
+      throw std::runtime_error("content meta is not set. : " + contentTitle);
     }
+    cacheVideoSampleMetaLists(bitrateVariantIdx);
 
-    const auto& audioMeta = contentsStorage.getContentFileMetaMap().at(contentTitle)
-          .getConstAudioMeta().getConstMeta();
+    const auto& audioMeta = contentFileMetaPtr->getConstAudioMeta().getConstMeta();
     cachedAudioSampleMetaListPtr = &audioMeta;
 
     return true;
@@ -200,6 +197,9 @@ void StreamHandler::getNextVideoSample() {
       }
 
       const int sampleNo = info.curSampleNo;
+      if (pendingBitrateVariantIdx != bitrateVariantIdx) {
+        switchBitrateVariantOnKeyFrame(*rtpHandlerPtr, sampleNo);
+      }
       const VideoSampleInfo& curFrontVideoSampleInfo
         = camId == 0 ? cachedCam0frontVSampleMetaListPtr->at(sampleNo)
           : camId == 1 ? cachedCam1frontVSampleMetaListPtr->at(sampleNo)
@@ -212,6 +212,13 @@ void StreamHandler::getNextVideoSample() {
             : camId == 2 ? cachedCam2rearVSampleMetaListPtr->at(sampleNo)
               : VideoSampleInfo();
 
+      if (contentsStorage.getBlockCache() != nullptr) {
+        updateVideoPlaybackWindow(*rtpHandlerPtr, sampleNo);
+      }
+      if (C::USE_CAM_SWITCH_PREWARM) {
+        requestCamSwitchPrewarm(*rtpHandlerPtr, sampleNo);
+      }
+
       rtpHandlerPtr->readVideoSample(
         curFrontVideoSampleInfo,
         curRearVideoSampleInfo,
@@ -220,6 +227,7 @@ void StreamHandler::getNextVideoSample() {
         sampleNo,
         sessionPtr->getHybridMetaMap()
       );
+      sessionPtr->countReadSample(C::VIDEO_ID);
 
       /* do not need on playing
        if (videoSampleRtpPtr->length != C::INVALID) {
@@ -263,12 +271,17 @@ void StreamHandler::getNextAudioSample() {
       const AudioSampleInfo& curAudioSampleInfo
         = cachedAudioSampleMetaListPtr->at(sampleNo);
 
+      if (contentsStorage.getBlockCache() != nullptr) {
+        updateAudioPlaybackWindow(*rtpHandlerPtr, sampleNo);
+      }
+
       rtpHandlerPtr->readAudioSample(
         sampleNo,
         curAudioSampleInfo.offset,
         curAudioSampleInfo.len,
         sessionPtr->getHybridMetaMap()
       );
+      sessionPtr->countReadSample(C::AUDIO_ID);
 
       /* do not need an playing
        if (audioSampleRtpPtr->length != C::INVALID) {
@@ -314,8 +327,8 @@ int64_t StreamHandler::getUnitFrameTimeUs(int streamId) {
   return C::INVALID;
 }
 
-std::string StreamHandler::getMediaInfo() {
-  return contentsStorage.getCid(contentTitle).getMediaInfoCopy();
+std::shared_ptr<const PreRenderedSdp> StreamHandler::getPreRenderedSdp() {
+  return contentFileMetaPtr->getPreRenderedSdp();
 }
 
 std::vector<int64_t> StreamHandler::getSsrc() {
@@ -327,13 +340,12 @@ std::vector<int64_t> StreamHandler::getSsrc() {
 }
 
 int StreamHandler::getMainVideoNumber() {
-  ContentFileMeta& fileReader = contentsStorage.getCid(contentTitle);
-  const auto& videoMeta = fileReader.getConstVideoMeta();
-  return videoMeta.at(C::REF_CAM).getFileNumber();
+  const auto& videoMeta = contentFileMetaPtr->getConstVideoMeta();
+  return videoMeta.at(contentFileMetaPtr->getRefCamDirName()).getFileNumber();
 }
 
 int StreamHandler::getMaxCamNumber() {
-  return static_cast<int>(contentsStorage.getCid(contentTitle).getConstVideoMeta().size());
+  return contentFileMetaPtr->getNumberOfCamDirectories();
 }
 
 std::vector<int> StreamHandler::getInitialSeq() {
@@ -418,6 +430,25 @@ void StreamHandler::setCamId(int inputCamId) {
   this->camId = inputCamId;
 }
 
+void StreamHandler::requestBitrateVariant(int variantIdx) {
+  if (variantIdx < 0 || variantIdx >= static_cast<int>(contentFileMetaPtr->getMbpsTypeList().size())) return;
+  pendingBitrateVariantIdx = variantIdx;
+}
+
+int StreamHandler::getBitrateVariantIdx() const {
+  return bitrateVariantIdx;
+}
+
+int StreamHandler::getPendingBitrateVariantIdx() const {
+  return pendingBitrateVariantIdx;
+}
+
+void StreamHandler::resetReadAheadWindows() {
+  videoWindowCamId = C::INVALID;
+  audioWindowBeginSampleNo = C::INVALID;
+  prewarmCamId = C::INVALID;
+}
+
 void StreamHandler::findNextSampleForSwitching(int vid, std::vector<int64_t> timeInfo) {
   if (timeInfo.size() != 2) {
     logger->severe("Dongvin, invalid switching time info to find next samples!");
@@ -433,8 +464,7 @@ std::unique_ptr<Buffer> StreamHandler::get1stRtpOfRefSample(int streamId, int sa
     if (auto rtpHandlerPtr = weakPtr.lock()) {
       // read video sample.
       if (streamId == C::VIDEO_ID) {
-        const VideoSampleInfo& curVideoSampleInfo = contentsStorage.getContentFileMetaMap().at(sessionPtr->getContentTitle())
-          .getConstVideoMeta().at(C::CAM_ID_LIST[camId]).getConstVideoSampleInfoList().at(0).at(sampleNo);
+        const VideoSampleInfo& curVideoSampleInfo = contentFileMetaPtr->getConstVideoMeta().at(contentFileMetaPtr->getRefCamDirName()).getConstVideoSampleInfoList().at(0).at(sampleNo);
 
         const int64_t offset = curVideoSampleInfo.getOffset();
         const int64_t len = curVideoSampleInfo.getSize();
@@ -442,8 +472,7 @@ std::unique_ptr<Buffer> StreamHandler::get1stRtpOfRefSample(int streamId, int sa
         return rtpHandlerPtr->readFirstRtpOfCurVideoSample(sampleNo, offset, len);
       }
       // read audio sample. one audio sample == one rtp packet.
-      const AudioSampleInfo& curAudioSampleInfo = contentsStorage.getContentFileMetaMap().at(sessionPtr->getContentTitle())
-        .getConstAudioMeta().getConstMeta().at(sampleNo);
+      const AudioSampleInfo& curAudioSampleInfo = contentFileMetaPtr->getConstAudioMeta().getConstMeta().at(sampleNo);
       const int64_t offset = curAudioSampleInfo.offset;
       const int64_t len = curAudioSampleInfo.len;
 
@@ -616,12 +645,15 @@ int StreamHandler::getSampleTimeIndex(int streamId, int64_t timestamp) {
 }
 
 int64_t StreamHandler::getTimestamp(const int sampleNo) {
+  if (SampleRtpHead rtpHead; contentFileMetaPtr->getFirstRtpHead(C::VIDEO_ID, sampleNo, rtpHead)) {
+    return rtpHead.timestamp;
+  }
+
   if (auto sessionPtr = parentSessionPtr.lock()) {
     std::weak_ptr<RtpHandler> weakPtr = sessionPtr->getRtpHandlerPtr();
     if (const auto rtpHandlerPtr = weakPtr.lock()) {
 
-      const auto& curVideoSampleInfo = contentsStorage.getContentFileMetaMap().at(sessionPtr->getContentTitle())
-          .getConstVideoMeta().at(C::CAM_ID_LIST[0]).getConstVideoSampleInfoList().at(0).at(sampleNo);
+      const auto& curVideoSampleInfo = contentFileMetaPtr->getConstVideoMeta().at(contentFileMetaPtr->getRefCamDirName()).getConstVideoSampleInfoList().at(0).at(sampleNo);
 
       const int64_t offset = curVideoSampleInfo.getOffset();
       const int64_t length = curVideoSampleInfo.getSize();
@@ -635,3 +667,170 @@ int64_t StreamHandler::getTimestamp(const int sampleNo) {
   logger->severe("Dongvin, failed to get session ptr!");
   return C::INVALID_BYTE;
 }
+
+const std::vector<VideoSampleInfo> * StreamHandler::getFrontVSampleMetaListPtr(int inputCamId) const {
+  return inputCamId == 0 ? cachedCam0frontVSampleMetaListPtr
+    : inputCamId == 1 ? cachedCam1frontVSampleMetaListPtr
+      : inputCamId == 2 ? cachedCam2frontVSampleMetaListPtr
+        : nullptr;
+}
+
+const std::vector<VideoSampleInfo> * StreamHandler::getRearVSampleMetaListPtr(int inputCamId) const {
+  return inputCamId == 0 ? cachedCam0rearVSampleMetaListPtr
+    : inputCamId == 1 ? cachedCam1rearVSampleMetaListPtr
+      : inputCamId == 2 ? cachedCam2rearVSampleMetaListPtr
+        : nullptr;
+}
+
+void StreamHandler::cacheVideoSampleMetaLists(int variantIdx) {
+  const int mbps = getVariantMbps(variantIdx);
+  const VideoAccess* cam0AccessPtr = contentFileMetaPtr->findVideoAccess(0, mbps);
+  const VideoAccess* cam1AccessPtr = contentFileMetaPtr->findVideoAccess(1, mbps);
+  const VideoAccess* cam2AccessPtr = contentFileMetaPtr->findVideoAccess(2, mbps);
+
+  if (cam0AccessPtr != nullptr) {
+    cachedCam0frontVSampleMetaListPtr = &cam0AccessPtr->getConstVideoSampleInfoList().at(C::FRONT_VIDEO_VID);
+    cachedCam0rearVSampleMetaListPtr = &cam0AccessPtr->getConstVideoSampleInfoList().at(C::REAR_VIDEO_VID);
+  }
+  if (cam1AccessPtr != nullptr) {
+    cachedCam1frontVSampleMetaListPtr = &cam1AccessPtr->getConstVideoSampleInfoList().at(C::FRONT_VIDEO_VID);
+    cachedCam1rearVSampleMetaListPtr = &cam1AccessPtr->getConstVideoSampleInfoList().at(C::REAR_VIDEO_VID);
+  }
+  if (cam2AccessPtr != nullptr) {
+    cachedCam2frontVSampleMetaListPtr = &cam2AccessPtr->getConstVideoSampleInfoList().at(C::FRONT_VIDEO_VID);
+    cachedCam2rearVSampleMetaListPtr = &cam2AccessPtr->getConstVideoSampleInfoList().at(C::REAR_VIDEO_VID);
+  }
+}
+
+int StreamHandler::getVariantMbps(int variantIdx) const {
+  const std::vector<int>& mbpsTypeList = contentFileMetaPtr->getMbpsTypeList();
+  return mbpsTypeList.empty() ? C::INVALID : mbpsTypeList.at(variantIdx);
+}
+
+void StreamHandler::switchBitrateVariantOnKeyFrame(RtpHandler& rtpHandler, int sampleNo) {
+  const VideoAccess* nextAccessPtr = contentFileMetaPtr->findVideoAccess(camId, getVariantMbps(pendingBitrateVariantIdx));
+  if (nextAccessPtr == nullptr) {
+    // not looked up again on every frame. ABR asks again from the current bitrate after its hold time.
+    logger->warning(
+      "Dongvin, sessionId : " + sessionId + ", stays on the current bitrate. cam " + std::to_string(camId)
+      + " has no " + std::to_string(getVariantMbps(pendingBitrateVariantIdx)) + "mbps variant."
+    );
+    pendingBitrateVariantIdx = bitrateVariantIdx;
+    return;
+  }
+  // a P frame of the next variant can not be decoded on top of the frames of the current one.
+  const std::vector<VideoSampleInfo>& nextFrontList = nextAccessPtr->getConstVideoSampleInfoList().at(C::FRONT_VIDEO_VID);
+  if (sampleNo >= static_cast<int>(nextFrontList.size()) || nextFrontList[sampleNo].getFlag() != C::KEY_FRAME_FLAG) {
+    return;
+  }
+
+  if (!rtpHandler.setBitrateVariant(pendingBitrateVariantIdx)) {
+    logger->severe("Dongvin, sessionId : " + sessionId + ", stays on the current bitrate. failed to open the next one.");
+    pendingBitrateVariantIdx = bitrateVariantIdx;
+    return;
+  }
+  cacheVideoSampleMetaLists(pendingBitrateVariantIdx);
+  logger->info3(
+    "Dongvin, sessionId : " + sessionId + ", bitrate is changed to "
+    + std::to_string(getVariantMbps(pendingBitrateVariantIdx)) + "mbps on sample " + std::to_string(sampleNo)
+  );
+  bitrateVariantIdx = pendingBitrateVariantIdx;
+
+  // block cache window and prewarmed samples were for the files of the previous variant.
+  videoWindowCamId = C::INVALID;
+  prewarmCamId = C::INVALID;
+}
+
+void StreamHandler::requestCamSwitchPrewarm(RtpHandler& rtpHandler, int sampleNo) {
+  const std::vector<int64_t> gopVec = getGop();
+  if (gopVec.empty() || gopVec[0] <= 0) return;
+  const int gop = static_cast<int>(gopVec[0]);
+  const int gopStartSampleNo = sampleNo - sampleNo % gop;
+  // once per gop, seek, or cam switching.
+  if (camId == prewarmCamId && gopStartSampleNo == prewarmGopStartSampleNo) return;
+  prewarmCamId = camId;
+  prewarmGopStartSampleNo = gopStartSampleNo;
+
+  std::vector<PrewarmSampleRange> ranges;
+  for (int siblingCamId = 0; siblingCamId < static_cast<int>(C::CAM_ID_LIST.size()); ++siblingCamId) {
+    if (siblingCamId == camId) continue;
+    const std::vector<VideoSampleInfo>* frontListPtr = getFrontVSampleMetaListPtr(siblingCamId);
+    const std::vector<VideoSampleInfo>* rearListPtr = getRearVSampleMetaListPtr(siblingCamId);
+    if (frontListPtr == nullptr || rearListPtr == nullptr) continue;
+
+    const int sampleCnt = static_cast<int>(std::min(frontListPtr->size(), rearListPtr->size()));
+    for (int gopIdx = 0; gopIdx < C::CAM_SWITCH_PREWARM_GOP_CNT; ++gopIdx) {
+      const int beginSampleNo = gopStartSampleNo + gop * gopIdx;
+      const int endSampleNo = std::min(beginSampleNo + C::CAM_SWITCH_PREWARM_SAMPLE_CNT, sampleCnt);
+      for (int prewarmSampleNo = beginSampleNo; prewarmSampleNo < endSampleNo; ++prewarmSampleNo) {
+        const VideoSampleInfo& front = frontListPtr->at(prewarmSampleNo);
+        const VideoSampleInfo& rear = rearListPtr->at(prewarmSampleNo);
+        if (front.getSize() == 0 || rear.getSize() == 0) continue;
+        ranges.push_back(PrewarmSampleRange{
+          siblingCamId, bitrateVariantIdx, prewarmSampleNo,
+          front.getOffset(), front.getSize(), rear.getOffset(), rear.getSize()
+        });
+      }
+    }
+  }
+  if (!ranges.empty()) rtpHandler.prewarmSamples(std::move(ranges));
+}
+
+void StreamHandler::updateVideoPlaybackWindow(RtpHandler& rtpHandler, int sampleNo) {
+  // report only on GOP boundaries, seek, or cam switching.
+  if (
+    camId == videoWindowCamId
+    && sampleNo >= videoWindowBeginSampleNo
+    && sampleNo < videoWindowEndSampleNo
+  ) {
+    return;
+  }
+
+  const std::vector<VideoSampleInfo>* frontListPtr = getFrontVSampleMetaListPtr(camId);
+  const std::vector<VideoSampleInfo>* rearListPtr = getRearVSampleMetaListPtr(camId);
+  const std::vector<int64_t> gopVec = getGop();
+  if (frontListPtr == nullptr || rearListPtr == nullptr || frontListPtr->empty() || gopVec.empty()) return;
+
+  const int gop = static_cast<int>(gopVec[0]);
+  const int lastSampleNo = static_cast<int>(std::min(frontListPtr->size(), rearListPtr->size())) - 1;
+  const int nextKeySampleNo = sampleNo - sampleNo % gop + gop;
+  const int windowLastSampleNo = std::min(
+    lastSampleNo, sampleNo - sampleNo % gop + gop * C::DIRECT_IO_READ_AHEAD_GOP_CNT - 1
+  );
+  if (sampleNo > windowLastSampleNo) return;
+
+  const VideoSampleInfo& frontBegin = frontListPtr->at(sampleNo);
+  const VideoSampleInfo& frontEnd = frontListPtr->at(windowLastSampleNo);
+  const VideoSampleInfo& rearBegin = rearListPtr->at(sampleNo);
+  const VideoSampleInfo& rearEnd = rearListPtr->at(windowLastSampleNo);
+  rtpHandler.updateVideoPlaybackWindow(
+    camId,
+    frontBegin.getOffset(), frontEnd.getOffset() + frontEnd.getSize(),
+    rearBegin.getOffset(), rearEnd.getOffset() + rearEnd.getSize()
+  );
+
+  videoWindowCamId = camId;
+  videoWindowBeginSampleNo = sampleNo;
+  videoWindowEndSampleNo = nextKeySampleNo;
+}
+
+void StreamHandler::updateAudioPlaybackWindow(RtpHandler& rtpHandler, int sampleNo) {
+  // audio has no GOP. slide the window when half of it was consumed.
+  if (
+    sampleNo >= audioWindowBeginSampleNo
+    && sampleNo < audioWindowBeginSampleNo + C::DIRECT_IO_AUDIO_READ_AHEAD_SAMPLE_CNT / 2
+  ) {
+    return;
+  }
+  if (cachedAudioSampleMetaListPtr == nullptr || cachedAudioSampleMetaListPtr->empty()) return;
+
+  const int lastSampleNo = static_cast<int>(cachedAudioSampleMetaListPtr->size()) - 1;
+  const int windowLastSampleNo = std::min(lastSampleNo, sampleNo + C::DIRECT_IO_AUDIO_READ_AHEAD_SAMPLE_CNT - 1);
+  if (sampleNo > windowLastSampleNo) return;
+
+  const AudioSampleInfo& begin = cachedAudioSampleMetaListPtr->at(sampleNo);
+  const AudioSampleInfo& end = cachedAudioSampleMetaListPtr->at(windowLastSampleNo);
+  rtpHandler.updateAudioPlaybackWindow(begin.offset, end.offset + end.len);
+
+  audioWindowBeginSampleNo = sampleNo;
+}
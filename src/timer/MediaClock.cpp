@@ -0,0 +1,159 @@
+#include "../include/MediaClock.h"
+
+#include <algorithm>
+
+#include "../constants/C.h"
+
+MediaClock::MediaClock(boost::asio::io_context& inputIoContext)
+    : logger(Logger::getLogger(C::MEDIA_CLOCK)),
+      clockStrand(boost::asio::make_strand(inputIoContext)),
+      timer(inputIoContext) {}
+
+MediaClock::~MediaClock() {
+    stop();
+}
+
+MediaClock::TrackId MediaClock::addTrack(
+    boost::asio::strand<boost::asio::io_context::executor_type> trackStrand,
+    std::chrono::microseconds interval,
+    std::weak_ptr<void> owner,
+    std::function<void()> task
+) {
+    auto trackPtr = std::make_shared<Track>(std::move(trackStrand), std::move(owner), std::move(task));
+
+    const auto firstDeadline = std::chrono::steady_clock::now() + interval;
+    TrackId trackId;
+    bool needRearm;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (isStopped || interval.count() <= 0) return INVALID_TRACK_ID;
+        trackId = ++lastTrackId;
+        trackSlots.push_back(TrackSlot{trackId, firstDeadline, interval, std::move(trackPtr)});
+        needRearm = firstDeadline < armedDeadline;
+        if (needRearm) armedDeadline = firstDeadline;
+    }
+    // the timer is touched on clockStrand only.
+    if (needRearm) boost::asio::post(clockStrand, [this](){ arm(); });
+    return trackId;
+}
+
+void MediaClock::removeTrack(TrackId trackId) {
+    if (trackId == INVALID_TRACK_ID) return;
+    std::lock_guard<std::mutex> guard(lock);
+    for (size_t i = 0; i < trackSlots.size(); ++i) {
+        if (trackSlots[i].trackId != trackId) continue;
+        trackSlots[i].trackPtr->isActive = false;
+        // order does not matter. keeps the array compact.
+        trackSlots[i] = std::move(trackSlots.back());
+        trackSlots.pop_back();
+        return;
+    }
+}
+
+void MediaClock::stop() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (isStopped) return;
+        isStopped = true;
+        for (auto& trackSlot : trackSlots) trackSlot.trackPtr->isActive = false;
+        trackSlots.clear();
+    }
+    logger->warning("Dongvin, media clock stopped. wake up lateness : " + latenessHistogram.toString());
+    // timer must be cancled before the io_context is gone.
+    timer.cancel();
+}
+
+size_t MediaClock::getTrackCnt() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return trackSlots.size();
+}
+
+const LatenessHistogram& MediaClock::getLatenessHistogram() const {
+    return latenessHistogram;
+}
+
+void MediaClock::arm() {
+    std::chrono::steady_clock::time_point earliestDeadline = std::chrono::steady_clock::time_point::max();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (isStopped) return;
+        for (const auto& trackSlot : trackSlots) {
+            earliestDeadline = std::min(earliestDeadline, trackSlot.nextDeadline);
+        }
+        armedDeadline = earliestDeadline;
+    }
+    if (earliestDeadline == std::chrono::steady_clock::time_point::max()) {
+        // no track. an idle worker does not wake up.
+        timer.cancel();
+        return;
+    }
+
+    // expires_at() cancels the previous wait. its handler gets operation_aborted.
+    timer.expires_at(earliestDeadline);
+    timer.async_wait(boost::asio::bind_executor(
+        clockStrand,
+        [this](const boost::system::error_code& ec){
+            if (ec == boost::asio::error::operation_aborted) return;
+            if (ec) {
+                logger->severe("Dongvin, media clock timer failed! error message : " + ec.message());
+                return;
+            }
+            onTick();
+        }
+    ));
+}
+
+void MediaClock::onTick() {
+    const auto now = std::chrono::steady_clock::now();
+    // tracks due a little later run in this batch too. saves one more wake up.
+    const auto batchEnd = now + std::chrono::microseconds(C::MEDIA_CLOCK_COALESCE_US);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (isStopped) return;
+        for (size_t i = 0; i < trackSlots.size();) {
+            TrackSlot& trackSlot = trackSlots[i];
+            if (trackSlot.trackPtr->owner.expired()) {
+                trackSlot = std::move(trackSlots.back());
+                trackSlots.pop_back();
+                continue;
+            }
+            if (trackSlot.nextDeadline > batchEnd) {
+                ++i;
+                continue;
+            }
+
+            latenessHistogram.record(std::max<int64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(now - trackSlot.nextDeadline).count(), 0
+            ));
+            int64_t runCnt = 1;
+            trackSlot.nextDeadline += trackSlot.interval;
+            if (trackSlot.nextDeadline <= now && trackSlot.interval.count() > 0) {
+                // missed ticks are run right away, so that the stream keeps the real time rate.
+                const int64_t missedCnt = (now - trackSlot.nextDeadline) / trackSlot.interval + 1;
+                const int64_t burstCnt = std::min(missedCnt, C::PERIODIC_TASK_MAX_BURST_CNT);
+                runCnt += burstCnt;
+                trackSlot.nextDeadline += trackSlot.interval * missedCnt;
+                if (missedCnt > burstCnt) latenessHistogram.recordSkip(missedCnt - burstCnt);
+            }
+            dueTracks.push_back(DueTrack{trackSlot.trackPtr, runCnt});
+            ++i;
+        }
+    }
+
+    for (auto& dueTrack : dueTracks) {
+        std::shared_ptr<void> ownerPtr = dueTrack.trackPtr->owner.lock();
+        if (!ownerPtr) continue;
+        // the owner is kept alive until the run is done.
+        const auto& trackStrand = dueTrack.trackPtr->strand;
+        boost::asio::post(
+            trackStrand,
+            [ownerPtr = std::move(ownerPtr), trackPtr = dueTrack.trackPtr, runCnt = dueTrack.runCnt](){
+                for (int64_t i = 0; i < runCnt && trackPtr->isActive; ++i) {
+                    trackPtr->task();
+                }
+            }
+        );
+    }
+    dueTracks.clear();
+    arm();
+}
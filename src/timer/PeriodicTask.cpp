@@ -1,13 +1,15 @@
 #include "../include/PeriodicTask.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "../constants/C.h"
+#include "../include/LatencyHistogram.h"
 
 PeriodicTask::PeriodicTask(
     boost::asio::io_context& io_context,
     boost::asio::strand<boost::asio::io_context::executor_type> inputStrand,
-    std::chrono::milliseconds inputInterval
+    std::chrono::microseconds inputInterval
 ) : strand(std::move(inputStrand)),
     timer(io_context),
     interval(inputInterval),
@@ -18,7 +20,7 @@ PeriodicTask::PeriodicTask(
 PeriodicTask::PeriodicTask(
     boost::asio::io_context& io_context,
     boost::asio::strand<boost::asio::io_context::executor_type> inputStrand,
-    std::chrono::milliseconds inputInterval,
+    std::chrono::microseconds inputInterval,
     TaskCallback inputTask
 ) : strand(std::move(inputStrand)),
     timer(io_context),
@@ -35,22 +37,32 @@ void PeriodicTask::setTask(TaskCallback inputTask) {
     isTaskSet = true;
 }
 
-void PeriodicTask::setInterval(std::chrono::milliseconds inputInterval) {
+void PeriodicTask::setInterval(std::chrono::microseconds inputInterval) {
     interval = inputInterval;
 }
 
+void PeriodicTask::setCatchUpPolicy(CatchUpPolicy inputCatchUpPolicy) {
+    catchUpPolicy = inputCatchUpPolicy;
+}
+
+const LatenessHistogram& PeriodicTask::getLatenessHistogram() const {
+    return latenessHistogram;
+}
+
 void PeriodicTask::start() {
     if (!isTaskSet) {
         logger->severe("no task to run!");
     } else {
         running = true;
+        ++runId;
+        nextDeadline = std::chrono::steady_clock::now() + interval;
         scheduleTask();
     }
 }
 
 void PeriodicTask::stop() {
     if (running == false) return;
-    logger->severe("task stop called!");
+    logger->severe("task stop called! wake up lateness : " + latenessHistogram.toString());
     running = false;
     //boost::asio::post(strand, [this]{ timer.cancel(); });
     // timer must be cancled before removing session.
@@ -58,14 +70,23 @@ void PeriodicTask::stop() {
 }
 
 void PeriodicTask::scheduleTask() {
-    timer.expires_after(interval);
+    // absolute deadline. a deadline in the past fires right away.
+    timer.expires_at(nextDeadline);
     timer.async_wait(boost::asio::bind_executor(
         strand,
-        [this](const boost::system::error_code& ec){
+        [this, scheduledRunId = runId](const boost::system::error_code& ec){
+            // stopped, or restarted. not a failure.
+            if (ec == boost::asio::error::operation_aborted || scheduledRunId != runId) return;
             if(!ec){
+                const auto now = std::chrono::steady_clock::now();
+                const int64_t latenessUs =
+                    std::chrono::duration_cast<std::chrono::microseconds>(now - nextDeadline).count();
+                latenessHistogram.record(latenessUs);
+                HotPathMetrics::getShared().periodicTaskLatenessUs.record(latenessUs);
                 if(task){
                     task();
                 }
+                advanceDeadline(now);
                 if(running){
                     scheduleTask();
                 }
@@ -76,3 +97,62 @@ void PeriodicTask::scheduleTask() {
         }
     ));
 }
+
+void PeriodicTask::advanceDeadline(std::chrono::steady_clock::time_point now) {
+    nextDeadline += interval;
+    if (nextDeadline > now || interval.count() <= 0) return;
+
+    // behind by missedCnt ticks at least.
+    const int64_t missedCnt = (now - nextDeadline) / interval + 1;
+    const int64_t skipCnt = catchUpPolicy == CatchUpPolicy::SKIP
+        ? missedCnt
+        : std::max<int64_t>(missedCnt - C::PERIODIC_TASK_MAX_BURST_CNT, 0); // never burst forever after a long stall.
+    if (skipCnt > 0) {
+        nextDeadline += interval * skipCnt;
+        latenessHistogram.recordSkip(skipCnt);
+    }
+}
+
+void LatenessHistogram::record(int64_t latenessUs) {
+    if (latenessUs < 0) latenessUs = 0;
+    size_t bucketIdx = 0;
+    while (bucketIdx < BUCKET_BOUNDS_US.size() && latenessUs > BUCKET_BOUNDS_US[bucketIdx]) ++bucketIdx;
+    buckets[bucketIdx].fetch_add(1, std::memory_order_relaxed);
+    sumUs.fetch_add(latenessUs, std::memory_order_relaxed);
+
+    int64_t prevMax = maxLatenessUs.load(std::memory_order_relaxed);
+    while (latenessUs > prevMax && !maxLatenessUs.compare_exchange_weak(prevMax, latenessUs, std::memory_order_relaxed)) {}
+}
+
+void LatenessHistogram::recordSkip(int64_t inputSkippedCnt) {
+    skippedCnt.fetch_add(inputSkippedCnt, std::memory_order_relaxed);
+}
+
+uint64_t LatenessHistogram::getCount(size_t bucketIdx) const {
+    return bucketIdx < BUCKET_CNT ? buckets[bucketIdx].load(std::memory_order_relaxed) : 0;
+}
+
+int64_t LatenessHistogram::getMaxLatenessUs() const {
+    return maxLatenessUs.load(std::memory_order_relaxed);
+}
+
+int64_t LatenessHistogram::getSumUs() const {
+    return sumUs.load(std::memory_order_relaxed);
+}
+
+int64_t LatenessHistogram::getSkippedCnt() const {
+    return skippedCnt.load(std::memory_order_relaxed);
+}
+
+std::string LatenessHistogram::toString() const {
+    // e.g. <=50us:120, <=100us:3, ..., >50000us:0, max:812us, skipped:0
+    std::string str;
+    for (size_t i = 0; i < BUCKET_CNT; ++i) {
+        str += i < BUCKET_BOUNDS_US.size()
+            ? "<=" + std::to_string(BUCKET_BOUNDS_US[i])
+            : ">" + std::to_string(BUCKET_BOUNDS_US.back());
+        str += "us:" + std::to_string(getCount(i)) + ", ";
+    }
+    str += "max:" + std::to_string(getMaxLatenessUs()) + "us, skipped:" + std::to_string(getSkippedCnt());
+    return str;
+}
@@ -0,0 +1,102 @@
+#include "../include/TimerWheel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "../constants/C.h"
+
+TimerWheel& TimerWheel::getShared() {
+    // lives until the process exits. sessions may schedule their teardown until then.
+    static TimerWheel sharedTimerWheel(C::TIMER_WHEEL_TICK_MS, C::TIMER_WHEEL_SLOT_CNT);
+    return sharedTimerWheel;
+}
+
+TimerWheel::TimerWheel(int64_t inputTickMs, size_t inputSlotCnt)
+    : logger(Logger::getLogger(C::TIMER_WHEEL)),
+      tickMs(inputTickMs),
+      slots(inputSlotCnt),
+      startTimeMs(getSteadyTimeMillis()) {
+    wheelThread = std::thread([this]() { run(); });
+}
+
+TimerWheel::~TimerWheel() {
+    stop();
+}
+
+TimerWheel::TimerId TimerWheel::schedule(int64_t delayMs, std::function<void()> task) {
+    std::lock_guard<std::mutex> guard(lock);
+    const int64_t deadlineMs = getSteadyTimeMillis() + std::max<int64_t>(delayMs, 0);
+    // never put into a slot which was already processed in the current round.
+    const int64_t tick = std::max((deadlineMs - startTimeMs + tickMs - 1) / tickMs, processedTick + 1);
+    const size_t slotIdx = static_cast<size_t>(tick) % slots.size();
+
+    const TimerId timerId = ++lastTimerId;
+    auto& slot = slots[slotIdx];
+    slot.push_back(Entry{timerId, deadlineMs, std::move(task)});
+    entryIndex.emplace(timerId, std::make_pair(slotIdx, std::prev(slot.end())));
+    return timerId;
+}
+
+bool TimerWheel::cancel(TimerId timerId) {
+    std::lock_guard<std::mutex> guard(lock);
+    const auto it = entryIndex.find(timerId);
+    if (it == entryIndex.end()) return false;
+    slots[it->second.first].erase(it->second.second);
+    entryIndex.erase(it);
+    return true;
+}
+
+void TimerWheel::stop() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (isStopped) return;
+        isStopped = true;
+    }
+    wakeUp.notify_all();
+    if (wheelThread.joinable()) wheelThread.join();
+}
+
+void TimerWheel::run() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (!isStopped) {
+        const int64_t nextTickTimeMs = startTimeMs + (processedTick + 1) * tickMs;
+        const int64_t waitMs = nextTickTimeMs - getSteadyTimeMillis();
+        if (waitMs > 0) {
+            wakeUp.wait_for(guard, std::chrono::milliseconds(waitMs));
+            continue;
+        }
+        processedTick++;
+
+        // entries of later rounds stay in the slot until their deadline.
+        const int64_t now = getSteadyTimeMillis();
+        auto& slot = slots[static_cast<size_t>(processedTick) % slots.size()];
+        std::list<Entry> expiredEntries;
+        for (auto it = slot.begin(); it != slot.end();) {
+            auto cur = it++;
+            if (cur->deadlineMs <= now) {
+                entryIndex.erase(cur->timerId);
+                expiredEntries.splice(expiredEntries.end(), slot, cur);
+            }
+        }
+        if (expiredEntries.empty()) continue;
+
+        // run outside of the lock. a task may schedule or cancel another one.
+        guard.unlock();
+        for (auto& entry : expiredEntries) {
+            try {
+                entry.task();
+            } catch (const std::exception& e) {
+                logger->severe("Dongvin, exception in delayed task! timer id : " + std::to_string(entry.timerId));
+                std::cerr << e.what() << "\n";
+            }
+        }
+        guard.lock();
+    }
+}
+
+int64_t TimerWheel::getSteadyTimeMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
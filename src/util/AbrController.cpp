@@ -0,0 +1,44 @@
+#include "../include/AbrController.h"
+
+#include <algorithm>
+
+#include "../constants/C.h"
+
+void AbrController::reset(int inputVariantCnt) {
+    variantCnt = inputVariantCnt;
+    lastSwitchTimeMillis = 0;
+    healthySinceMillis = -1;
+}
+
+int AbrController::decide(int curVariantIdx, int64_t txBps, int64_t rxBps, int64_t backlogBytes, int64_t nowMillis) {
+    if (variantCnt < 2) return curVariantIdx;
+    int variantIdx = std::clamp(curVariantIdx, 0, variantCnt - 1);
+
+    const bool hasRxReport = rxBps != C::INVALID && txBps > 0;
+    const bool isCongested = backlogBytes > C::ABR_DOWN_SWITCH_BACKLOG_BYTES
+        || (hasRxReport && rxBps < txBps * C::ABR_DOWN_SWITCH_RX_RATIO);
+    const bool isHealthy = backlogBytes < C::ABR_UP_SWITCH_BACKLOG_BYTES
+        && (!hasRxReport || rxBps >= txBps * C::ABR_UP_SWITCH_RX_RATIO);
+
+    if (isCongested) {
+        healthySinceMillis = -1;
+        // samples of the previous variant are still queued. give them time to drain before the next step.
+        if (variantIdx + 1 < variantCnt && nowMillis - lastSwitchTimeMillis >= C::ABR_DOWN_SWITCH_HOLD_MS) {
+            ++variantIdx;
+            lastSwitchTimeMillis = nowMillis;
+        }
+        return variantIdx;
+    }
+
+    if (!isHealthy) {
+        healthySinceMillis = -1;
+        return variantIdx;
+    }
+    if (healthySinceMillis < 0) healthySinceMillis = nowMillis;
+    if (variantIdx > 0 && nowMillis - healthySinceMillis >= C::ABR_UP_SWITCH_HOLD_MS) {
+        --variantIdx;
+        lastSwitchTimeMillis = nowMillis;
+        healthySinceMillis = nowMillis; // one step at a time
+    }
+    return variantIdx;
+}
@@ -13,9 +13,10 @@ Buffer::Buffer(const std::vector<unsigned char>& buf, const int offset, const in
         validateBuffer();
     }
 
-void Buffer::updateBuf(const std::vector<unsigned char> &inputBuf) {
+void Buffer::updateBuf(std::vector<unsigned char> inputBuf) {
+    // taken by value. moving from a const reference was a silent copy, and len was read from the moved-from one.
     buf = std::move(inputBuf);
-    len = inputBuf.size();
+    len = static_cast<int>(buf.size());
     offset = 0;
 }
 
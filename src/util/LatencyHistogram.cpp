@@ -0,0 +1,105 @@
+#include "../include/LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    int getMsb(uint64_t value) {
+        // value > 0
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value);
+#else
+        int msb = 0;
+        while (value >>= 1) ++msb;
+        return msb;
+#endif
+    }
+
+    void updateMax(std::atomic<int64_t>& maxValue, int64_t value) {
+        int64_t prevMax = maxValue.load(std::memory_order_relaxed);
+        while (value > prevMax && !maxValue.compare_exchange_weak(prevMax, value, std::memory_order_relaxed)) {}
+    }
+}
+
+LatencyHistogram::LatencyHistogram(size_t inputShardCnt) : shards(std::max<size_t>(inputShardCnt, 1)) {}
+
+void LatencyHistogram::record(int64_t valueUs) {
+    if (valueUs < 0) valueUs = 0;
+    Shard& shard = shards[getThreadShardIdx() % shards.size()];
+    shard.buckets[getBucketIdx(valueUs)].fetch_add(1, std::memory_order_relaxed);
+    shard.sumUs.fetch_add(valueUs, std::memory_order_relaxed);
+    updateMax(shard.maxUs, valueUs);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::getSnapshot() const {
+    Snapshot snapshot;
+    for (const Shard& shard : shards) {
+        for (size_t i = 0; i < BUCKET_CNT; ++i) {
+            const uint64_t cnt = shard.buckets[i].load(std::memory_order_relaxed);
+            snapshot.counts[i] += cnt;
+            snapshot.totalCnt += cnt;
+        }
+        snapshot.sumUs += shard.sumUs.load(std::memory_order_relaxed);
+        snapshot.maxUs = std::max(snapshot.maxUs, shard.maxUs.load(std::memory_order_relaxed));
+    }
+    return snapshot;
+}
+
+std::string LatencyHistogram::toString() const {
+    const Snapshot snapshot = getSnapshot();
+    return "cnt:" + std::to_string(snapshot.totalCnt)
+        + ", p50:" + std::to_string(snapshot.getValueAtQuantile(0.5))
+        + "us, p99:" + std::to_string(snapshot.getValueAtQuantile(0.99))
+        + "us, p999:" + std::to_string(snapshot.getValueAtQuantile(0.999))
+        + "us, max:" + std::to_string(snapshot.maxUs) + "us";
+}
+
+size_t LatencyHistogram::getBucketIdx(int64_t valueUs) {
+    const uint64_t value = static_cast<uint64_t>(std::clamp<int64_t>(valueUs, 0, MAX_VALUE_US));
+    if (value < static_cast<uint64_t>(SUB_BUCKET_CNT)) return static_cast<size_t>(value);
+    // e.g. with 32 sub buckets, 64 ~ 127 are counted in 2us steps, 128 ~ 255 in 4us steps.
+    const int shift = getMsb(value) - SUB_BUCKET_BITS;
+    return static_cast<size_t>((shift + 1) * SUB_BUCKET_CNT + (value >> shift) - SUB_BUCKET_CNT);
+}
+
+int64_t LatencyHistogram::getBucketUpperBoundUs(size_t bucketIdx) {
+    const int64_t idx = static_cast<int64_t>(std::min(bucketIdx, BUCKET_CNT - 1));
+    if (idx < SUB_BUCKET_CNT) return idx;
+    const int64_t shift = idx / SUB_BUCKET_CNT - 1;
+    const int64_t lowerBound = (SUB_BUCKET_CNT + idx % SUB_BUCKET_CNT) << shift;
+    return lowerBound + (int64_t{1} << shift) - 1;
+}
+
+size_t LatencyHistogram::getThreadShardIdx() {
+    static std::atomic<size_t> nextShardIdx = 0;
+    thread_local const size_t shardIdx =
+        nextShardIdx.fetch_add(1, std::memory_order_relaxed) % C::LATENCY_HISTOGRAM_SHARD_CNT;
+    return shardIdx;
+}
+
+int64_t LatencyHistogram::Snapshot::getValueAtQuantile(double quantile) const {
+    if (totalCnt == 0) return 0;
+    const uint64_t targetCnt = std::max<uint64_t>(
+        static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(totalCnt))), 1
+    );
+    uint64_t cumulativeCnt = 0;
+    for (size_t i = 0; i < BUCKET_CNT; ++i) {
+        cumulativeCnt += counts[i];
+        // a bucket bound is never reported above the real max.
+        if (cumulativeCnt >= targetCnt) return std::min(getBucketUpperBoundUs(i), maxUs);
+    }
+    return maxUs;
+}
+
+uint64_t LatencyHistogram::Snapshot::getCountAtOrBelow(int64_t valueUs) const {
+    const size_t lastBucketIdx = getBucketIdx(valueUs);
+    uint64_t cnt = 0;
+    for (size_t i = 0; i <= lastBucketIdx; ++i) cnt += counts[i];
+    return cnt;
+}
+
+HotPathMetrics& HotPathMetrics::getShared() {
+    // lives until the process exits. tx threads may record until then.
+    static HotPathMetrics sharedHotPathMetrics;
+    return sharedHotPathMetrics;
+}
@@ -0,0 +1,91 @@
+#include "../include/RtspRequestParser.h"
+#include "../constants/Util.h"
+
+namespace {
+    constexpr std::string_view LINE_END = "\r\n";
+    constexpr std::string_view HEADER_END = "\r\n\r\n";
+    constexpr std::string_view CONTENT_LENGTH = "Content-Length";
+
+    RtspParseResult reject(RtspRequest& outRequest, size_t& consumedLen, size_t skipLen) {
+        outRequest.isValid = false;
+        consumedLen = skipLen;
+        return RtspParseResult::BAD_REQUEST;
+    }
+}
+
+std::string_view RtspRequest::getHeader(std::string_view name) const {
+    for (size_t i = 0; i < headerCnt; ++i) {
+        if (Util::equalsIgnoreCase(headers[i].first, name)) return headers[i].second;
+    }
+    return {};
+}
+
+bool RtspRequest::hasHeader(std::string_view name) const {
+    for (size_t i = 0; i < headerCnt; ++i) {
+        if (Util::equalsIgnoreCase(headers[i].first, name)) return true;
+    }
+    return false;
+}
+
+RtspParseResult RtspRequestParser::parse(std::string_view input, RtspRequest& outRequest, size_t& consumedLen) {
+    outRequest = RtspRequest{};
+    consumedLen = 0;
+
+    // empty lines between requests are allowed.
+    size_t start = 0;
+    while (input.substr(start, LINE_END.size()) == LINE_END) start += LINE_END.size();
+
+    const size_t headerEnd = input.find(HEADER_END, start);
+    if (headerEnd == std::string_view::npos) {
+        if (input.size() - start > C::RTSP_MAX_HEADER_BLOCK_SIZE) return reject(outRequest, consumedLen, input.size());
+        return RtspParseResult::INCOMPLETE;
+    }
+    const size_t bodyStart = headerEnd + HEADER_END.size();
+    std::string_view head = input.substr(start, headerEnd - start);
+
+    // request line. METHOD URL VERSION
+    const size_t requestLineEnd = head.find(LINE_END);
+    const std::string_view requestLine = head.substr(0, requestLineEnd);
+    const size_t firstSpace = requestLine.find(' ');
+    const size_t secondSpace = firstSpace == std::string_view::npos
+        ? std::string_view::npos : requestLine.find(' ', firstSpace + 1);
+    if (firstSpace == 0 || secondSpace == std::string_view::npos) return reject(outRequest, consumedLen, bodyStart);
+    outRequest.method = requestLine.substr(0, firstSpace);
+    outRequest.url = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+    outRequest.version = Util::trimView(requestLine.substr(secondSpace + 1));
+
+    // headers. indexed once, looked up by name later.
+    head.remove_prefix(requestLineEnd == std::string_view::npos ? head.size() : requestLineEnd + LINE_END.size());
+    while (!head.empty()) {
+        const size_t lineEnd = head.find(LINE_END);
+        const std::string_view line = head.substr(0, lineEnd);
+        head.remove_prefix(lineEnd == std::string_view::npos ? head.size() : lineEnd + LINE_END.size());
+        if (line.empty()) continue;
+
+        const size_t colon = line.find(':');
+        if (colon == std::string_view::npos || outRequest.headerCnt == outRequest.headers.size()) {
+            return reject(outRequest, consumedLen, bodyStart);
+        }
+        outRequest.headers[outRequest.headerCnt++] = {
+            Util::trimView(line.substr(0, colon)), Util::trimView(line.substr(colon + 1))
+        };
+    }
+
+    size_t bodyLen = 0;
+    if (const std::string_view contentLength = outRequest.getHeader(CONTENT_LENGTH); !contentLength.empty()) {
+        if (!Util::parseNumber(contentLength, bodyLen) || bodyLen > C::RTSP_MAX_BODY_SIZE) {
+            // the length of the broken body is unknown. drop everything received.
+            return reject(outRequest, consumedLen, input.size());
+        }
+    }
+    if (input.size() < bodyStart + bodyLen) {
+        outRequest = RtspRequest{};
+        return RtspParseResult::INCOMPLETE;
+    }
+
+    outRequest.body = input.substr(bodyStart, bodyLen);
+    outRequest.raw = input.substr(start, bodyStart + bodyLen - start);
+    outRequest.isValid = true;
+    consumedLen = bodyStart + bodyLen;
+    return RtspParseResult::COMPLETE;
+}
@@ -0,0 +1,80 @@
+#include "../include/RtspResponseWriter.h"
+
+#include <charconv>
+#include <string>
+
+namespace {
+    constexpr std::string_view STATUS_LINE_OK = "RTSP/1.0 200 OK\r\n";
+    constexpr std::string_view RTSP_VERSION = "RTSP/1.0 ";
+    constexpr std::string_view CSEQ_HEADER = "CSeq: ";
+    constexpr std::string_view HEADER_DELIMITER = ": ";
+    constexpr std::string_view LINE_END = "\r\n";
+}
+
+RtspResponseWriter::RtspResponseWriter(Buffer& inputBuffer, int statusCode, int cSeq)
+    : buffer(inputBuffer) {
+    // clear() keeps the capacity of the previous response.
+    buffer.buf.clear();
+    buffer.buf.reserve(C::RTSP_RESPONSE_RESERVE_SIZE);
+    buffer.bodyLen = C::UNSET;
+    buffer.rtspResponseFlags = 0;
+    buffer.afterTx = nullptr;
+
+    if (statusCode == C::OK) {
+        append(STATUS_LINE_OK);
+    } else {
+        append(RTSP_VERSION).append(statusCode).append(" ");
+        const auto it = C::RTSP_STATUS_CODES_MAP.find(statusCode);
+        if (it != C::RTSP_STATUS_CODES_MAP.end()) append(it->second);
+        append(LINE_END);
+    }
+    append(CSEQ_HEADER).append(cSeq).append(LINE_END);
+}
+
+RtspResponseWriter& RtspResponseWriter::header(std::string_view name, std::string_view value) {
+    return beginHeader(name).append(value).endHeader();
+}
+
+RtspResponseWriter& RtspResponseWriter::header(std::string_view name, int64_t value) {
+    return beginHeader(name).append(value).endHeader();
+}
+
+RtspResponseWriter& RtspResponseWriter::beginHeader(std::string_view name) {
+    return append(name).append(HEADER_DELIMITER);
+}
+
+RtspResponseWriter& RtspResponseWriter::append(std::string_view str) {
+    buffer.buf.insert(buffer.buf.end(), str.begin(), str.end());
+    return *this;
+}
+
+RtspResponseWriter& RtspResponseWriter::append(int64_t value) {
+    char digits[20];
+    const auto [ptr, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    return append(std::string_view(digits, ptr - digits));
+}
+
+RtspResponseWriter& RtspResponseWriter::endHeader() {
+    return append(LINE_END);
+}
+
+RtspResponseWriter& RtspResponseWriter::setFlag(RtspResponseFlag flag) {
+    buffer.rtspResponseFlags |= static_cast<uint8_t>(flag);
+    return *this;
+}
+
+void RtspResponseWriter::finish(std::string_view body) {
+    append(LINE_END);
+    if (!body.empty()) {
+        append(body); // don't append CRLF according to AVPT 6.1 implementation
+        buffer.bodyLen = static_cast<int>(body.size());
+    }
+
+    buffer.offset = 0;
+    buffer.len = static_cast<int>(buffer.buf.size());
+    buffer.limit = buffer.len;
+}
+
+bool RtspResponseWriter::hasFlag(const Buffer& buffer, RtspResponseFlag flag) {
+    return (buffer.rtspResponseFlags & static_cast<uint8_t>(flag)) != 0;
+}